@@ -0,0 +1,308 @@
+#include "AdminServer.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+#include <Utils/Message.h>
+#include <Utils/DebugHandler.h>
+#include "../EngineLoop.h"
+#include "../Utils/Metrics.h"
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _WIN32
+
+// Longer lines drop the session, nothing sent to the region is anywhere near this long
+constexpr size_t ADMIN_MAX_LINE_SIZE = 4096;
+
+// A session that stops reading while it tails the log loses lines past this, instead of growing without bound
+constexpr size_t ADMIN_MAX_QUEUED_WRITES = 4096;
+
+AdminServer::AdminServer(EngineLoop& engineLoop) : _engineLoop(engineLoop), _ioService(std::make_shared<asio::io_service>(1))
+{
+    std::shared_ptr<asio::io_service> ioService = _ioService;
+    _engineLoop.SetOutputNotifier([this, ioService]()
+    {
+        asio::post(*ioService, [this]() { DrainOutput(); });
+    });
+}
+
+AdminServer::~AdminServer()
+{
+    Shutdown();
+}
+
+void AdminServer::Run(const std::string& socketPath)
+{
+    // Blocks in getline for the whole run, a single thread instead of one per line. It can't be interrupted,
+    // so it is left behind at exit and only keeps the io service alive, whose handlers then never run
+    std::shared_ptr<asio::io_service> ioService = _ioService;
+    std::thread consoleThread([this, ioService]()
+    {
+        std::string line;
+        while (std::getline(std::cin, line))
+        {
+            asio::post(*ioService, [this, line = std::move(line)]() mutable { HandleLine(CONSOLE_SESSION_ID, std::move(line)); });
+        }
+    });
+    consoleThread.detach();
+
+#ifdef ASIO_HAS_LOCAL_SOCKETS
+    if (!socketPath.empty() && Listen(socketPath))
+        DebugHandler::PrintSuccess("[Admin]: Accepting admin sessions on (%s)", socketPath.c_str());
+#else
+    if (!socketPath.empty())
+        DebugHandler::PrintWarning("[Admin]: Local sockets are not supported on this platform, only the console takes commands");
+#endif // ASIO_HAS_LOCAL_SOCKETS
+
+    // Anything printed before we got here
+    DrainOutput();
+
+    asio::io_service::work work(*_ioService);
+    _ioService->run();
+}
+
+void AdminServer::HandleLine(u32 sessionId, std::string line)
+{
+    if (!line.empty() && line.back() == '\r')
+        line.pop_back();
+
+    std::transform(line.begin(), line.end(), line.begin(), ::tolower); // Convert command to lowercase
+
+#ifdef ASIO_HAS_LOCAL_SOCKETS
+    // Tailing is a property of the session rather than a command for the engine
+    if (line == "tail" && sessionId != CONSOLE_SESSION_ID)
+    {
+        auto itr = _sessions.find(sessionId);
+        if (itr == _sessions.end())
+            return;
+
+        std::shared_ptr<Session>& session = itr->second;
+        session->isTailing = !session->isTailing;
+        Write(session, session->isTailing ? "Tailing the log, \"tail\" again stops it\n" : "Stopped tailing the log\n");
+        return;
+    }
+#endif // ASIO_HAS_LOCAL_SOCKETS
+
+    _engineLoop.QueueCommand(sessionId, std::move(line));
+}
+
+void AdminServer::DrainOutput()
+{
+    if (_isShutdown)
+        return;
+
+    _engineLoop.ClearOutputNotification();
+
+    Message message;
+    while (_engineLoop.TryGetMessage(message))
+    {
+        if (message.code == MSG_OUT_EXIT_CONFIRM)
+        {
+            Shutdown();
+            return;
+        }
+        else if (message.code == MSG_OUT_PRINT)
+        {
+            DebugHandler::Print(*message.message);
+
+#ifdef ASIO_HAS_LOCAL_SOCKETS
+            for (auto& [sessionId, session] : _sessions)
+            {
+                if (session->isTailing)
+                    Write(session, *message.message + '\n');
+            }
+#endif // ASIO_HAS_LOCAL_SOCKETS
+
+            delete message.message;
+        }
+    }
+
+    CommandReply reply;
+    while (_engineLoop.TryGetReply(reply))
+    {
+        if (reply.sessionId == CONSOLE_SESSION_ID)
+        {
+            DebugHandler::Print(reply.text);
+            continue;
+        }
+
+#ifdef ASIO_HAS_LOCAL_SOCKETS
+        // The session may have left while its command waited for the tick
+        auto itr = _sessions.find(reply.sessionId);
+        if (itr != _sessions.end())
+            Write(itr->second, std::move(reply.text) + '\n');
+#endif // ASIO_HAS_LOCAL_SOCKETS
+    }
+}
+
+void AdminServer::Shutdown()
+{
+    if (_isShutdown)
+        return;
+
+    _isShutdown = true;
+
+#ifdef ASIO_HAS_LOCAL_SOCKETS
+    if (_acceptor)
+    {
+        asio::error_code error;
+        _acceptor->close(error);
+        std::remove(_socketPath.c_str());
+    }
+
+    for (auto& [sessionId, session] : _sessions)
+    {
+        asio::error_code error;
+        session->socket.close(error);
+    }
+    _sessions.clear();
+#endif // ASIO_HAS_LOCAL_SOCKETS
+
+    _ioService->stop();
+}
+
+#ifdef ASIO_HAS_LOCAL_SOCKETS
+bool AdminServer::Listen(const std::string& socketPath)
+{
+#ifndef _WIN32
+    // A region that crashed leaves its socket file behind, which would make the bind fail. Only that is
+    // removed, never a file that isn't a socket or a socket another region is still serving on
+    struct stat status;
+    if (lstat(socketPath.c_str(), &status) == 0)
+    {
+        if (!S_ISSOCK(status.st_mode))
+        {
+            DebugHandler::PrintError("[Admin]: Failed to listen on (%s): the path exists and is not a socket", socketPath.c_str());
+            return false;
+        }
+
+        asio::error_code probeError;
+        asio::local::stream_protocol::socket probe(*_ioService);
+        probe.connect(asio::local::stream_protocol::endpoint(socketPath), probeError);
+        if (!probeError)
+        {
+            DebugHandler::PrintError("[Admin]: Failed to listen on (%s): another process is accepting on it", socketPath.c_str());
+            return false;
+        }
+
+        unlink(socketPath.c_str());
+    }
+#endif // _WIN32
+
+    asio::error_code error;
+    _acceptor = std::make_unique<asio::local::stream_protocol::acceptor>(*_ioService);
+    _acceptor->open(asio::local::stream_protocol(), error);
+    if (!error)
+        _acceptor->bind(asio::local::stream_protocol::endpoint(socketPath), error);
+    if (!error)
+        _acceptor->listen(asio::socket_base::max_listen_connections, error);
+
+    if (error)
+    {
+        DebugHandler::PrintError("[Admin]: Failed to listen on (%s): %s", socketPath.c_str(), error.message().c_str());
+        _acceptor.reset();
+        return false;
+    }
+
+#ifndef _WIN32
+    // Every session can stop the region, only its own user gets to connect
+    chmod(socketPath.c_str(), S_IRUSR | S_IWUSR);
+#endif // _WIN32
+
+    _socketPath = socketPath;
+    Accept();
+    return true;
+}
+
+void AdminServer::Accept()
+{
+    std::shared_ptr<Session> session = std::make_shared<Session>(*_ioService, ADMIN_MAX_LINE_SIZE);
+    _acceptor->async_accept(session->socket, [this, session](const asio::error_code& error)
+    {
+        if (_isShutdown)
+            return;
+
+        if (!error)
+        {
+            static std::atomic<i64>& sessionsMetric = Metrics::Get("admin.sessions");
+            sessionsMetric.fetch_add(1, std::memory_order_relaxed);
+
+            session->id = _nextSessionId++;
+            _sessions[session->id] = session;
+            Read(session);
+        }
+
+        Accept();
+    });
+}
+
+void AdminServer::Read(std::shared_ptr<Session> session)
+{
+    asio::async_read_until(session->socket, session->readBuffer, '\n', [this, session](const asio::error_code& error, size_t size) mutable
+    {
+        if (_isShutdown)
+            return;
+
+        if (error)
+        {
+            Drop(session);
+            return;
+        }
+
+        std::string line(asio::buffers_begin(session->readBuffer.data()), asio::buffers_begin(session->readBuffer.data()) + size - 1);
+        session->readBuffer.consume(size);
+
+        HandleLine(session->id, std::move(line));
+        Read(session);
+    });
+}
+
+void AdminServer::Write(std::shared_ptr<Session>& session, std::string text)
+{
+    if (session->writeQueue.size() >= ADMIN_MAX_QUEUED_WRITES)
+    {
+        static std::atomic<i64>& droppedMetric = Metrics::Get("admin.droppedWrites");
+        droppedMetric.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    session->writeQueue.push_back(std::move(text));
+    if (!session->isWriting)
+        WriteNext(session);
+}
+
+void AdminServer::WriteNext(std::shared_ptr<Session> session)
+{
+    session->isWriting = true;
+    asio::async_write(session->socket, asio::buffer(session->writeQueue.front()), [this, session](const asio::error_code& error, size_t) mutable
+    {
+        if (_isShutdown)
+            return;
+
+        if (error)
+        {
+            Drop(session);
+            return;
+        }
+
+        session->writeQueue.pop_front();
+        if (session->writeQueue.empty())
+            session->isWriting = false;
+        else
+            WriteNext(session);
+    });
+}
+
+void AdminServer::Drop(std::shared_ptr<Session>& session)
+{
+    // Reads and writes both fail once a socket breaks, only the first one gets to drop it
+    if (_sessions.erase(session->id) == 0)
+        return;
+
+    asio::error_code error;
+    session->socket.close(error);
+}
+#endif // ASIO_HAS_LOCAL_SOCKETS
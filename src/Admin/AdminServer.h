@@ -0,0 +1,64 @@
+#pragma once
+#include <NovusTypes.h>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <asio.hpp>
+
+class EngineLoop;
+
+// Event driven control plane for the console and a local admin socket, both going through the console's command registry.
+// Everything runs on the thread calling Run, which sleeps in its io service until a line comes in or the engine queued
+// output. Commands are only queued from here, the tick runs them together at the start of its next update
+class AdminServer
+{
+public:
+    // Hooks into the engine's output, so it has to be created before the engine starts
+    AdminServer(EngineLoop& engineLoop);
+    ~AdminServer();
+
+    // Returns once the engine confirmed its exit, an empty socketPath only serves the console
+    void Run(const std::string& socketPath);
+
+private:
+    void HandleLine(u32 sessionId, std::string line);
+    void DrainOutput();
+    void Shutdown();
+
+#ifdef ASIO_HAS_LOCAL_SOCKETS
+    struct Session
+    {
+        Session(asio::io_service& ioService, size_t maxLineSize) : socket(ioService), readBuffer(maxLineSize) { }
+
+        asio::local::stream_protocol::socket socket;
+        asio::streambuf readBuffer;
+        u32 id = 0;
+        bool isTailing = false; // Gets everything the engine prints, not only the replies to its commands
+
+        std::deque<std::string> writeQueue;
+        bool isWriting = false;
+    };
+
+    bool Listen(const std::string& socketPath);
+    void Accept();
+    void Read(std::shared_ptr<Session> session);
+    void Write(std::shared_ptr<Session>& session, std::string text);
+    void WriteNext(std::shared_ptr<Session> session);
+    void Drop(std::shared_ptr<Session>& session);
+#endif // ASIO_HAS_LOCAL_SOCKETS
+
+private:
+    EngineLoop& _engineLoop;
+
+    // Shared with the console thread and the engine's output notifier, both may outlive us at exit
+    std::shared_ptr<asio::io_service> _ioService;
+    bool _isShutdown = false;
+
+#ifdef ASIO_HAS_LOCAL_SOCKETS
+    std::unique_ptr<asio::local::stream_protocol::acceptor> _acceptor;
+    std::unordered_map<u32, std::shared_ptr<Session>> _sessions;
+    u32 _nextSessionId = 1;
+    std::string _socketPath;
+#endif // ASIO_HAS_LOCAL_SOCKETS
+};
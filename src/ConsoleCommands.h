@@ -27,13 +27,19 @@
 #include <vector>
 #include <sstream>
 #include <iterator>
+#include <algorithm>
 #include <functional>
+#include <string_view>
 
 #include <Utils/StringUtils.h>
 #include <Utils/DebugHandler.h>
 
+#include "Utils/FrameArena.h"
 #include "ConsoleCommands/QuitCommand.h"
 #include "ConsoleCommands/PingCommand.h"
+#include "ConsoleCommands/StatsCommand.h"
+#include "ConsoleCommands/HandoffCommand.h"
+#include "ConsoleCommands/ZoneCommand.h"
 
 class ConsoleCommandHandler
 {
@@ -42,33 +48,51 @@ public:
     {
         RegisterCommand("quit"_h, &QuitCommand);
         RegisterCommand("ping"_h, &PingCommand);
+        RegisterCommand("stats"_h, &StatsCommand);
+        RegisterCommand("handoff"_h, &HandoffCommand);
+        RegisterCommand("zone"_h, &ZoneCommand);
     }
 
-    void HandleCommand(EngineLoop& engineLoop, std::string& command)
+    // Runs on the tick thread, replies go back to the console or the admin session the command came from
+    void HandleCommand(EngineLoop& engineLoop, u32 sessionId, std::string& command)
     {
         if (command.size() == 0)
             return;
 
-        std::vector<std::string> splitCommand = StringUtils::SplitString(command);
-        u32 hashedCommand = StringUtils::fnv1a_32(splitCommand[0].c_str(), splitCommand[0].size());
+        // Arguments are views into the command, only the list itself lives in the arena and nothing references it past the last command
+        _commandArena.Reset();
+
+        FrameVector<std::string_view> splitCommand(_commandArena);
+        for (size_t start = command.find_first_not_of(' '); start != std::string::npos; start = command.find_first_not_of(' ', start))
+        {
+            size_t end = std::min(command.find(' ', start), command.size());
+            splitCommand.emplace_back(command.data() + start, end - start);
+            start = end;
+        }
+
+        if (splitCommand.size() == 0)
+            return;
+
+        u32 hashedCommand = StringUtils::fnv1a_32(splitCommand[0].data(), splitCommand[0].size());
 
         auto commandHandler = commandHandlers.find(hashedCommand);
         if (commandHandler != commandHandlers.end())
         {
             splitCommand.erase(splitCommand.begin());
-            commandHandler->second(engineLoop, splitCommand);
+            commandHandler->second(engineLoop, sessionId, splitCommand);
         }
         else
         {
-            DebugHandler::PrintWarning("Unhandled command: " + command);
+            engineLoop.Reply(sessionId, "Unhandled command: " + command);
         }
     }
 
 private:
-    void RegisterCommand(u32 id, const std::function<void(EngineLoop&, std::vector<std::string>)>& handler)
+    void RegisterCommand(u32 id, const std::function<void(EngineLoop&, u32, FrameVector<std::string_view>&)>& handler)
     {
         commandHandlers.insert_or_assign(id, handler);
     }
 
-    std::map<u16, std::function<void(EngineLoop&, std::vector<std::string>)>> commandHandlers = {};
+    std::map<u16, std::function<void(EngineLoop&, u32, FrameVector<std::string_view>&)>> commandHandlers = {};
+    FrameArena _commandArena{ 4096 };
 };
@@ -22,12 +22,11 @@
     SOFTWARE.
 */
 #pragma once
-#include <Utils/Message.h>
+#include "../Utils/FrameArena.h"
 #include "../EngineLoop.h"
 
-void PingCommand(EngineLoop& engineLoop, std::vector<std::string> subCommands)
+void PingCommand(EngineLoop& engineLoop, u32 sessionId, FrameVector<std::string_view>& subCommands)
 {
-    Message pingMessage;
-    pingMessage.code = MSG_IN_PING;
-    engineLoop.PassMessage(pingMessage);
+    // Commands already run on the tick, so the answer also tells that the tick is alive
+    engineLoop.Reply(sessionId, "PONG!");
 }
\ No newline at end of file
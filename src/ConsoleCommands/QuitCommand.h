@@ -23,9 +23,10 @@
 */
 #pragma once
 #include <Utils/Message.h>
+#include "../Utils/FrameArena.h"
 #include "../EngineLoop.h"
 
-void QuitCommand(EngineLoop& engineLoop, std::vector<std::string> subCommands)
+void QuitCommand(EngineLoop& engineLoop, u32 sessionId, FrameVector<std::string_view>& subCommands)
 {
     engineLoop.Stop();
 }
\ No newline at end of file
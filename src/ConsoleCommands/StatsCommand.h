@@ -0,0 +1,49 @@
+/*
+    MIT License
+
+    Copyright (c) 2020 NovusCore
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#pragma once
+#include <string>
+#include "../Utils/Metrics.h"
+#include "../Utils/FrameArena.h"
+#include "../EngineLoop.h"
+
+void StatsCommand(EngineLoop& engineLoop, u32 sessionId, FrameVector<std::string_view>& subCommands)
+{
+    // An optional argument filters metrics by prefix, "stats governor" only prints the governor's metrics
+    const std::string_view prefix = subCommands.size() > 0 ? subCommands[0] : std::string_view();
+
+    // Sent as a single reply, so an admin session gets every line of it at once
+    std::string reply;
+    Metrics::ForEach([&prefix, &reply](const std::string& name, i64 value)
+    {
+        if (name.compare(0, prefix.size(), prefix) != 0)
+            return;
+
+        if (!reply.empty())
+            reply += '\n';
+
+        reply += name + ": " + std::to_string(value);
+    });
+
+    engineLoop.Reply(sessionId, reply);
+}
\ No newline at end of file
@@ -0,0 +1,150 @@
+#include "FlightRecorder.h"
+#include <cstdio>
+#include <algorithm>
+#include "../ECS/Components/Singletons/GovernorSingleton.h"
+#include "../Utils/Metrics.h"
+#include "../Utils/ServiceLocator.h"
+#include "../EngineLoop.h"
+
+// Back to back hitches only produce one trace, the ring already covers the ones that follow closely
+constexpr u64 FLIGHT_RECORDER_DUMP_COOLDOWN_NS = 10ull * 1000 * 1000 * 1000;
+
+constexpr const char* SYSTEM_NAMES[static_cast<size_t>(SystemId::COUNT)] =
+{
+    "TimerSystem",
+    "ConnectionUpdateSystem",
+    "ConnectionDeferredSystem",
+    "MovementSystem",
+    "SnapshotSystem",
+    "HandoffSystem",
+    "ZoneMessageSystem",
+    "UdpSystem",
+    "PositionBroadcastSystem"
+};
+
+FlightRecorder::FlightRecorder() : _ring(FLIGHT_RECORDER_CAPACITY)
+{
+}
+
+FlightRecorder::~FlightRecorder()
+{
+    Stop();
+}
+
+void FlightRecorder::Start(const std::string& directory, f32 slowTickThresholdMS)
+{
+    _directory = directory;
+    _thresholdNs = static_cast<u64>(slowTickThresholdMS * 1000000.0f);
+
+    if (_thresholdNs > 0)
+        _writer.Start(1);
+}
+
+void FlightRecorder::Stop()
+{
+    _writer.Stop();
+}
+
+void FlightRecorder::Record(u64 tick, u64 startNs, u64 updateNs, u64 waitNs, u8 governorLevel, const TickStatsSingleton& tickStats)
+{
+    FlightRecord& record = _ring[_head];
+    record.tick = tick;
+    record.startNs = startNs;
+    record.updateNs = updateNs;
+    record.waitNs = waitNs;
+    record.governorLevel = governorLevel;
+
+    record.spanCount = std::min(tickStats.spanCount.load(std::memory_order_relaxed), TICK_STATS_MAX_SPANS);
+    std::copy_n(tickStats.spans.begin(), record.spanCount, record.spans.begin());
+
+    record.opcodeCount = tickStats.opcodeCount;
+    std::copy_n(tickStats.opcodeCounts.begin(), record.opcodeCount, record.opcodeCounts.begin());
+    record.otherPackets = tickStats.otherPackets;
+    record.packetsDispatched = tickStats.packetsDispatched;
+
+    record.clientQueueDepth = tickStats.clientQueueDepth;
+    record.upstreamQueueDepth = tickStats.upstreamQueueDepth;
+    record.newConnectionQueueDepth = tickStats.newConnectionQueueDepth;
+    record.connectionCount = tickStats.connectionCount;
+
+    _head = (_head + 1) % FLIGHT_RECORDER_CAPACITY;
+    _count = std::min(_count + 1, FLIGHT_RECORDER_CAPACITY);
+
+    if (_thresholdNs > 0 && updateNs > _thresholdNs && (_lastDumpNs == 0 || startNs - _lastDumpNs > FLIGHT_RECORDER_DUMP_COOLDOWN_NS))
+    {
+        _lastDumpNs = startNs;
+        Dump(tick);
+    }
+}
+
+void FlightRecorder::Dump(u64 tick)
+{
+    static std::atomic<i64>& dumpsMetric = Metrics::Get("flightRecorder.dumps");
+    dumpsMetric.fetch_add(1, std::memory_order_relaxed);
+
+    // Oldest first
+    std::vector<FlightRecord> records;
+    records.reserve(_count);
+
+    u32 first = (_head + FLIGHT_RECORDER_CAPACITY - _count) % FLIGHT_RECORDER_CAPACITY;
+    for (u32 i = 0; i < _count; i++)
+    {
+        records.push_back(_ring[(first + i) % FLIGHT_RECORDER_CAPACITY]);
+    }
+
+    std::string path = _directory + "/slowtick_" + std::to_string(tick) + ".json";
+    _writer.Submit(0, [path, records = std::move(records)]()
+    {
+        if (WriteTrace(path, records))
+            ServiceLocator::GetEngineLoop()->PrintMessage("[FlightRecorder]: Slow tick, wrote the last %u ticks to (%s)", static_cast<u32>(records.size()), path.c_str());
+        else
+            ServiceLocator::GetEngineLoop()->PrintMessage("[FlightRecorder]: Failed to write (%s)", path.c_str());
+    });
+}
+
+bool FlightRecorder::WriteTrace(const std::string& path, const std::vector<FlightRecord>& records)
+{
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file)
+        return false;
+
+    u64 originNs = records.front().startNs;
+    auto toMicroseconds = [originNs](u64 ns) { return static_cast<f64>(ns - std::min(ns, originNs)) / 1000.0; };
+
+    // Thread 0 is the tick timeline, workers are numbered by the order they first ran a system
+    std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    std::fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Tick\"}}");
+
+    for (const FlightRecord& record : records)
+    {
+        f64 start = toMicroseconds(record.startNs);
+        f64 update = static_cast<f64>(record.updateNs) / 1000.0;
+        f64 wait = static_cast<f64>(record.waitNs) / 1000.0;
+
+        std::fprintf(file, ",\n{\"name\":\"Tick\",\"ph\":\"X\",\"pid\":1,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"tick\":%llu,\"governorLevel\":%u,\"packets\":%u}}",
+            start, update, static_cast<unsigned long long>(record.tick), record.governorLevel, record.packetsDispatched);
+        std::fprintf(file, ",\n{\"name\":\"Wait\",\"ph\":\"X\",\"pid\":1,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f}", start + update, wait);
+
+        for (u32 i = 0; i < record.spanCount; i++)
+        {
+            const SystemSpan& span = record.spans[i];
+            const char* name = span.systemId < static_cast<u8>(SystemId::COUNT) ? SYSTEM_NAMES[span.systemId] : "Unknown";
+
+            std::fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                name, span.threadIndex, toMicroseconds(span.startNs), static_cast<f64>(span.durationNs) / 1000.0);
+        }
+
+        std::fprintf(file, ",\n{\"name\":\"Queues\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":{\"client\":%u,\"upstream\":%u,\"newConnections\":%u,\"connections\":%u}}",
+            start, record.clientQueueDepth, record.upstreamQueueDepth, record.newConnectionQueueDepth, record.connectionCount);
+
+        std::fprintf(file, ",\n{\"name\":\"Packets\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":{\"other\":%u", start, record.otherPackets);
+        for (u32 i = 0; i < record.opcodeCount; i++)
+        {
+            std::fprintf(file, ",\"0x%04X\":%u", record.opcodeCounts[i].opcode, record.opcodeCounts[i].count);
+        }
+        std::fprintf(file, "}}");
+    }
+
+    std::fprintf(file, "\n]}\n");
+    return std::fclose(file) == 0;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <NovusTypes.h>
+#include <array>
+#include <string>
+#include <vector>
+#include "../ECS/Components/Singletons/TickStatsSingleton.h"
+#include "../Utils/WorkerPool.h"
+
+constexpr u32 FLIGHT_RECORDER_CAPACITY = 600; // 10 seconds at 60 ticks per second
+
+struct FlightRecord
+{
+    u64 tick;
+    u64 startNs;
+    u64 updateNs;
+    u64 waitNs;
+    u8 governorLevel;
+
+    u32 spanCount;
+    std::array<SystemSpan, TICK_STATS_MAX_SPANS> spans;
+
+    u32 opcodeCount;
+    std::array<OpcodeCount, TICK_STATS_MAX_OPCODES> opcodeCounts;
+    u32 otherPackets;
+    u32 packetsDispatched;
+
+    u32 clientQueueDepth;
+    u32 upstreamQueueDepth;
+    u32 newConnectionQueueDepth;
+    u32 connectionCount;
+};
+
+// Always on ring of the last FLIGHT_RECORDER_CAPACITY ticks, a tick that overruns the threshold gets the ring
+// written out as a Chrome trace (chrome://tracing, ui.perfetto.dev) so hitches can be looked at after the fact without Tracy
+class FlightRecorder
+{
+public:
+    FlightRecorder();
+    ~FlightRecorder();
+
+    // A threshold of 0 keeps recording but never dumps
+    void Start(const std::string& directory, f32 slowTickThresholdMS);
+    void Stop();
+
+    // Called by the tick thread once the tick and its wait are over
+    void Record(u64 tick, u64 startNs, u64 updateNs, u64 waitNs, u8 governorLevel, const TickStatsSingleton& tickStats);
+
+private:
+    void Dump(u64 tick);
+    static bool WriteTrace(const std::string& path, const std::vector<FlightRecord>& records);
+
+    std::vector<FlightRecord> _ring;
+    u32 _head = 0;
+    u32 _count = 0;
+
+    std::string _directory;
+    u64 _thresholdNs = 0;
+    u64 _lastDumpNs = 0;
+
+    // Traces are written on their own thread, the tick only pays for copying the ring
+    WorkerPool _writer;
+};
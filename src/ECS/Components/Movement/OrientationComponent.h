@@ -0,0 +1,10 @@
+#pragma once
+#include <NovusTypes.h>
+
+// Yaw is kept within [0, 2*PI), turnRate is in radians per second
+struct OrientationComponent
+{
+    f32 yaw = 0.0f;
+    f32 turnRate = 0.0f;
+};
+static_assert(sizeof(OrientationComponent) == sizeof(f32) * 2, "OrientationComponent must stay tightly packed");
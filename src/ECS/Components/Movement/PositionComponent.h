@@ -0,0 +1,11 @@
+#pragma once
+#include <NovusTypes.h>
+
+// Kept as three tightly packed floats, MovementSystem treats the owning group's raw array as one flat f32 stream
+struct PositionComponent
+{
+    f32 x = 0.0f;
+    f32 y = 0.0f;
+    f32 z = 0.0f;
+};
+static_assert(sizeof(PositionComponent) == sizeof(f32) * 3, "PositionComponent must stay tightly packed");
@@ -0,0 +1,11 @@
+#pragma once
+#include <NovusTypes.h>
+
+// Units per second, must mirror the layout of PositionComponent
+struct VelocityComponent
+{
+    f32 x = 0.0f;
+    f32 y = 0.0f;
+    f32 z = 0.0f;
+};
+static_assert(sizeof(VelocityComponent) == sizeof(f32) * 3, "VelocityComponent must stay tightly packed");
@@ -1,9 +1,37 @@
 #pragma once
 #include <NovusTypes.h>
+#include <memory>
 #include <Utils/srp.h>
+#include <Utils/ConcurrentQueue.h>
+#include "../../../Utils/WorkerPool.h"
+
+class NetworkClient;
+
+enum class AuthenticationStep : u8
+{
+    START, // A generated, the logon challenge can be sent
+    CHALLENGE, // The server's challenge processed, M1 can be sent
+    VERIFY // The server's proof checked
+};
+
+// Outcome of the SRP math of a step, applied by the tick after the worker finished it
+struct AuthenticationResult
+{
+    std::shared_ptr<NetworkClient> networkClient;
+    AuthenticationStep step = AuthenticationStep::START;
+    bool succeeded = false;
+};
 
 struct AuthenticationSingleton
 {
+    AuthenticationSingleton() : results(16) { }
+
     std::string username = "";
-    SRPUser srp;
-};
\ No newline at end of file
+    SRPUser srp; // Only touched by the job of the current step, the next one is submitted once its result was applied
+
+    moodycamel::ConcurrentQueue<AuthenticationResult> results;
+    bool isAuthenticated = false; // Tick thread only, set once the upstream link passed VERIFY
+
+    // Declared last so it is stopped, finishing the jobs still using srp and results, before those are destroyed
+    WorkerPool workers;
+};
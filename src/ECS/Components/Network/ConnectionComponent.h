@@ -1,8 +1,12 @@
 #pragma once
 #include <NovusTypes.h>
+#include <vector>
 #include <Utils/ConcurrentQueue.h>
 #include <Networking/NetworkPacket.h>
 #include <Networking/NetworkClient.h>
+#include "../../../Utils/TimerWheel.h"
+#include "../../../Utils/PoolAllocator.h"
+#include "../../../Network/Outbound/OutboundBacklog.h"
 
 enum class PacketPriority
 {
@@ -11,13 +15,56 @@ enum class PacketPriority
     HIGH
 };
 
+// Longest time in seconds a frame of that priority waits to be coalesced with the ones after it
 #define LOW_PRIORITY_TIME 1
 #define MEDIUM_PRIORITY_TIME 0.5f
 
 struct ConnectionComponent
 {
-    ConnectionComponent() : packetQueue(256) { }
+    ConnectionComponent() : packetQueue(256), outbound(std::allocate_shared<OutboundBacklog>(PoolAllocator<OutboundBacklog>())) { }
+
+    // Returns a dropped connection to how a new one starts out, its queue keeps its blocks and its buffers their capacity.
+    // The timers have to be cancelled first
+    void Reset()
+    {
+        std::shared_ptr<NetworkPacket> packet;
+        while (packetQueue.try_dequeue(packet)) { }
+
+        connection.reset();
+        supportsCompression = false;
+        partialFrame.clear();
+
+        handshakeTimer = 0;
+        idleTimer = 0;
+        upstreamRequestTimer = 0;
+        flushTimer = 0;
+        lastActivityTick = 0;
+
+        coalescedBuffer.reset();
+
+        // Compression workers may still count frames of the dropped connection into the old one
+        outbound = std::allocate_shared<OutboundBacklog>(PoolAllocator<OutboundBacklog>());
+        slowSinceTick = 0;
+        isEvicted = false;
+    }
 
     std::shared_ptr<NetworkClient> connection;
     moodycamel::ConcurrentQueue<std::shared_ptr<NetworkPacket>> packetQueue;
+    bool supportsCompression = false; // Set once the client sent us a compressed frame
+    std::vector<u8> partialFrame; // Bytes of a frame split across reads, only touched by whoever frames the connection's reads
+
+    // Handles into the TimerSingleton's wheel, 0 when the timer is not pending
+    TimerHandle handshakeTimer = 0;
+    TimerHandle idleTimer = 0;
+    TimerHandle upstreamRequestTimer = 0;
+    TimerHandle flushTimer = 0;
+    u64 lastActivityTick = 0;
+
+    // MEDIUM and LOW priority frames waiting for flushTimer, already compressed where the connection wants it
+    std::shared_ptr<Bytebuffer> coalescedBuffer;
+
+    // Shared with the compression workers that send for the connection
+    std::shared_ptr<OutboundBacklog> outbound;
+    u64 slowSinceTick = 0; // Tick the backlog went over the soft cap, 0 while it is below
+    bool isEvicted = false; // Closed for falling too far behind, waiting to be dropped
 };
\ No newline at end of file
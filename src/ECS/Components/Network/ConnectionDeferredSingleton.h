@@ -1,14 +1,46 @@
 #pragma once
 #include <NovusTypes.h>
+#include <vector>
 #include <asio.hpp>
+#include <entt.hpp>
 #include <Utils/ConcurrentQueue.h>
 #include <Networking/NetworkServer.h>
+#include "ConnectionComponent.h"
 
+// Dropped connections kept for reuse, enough to absorb a reconnect wave without holding on to every queue of a peak forever
+constexpr size_t RECYCLED_CONNECTION_CAPACITY = 4096;
+
+class IoUringBackend;
 struct ConnectionDeferredSingleton
 {
     ConnectionDeferredSingleton() : newConnectionQueue(64), droppedConnectionQueue(32) { }
 
     std::shared_ptr<NetworkServer> networkServer;
+    IoUringBackend* ioUringBackend = nullptr; // Receives for client connections when set, instead of NetworkClient::Listen
+    u16 listenPort = 0;
+    u32 busyPollMicroseconds = 0;
+
+    // Connection timeouts in seconds, 0 disables one
+    f32 handshakeTimeout = 0.0f;
+    f32 idleTimeout = 0.0f;
+    f32 upstreamRequestTimeout = 0.0f;
+
+    // Outbound backlog limits, see EngineConfig
+    u64 outboundSoftCap = 0;
+    u64 outboundHardCap = 0;
+    f32 outboundMaxAge = 0.0f;
+
+    // Seconds between entity position broadcasts, 0 disables them
+    f32 positionInterval = 0.0f;
+    u64 nextPositionTick = 0;
+
     moodycamel::ConcurrentQueue<asio::ip::tcp::socket*> newConnectionQueue;
     moodycamel::ConcurrentQueue<entt::entity> droppedConnectionQueue;
+
+    std::vector<ConnectionComponent> recycledConnections;
+
+    // Reused every tick to accept and drop connections in batches
+    std::vector<asio::ip::tcp::socket*> acceptedSockets;
+    std::vector<entt::entity> acceptedEntities;
+    std::vector<entt::entity> droppedEntities;
 };
\ No newline at end of file
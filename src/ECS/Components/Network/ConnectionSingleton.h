@@ -1,5 +1,6 @@
 #pragma once
 #include <NovusTypes.h>
+#include <vector>
 #include <Utils/ConcurrentQueue.h>
 #include <Networking/NetworkPacket.h>
 #include <Networking/NetworkClient.h>
@@ -10,4 +11,5 @@ struct ConnectionSingleton
 
     std::shared_ptr<NetworkClient> networkClient;
     moodycamel::ConcurrentQueue<std::shared_ptr<NetworkPacket>> packetQueue;
+    std::vector<u8> partialFrame; // Bytes of a frame split across reads
 };
\ No newline at end of file
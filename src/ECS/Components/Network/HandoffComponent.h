@@ -0,0 +1,17 @@
+#pragma once
+#include <NovusTypes.h>
+
+enum class HandoffState : u8
+{
+    PENDING, // State sent, waiting for the peer to accept it
+    ACCEPTED // Client redirected, anything it still sends us is forwarded
+};
+
+// Added to a connection's entity while it is handed off to another region, its packets are held back from dispatch
+struct HandoffComponent
+{
+    u64 token;
+    u32 linkId;
+    HandoffState state;
+    f32 startTime;
+};
@@ -0,0 +1,34 @@
+#pragma once
+#include <NovusTypes.h>
+#include <vector>
+#include <unordered_map>
+#include <entt.hpp>
+
+class HandoffLink;
+
+// State handed to us by another region, kept until its client reconnects here with the token
+struct HandoffIncoming
+{
+    std::vector<u8> state; // EntityBlob of the handed off entity
+    std::vector<u8> packets; // Frames the client sent the old region after the state was captured
+    entt::entity boundEntity = entt::null;
+    f32 expireTime;
+};
+
+struct HandoffResume
+{
+    entt::entity entity;
+    u64 token;
+};
+
+struct HandoffSingleton
+{
+    HandoffLink* link = nullptr;
+    u32 requestedCount = 0;
+
+    std::unordered_map<u64, entt::entity> outgoing; // Handoffs waiting for the peer to accept them, by token
+    std::unordered_map<u64, HandoffIncoming> incoming;
+
+    // Clients that presented a token this tick, filled by ConnectionUpdateSystem
+    std::vector<HandoffResume> resumes;
+};
@@ -0,0 +1,46 @@
+#pragma once
+#include <NovusTypes.h>
+#include <array>
+#include <bitset>
+#include <vector>
+#include <asio.hpp>
+#include <Utils/ByteBuffer.h>
+#include "../../../Network/Udp/UdpProtocol.h"
+
+struct UdpSentDatagram
+{
+    std::shared_ptr<Bytebuffer> datagram;
+    UdpChannel channel;
+    u16 sequence;
+    u8 sendCount;
+    f32 sendTime;
+};
+
+struct UdpChannelState
+{
+    u16 nextSendSequence = 0;
+    std::vector<std::shared_ptr<Bytebuffer>> waiting; // Frames held until the send window has room again
+
+    // Reliable channels: the oldest sequence not received yet and which of the UDP_RECEIVE_WINDOW after it were.
+    // Unreliable sequenced: the newest sequence delivered
+    u16 receiveSequence = 0;
+    bool hasReceived = false;
+    std::bitset<UDP_RECEIVE_WINDOW> received;
+    std::vector<std::shared_ptr<Bytebuffer>> heldBack; // Payloads that arrived ahead of receiveSequence, only on RELIABLE_ORDERED
+
+    std::vector<u16> pendingAcks; // Sent together once per tick
+};
+
+// Added to a connection's entity once its client asked for a UDP channel with CMSG_UDP_REQUEST
+struct UdpComponent
+{
+    u64 token = 0;
+
+    // Unknown until the first datagram carrying the token arrives, until then frames go over TCP
+    asio::ip::udp::endpoint endpoint;
+    bool isBound = false;
+
+    std::array<UdpChannelState, static_cast<size_t>(UdpChannel::COUNT)> channels;
+    std::vector<UdpSentDatagram> unacked;
+    f32 smoothedRtt = 0.1f;
+};
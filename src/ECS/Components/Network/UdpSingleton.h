@@ -0,0 +1,19 @@
+#pragma once
+#include <NovusTypes.h>
+#include <vector>
+#include <unordered_map>
+#include <entt.hpp>
+
+class UdpTransport;
+
+struct UdpSingleton
+{
+    UdpTransport* transport = nullptr; // Only set when the region has a UDP port
+
+    std::unordered_map<u64, entt::entity> tokens;
+
+    // Connections that sent CMSG_UDP_REQUEST this tick, filled by ConnectionUpdateSystem
+    std::vector<entt::entity> requests;
+
+    std::vector<u8> partialFrame; // Always empty between datagrams, a frame may not span two of them
+};
@@ -0,0 +1,91 @@
+#pragma once
+#include <NovusTypes.h>
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <limits>
+#include <Networking/NetworkPacket.h>
+#include "../../../Utils/AllocationTracker.h"
+#include "TickStatsSingleton.h"
+
+enum class SystemId : u8
+{
+    TIMERS,
+    CONNECTION_UPDATE,
+    CONNECTION_DEFERRED,
+    MOVEMENT,
+    SNAPSHOT,
+    HANDOFF,
+    ZONE_MESSAGES,
+    UDP,
+    POSITION_BROADCAST,
+    COUNT
+};
+
+enum class WorkClass : u8
+{
+    ESSENTIAL, // Runs every tick regardless of load
+    DEFERRABLE // May be spread over several ticks while the governor is shedding load
+};
+
+struct GovernorSingleton
+{
+    GovernorSingleton()
+    {
+        for (auto& cost : systemCost)
+            cost.store(0, std::memory_order_relaxed);
+
+        systemClass.fill(WorkClass::ESSENTIAL);
+    }
+
+    void SetSystemClass(SystemId systemId, WorkClass workClass) { systemClass[static_cast<size_t>(systemId)] = workClass; }
+    void SetPacketClass(Opcode opcode, WorkClass workClass) { deferrableOpcodes[static_cast<u16>(opcode)] = workClass == WorkClass::DEFERRABLE; }
+
+    bool ShouldRun(SystemId systemId) const { return systemClass[static_cast<size_t>(systemId)] == WorkClass::ESSENTIAL || tick % deferredSystemInterval == 0; }
+    bool IsDeferrable(Opcode opcode) const { return deferrableOpcodes[static_cast<u16>(opcode)]; }
+
+    void AddCost(SystemId systemId, u64 nanoseconds) { systemCost[static_cast<size_t>(systemId)].fetch_add(nanoseconds, std::memory_order_relaxed); }
+
+    // CPU time spent by each system this tick, summed over every task it ran
+    std::array<std::atomic<u64>, static_cast<size_t>(SystemId::COUNT)> systemCost;
+    std::array<WorkClass, static_cast<size_t>(SystemId::COUNT)> systemClass;
+    std::bitset<std::numeric_limits<u16>::max() + 1> deferrableOpcodes;
+
+    u64 tick = 0;
+    u8 level = 0; // 0 is full fidelity, every level sheds more deferrable work
+    u32 overrunTicks = 0;
+    u32 healthyTicks = 0;
+
+    // Derived from level by GovernorSystem
+    u32 deferredSystemInterval = 1; // Deferrable systems run every Nth tick
+    u32 deferrablePacketBudget = std::numeric_limits<u32>::max(); // Deferrable packets dispatched per connection per tick
+    u32 acceptBudget = std::numeric_limits<u32>::max(); // New connections accepted per tick
+};
+
+// Adds the lifetime of the scope to the cost of a system and records it as a span for the flight recorder
+// Every taskflow task runs inside one, which also makes it where their heap allocations get counted in the allocation tracking build
+class SystemCostScope
+{
+public:
+    SystemCostScope(GovernorSingleton& governor, TickStatsSingleton& tickStats, SystemId systemId) : _governor(governor), _tickStats(tickStats), _systemId(systemId)
+    {
+        _start = std::chrono::steady_clock::now();
+    }
+    ~SystemCostScope()
+    {
+        auto duration = std::chrono::steady_clock::now() - _start;
+        u64 durationNs = static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+        u64 startNs = static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(_start.time_since_epoch()).count());
+
+        _governor.AddCost(_systemId, durationNs);
+        _tickStats.AddSpan(static_cast<u8>(_systemId), startNs, durationNs);
+    }
+
+private:
+    GovernorSingleton& _governor;
+    TickStatsSingleton& _tickStats;
+    SystemId _systemId;
+    std::chrono::steady_clock::time_point _start;
+    AllocationScope _allocationScope;
+};
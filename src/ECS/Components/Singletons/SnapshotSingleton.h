@@ -0,0 +1,13 @@
+#pragma once
+#include <NovusTypes.h>
+#include <vector>
+#include <entity/fwd.hpp>
+
+class SnapshotWriter;
+struct SnapshotSingleton
+{
+    SnapshotWriter* writer = nullptr;
+    std::vector<entt::registry*> registries; // Every zone's registry, indexed by zone id
+    f32 interval = 10.0f;
+    f32 lastSnapshotTime = 0.0f;
+};
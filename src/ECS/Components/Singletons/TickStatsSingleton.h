@@ -0,0 +1,96 @@
+#pragma once
+#include <NovusTypes.h>
+#include <array>
+#include <atomic>
+
+constexpr u32 TICK_STATS_MAX_SPANS = 64;
+constexpr u32 TICK_STATS_MAX_OPCODES = 16;
+
+// One run of a system on one thread
+struct SystemSpan
+{
+    u8 systemId;
+    u16 threadIndex;
+    u64 startNs;
+    u64 durationNs;
+};
+
+struct OpcodeCount
+{
+    u16 opcode;
+    u32 count;
+};
+
+// Small stable index per thread, the flight recorder uses it as the trace's thread id
+inline u16 GetTraceThreadIndex()
+{
+    static std::atomic<u16> nextThreadIndex(1);
+    thread_local u16 threadIndex = nextThreadIndex.fetch_add(1, std::memory_order_relaxed);
+    return threadIndex;
+}
+
+// Filled in by the systems over the course of a tick, the flight recorder takes a copy and resets it at the end of the tick
+struct TickStatsSingleton
+{
+    // Called from any worker, spans past the limit are dropped
+    void AddSpan(u8 systemId, u64 startNs, u64 durationNs)
+    {
+        u32 index = spanCount.fetch_add(1, std::memory_order_relaxed);
+        if (index < TICK_STATS_MAX_SPANS)
+            spans[index] = { systemId, GetTraceThreadIndex(), startNs, durationNs };
+    }
+
+    // Takes over a span recorded by another zone, keeping the thread it ran on
+    void AddSpan(const SystemSpan& span)
+    {
+        u32 index = spanCount.fetch_add(1, std::memory_order_relaxed);
+        if (index < TICK_STATS_MAX_SPANS)
+            spans[index] = span;
+    }
+
+    // Packets are only dispatched by ConnectionUpdateSystem and HandoffSystem, whose tasks never overlap
+    void AddPacket(u16 opcode)
+    {
+        packetsDispatched++;
+
+        for (u32 i = 0; i < opcodeCount; i++)
+        {
+            if (opcodeCounts[i].opcode == opcode)
+            {
+                opcodeCounts[i].count++;
+                return;
+            }
+        }
+
+        if (opcodeCount < TICK_STATS_MAX_OPCODES)
+            opcodeCounts[opcodeCount++] = { opcode, 1 };
+        else
+            otherPackets++;
+    }
+
+    void Reset()
+    {
+        spanCount.store(0, std::memory_order_relaxed);
+        opcodeCount = 0;
+        otherPackets = 0;
+        packetsDispatched = 0;
+        clientQueueDepth = 0;
+        upstreamQueueDepth = 0;
+        newConnectionQueueDepth = 0;
+        connectionCount = 0;
+    }
+
+    std::array<SystemSpan, TICK_STATS_MAX_SPANS> spans;
+    std::atomic<u32> spanCount = 0;
+
+    std::array<OpcodeCount, TICK_STATS_MAX_OPCODES> opcodeCounts;
+    u32 opcodeCount = 0;
+    u32 otherPackets = 0; // Packets whose opcode did not fit in opcodeCounts
+    u32 packetsDispatched = 0;
+
+    // Sampled before the queues are drained
+    u32 clientQueueDepth = 0;
+    u32 upstreamQueueDepth = 0;
+    u32 newConnectionQueueDepth = 0;
+    u32 connectionCount = 0;
+};
@@ -1,9 +1,13 @@
 #pragma once
 #include <NovusTypes.h>
 
+// The rate the engine loop aims to tick at, the timer wheel counts in slots of the same length
+constexpr f32 TICKS_PER_SECOND = 60.0f;
+
 struct TimeSingleton
 {
     f32 deltaTime;
     f32 lifeTimeInS;
     f32 lifeTimeInMS;
+    u64 tick;
 };
\ No newline at end of file
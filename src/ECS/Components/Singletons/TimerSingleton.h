@@ -0,0 +1,42 @@
+#pragma once
+#include <NovusTypes.h>
+#include <cmath>
+#include <vector>
+#include <entt.hpp>
+#include "../../../Utils/TimerWheel.h"
+#include "TimeSingleton.h"
+
+enum class TimerType : u16
+{
+    HANDSHAKE, // A new connection has to send a valid packet before this fires
+    IDLE, // Closes connections that went quiet, rescheduled lazily from the last activity
+    UPSTREAM_REQUEST, // A request forwarded to the Novus Service for this connection went unanswered
+    FLUSH // Sends the connection's coalesced MEDIUM and LOW priority frames
+};
+
+struct TimerSingleton
+{
+    TimerHandle Schedule(f32 seconds, TimerType type, entt::entity entity)
+    {
+        return wheel.Schedule(ToTicks(seconds), static_cast<u16>(type), entt::to_integral(entity));
+    }
+
+    // Cancels the timer if it is still pending and clears the handle
+    void Cancel(TimerHandle& handle)
+    {
+        if (handle != 0)
+            wheel.Cancel(handle);
+
+        handle = 0;
+    }
+
+    u64 ToTicks(f32 seconds) const { return static_cast<u64>(std::ceil(seconds * TICKS_PER_SECOND)); }
+
+    // The wheel follows the lifetime rather than the tick count, so timeouts keep to wall time while ticks run long
+    static u64 ToWheelTick(f32 lifeTimeInS) { return static_cast<u64>(lifeTimeInS * TICKS_PER_SECOND); }
+
+    TimerWheel wheel;
+
+    // Timers that expired this tick, dispatched as one batch by TimerSystem
+    std::vector<TimerEvent> expired;
+};
@@ -0,0 +1,9 @@
+#pragma once
+#include <NovusTypes.h>
+#include "../../../Zones/ZoneRouter.h"
+
+struct ZoneSingleton
+{
+    u32 zoneId = 0; // The primary zone, which owns the connections, is always 0
+    ZoneRouter* router = nullptr; // Only set when the process hosts more than one zone
+};
@@ -0,0 +1,94 @@
+#include "GovernorSystem.h"
+#include <entt.hpp>
+#include <tracy/Tracy.hpp>
+#include "../../Components/Singletons/GovernorSingleton.h"
+#include "../../../Utils/Metrics.h"
+
+// Consecutive overrunning ticks before we shed another level of work
+constexpr u32 GOVERNOR_OVERRUN_TICKS = 5;
+// Consecutive ticks below GOVERNOR_RECOVERY_RATIO of the budget before we restore a level
+constexpr u32 GOVERNOR_RECOVERY_TICKS = 120;
+constexpr f32 GOVERNOR_RECOVERY_RATIO = 0.7f;
+constexpr u8 GOVERNOR_MAX_LEVEL = 3;
+
+constexpr u32 GOVERNOR_PACKET_BUDGETS[GOVERNOR_MAX_LEVEL + 1] = { std::numeric_limits<u32>::max(), 16, 8, 4 };
+constexpr u32 GOVERNOR_ACCEPT_BUDGETS[GOVERNOR_MAX_LEVEL + 1] = { std::numeric_limits<u32>::max(), 64, 32, 16 };
+
+constexpr const char* SYSTEM_COST_METRICS[static_cast<size_t>(SystemId::COUNT)] =
+{
+    "system.timers.costUs",
+    "system.connectionUpdate.costUs",
+    "system.connectionDeferred.costUs",
+    "system.movement.costUs",
+    "system.snapshot.costUs",
+    "system.handoff.costUs",
+    "system.zoneMessages.costUs",
+    "system.udp.costUs",
+    "system.positionBroadcast.costUs"
+};
+
+static void ApplyLevel(GovernorSingleton& governor)
+{
+    governor.deferredSystemInterval = 1u << governor.level;
+    governor.deferrablePacketBudget = GOVERNOR_PACKET_BUDGETS[governor.level];
+    governor.acceptBudget = GOVERNOR_ACCEPT_BUDGETS[governor.level];
+}
+
+void GovernorSystem::Update(entt::registry& registry, f32 updateTime, f32 targetDelta)
+{
+    ZoneScopedNC("GovernorSystem::Update", tracy::Color::Blue2)
+    GovernorSingleton& governor = registry.ctx<GovernorSingleton>();
+
+    static std::atomic<i64>& tickTimeMetric = Metrics::Get("governor.tickTimeUs");
+    static std::atomic<i64>& levelMetric = Metrics::Get("governor.level");
+    static std::atomic<i64>& escalationsMetric = Metrics::Get("governor.escalations");
+    static std::atomic<i64>& recoveriesMetric = Metrics::Get("governor.recoveries");
+    static std::atomic<i64>& overrunsMetric = Metrics::Get("governor.overrunTicks");
+
+    static std::atomic<i64>* systemCostMetrics[static_cast<size_t>(SystemId::COUNT)] = { };
+    for (size_t i = 0; i < static_cast<size_t>(SystemId::COUNT); i++)
+    {
+        if (!systemCostMetrics[i])
+            systemCostMetrics[i] = &Metrics::Get(SYSTEM_COST_METRICS[i]);
+
+        u64 cost = governor.systemCost[i].exchange(0, std::memory_order_relaxed);
+        systemCostMetrics[i]->store(static_cast<i64>(cost / 1000), std::memory_order_relaxed);
+    }
+    tickTimeMetric.store(static_cast<i64>(updateTime * 1000000.0f), std::memory_order_relaxed);
+
+    if (updateTime > targetDelta)
+    {
+        governor.overrunTicks++;
+        governor.healthyTicks = 0;
+        overrunsMetric.fetch_add(1, std::memory_order_relaxed);
+    }
+    else if (updateTime < targetDelta * GOVERNOR_RECOVERY_RATIO)
+    {
+        governor.healthyTicks++;
+        governor.overrunTicks = 0;
+    }
+    else
+    {
+        // Close to the budget, hold the current level
+        governor.overrunTicks = 0;
+        governor.healthyTicks = 0;
+    }
+
+    if (governor.overrunTicks >= GOVERNOR_OVERRUN_TICKS && governor.level < GOVERNOR_MAX_LEVEL)
+    {
+        governor.level++;
+        governor.overrunTicks = 0;
+        escalationsMetric.fetch_add(1, std::memory_order_relaxed);
+        ApplyLevel(governor);
+    }
+    else if (governor.healthyTicks >= GOVERNOR_RECOVERY_TICKS && governor.level > 0)
+    {
+        governor.level--;
+        governor.healthyTicks = 0;
+        recoveriesMetric.fetch_add(1, std::memory_order_relaxed);
+        ApplyLevel(governor);
+    }
+
+    levelMetric.store(governor.level, std::memory_order_relaxed);
+    governor.tick++;
+}
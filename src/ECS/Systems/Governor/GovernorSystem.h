@@ -0,0 +1,10 @@
+#pragma once
+#include <NovusTypes.h>
+#include <entity/fwd.hpp>
+
+class GovernorSystem
+{
+public:
+    // Runs once the tick's systems have completed, updateTime is how long the tick took excluding the tick rate wait
+    static void Update(entt::registry& registry, f32 updateTime, f32 targetDelta);
+};
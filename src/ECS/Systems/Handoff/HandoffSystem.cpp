@@ -0,0 +1,428 @@
+#include "HandoffSystem.h"
+#include <random>
+#include <cstring>
+#include <entt.hpp>
+#include <tracy/Tracy.hpp>
+#include <Networking/NetworkClient.h>
+#include <Networking/PacketUtils.h>
+#include "../Network/ConnectionSystems.h"
+#include "../../Components/Network/ConnectionComponent.h"
+#include "../../Components/Network/HandoffComponent.h"
+#include "../../Components/Network/HandoffSingleton.h"
+#include "../../Components/Singletons/TimeSingleton.h"
+#include "../../Components/Singletons/TickStatsSingleton.h"
+#include "../../../Network/Handoff/HandoffLink.h"
+#include "../../../Network/RegionOpcodes.h"
+#include "../../../Snapshot/EntityBlob.h"
+#include "../../../Utils/FrameArena.h"
+#include "../../../Utils/Metrics.h"
+#include "../../../Utils/ServiceLocator.h"
+#include "../../../EngineLoop.h"
+
+// A peer that has not answered by then is treated as gone and the connection resumes here
+constexpr f32 HANDOFF_ACCEPT_TIMEOUT = 10.0f;
+// How long handed off state waits for its client, and keeps routing forwarded packets after it arrived
+constexpr f32 HANDOFF_RESUME_TIMEOUT = 30.0f;
+
+template <typename Buffer, typename T>
+static void Append(Buffer& buffer, const T& value)
+{
+    size_t offset = buffer.size();
+    buffer.resize(offset + sizeof(T));
+    std::memcpy(buffer.data() + offset, &value, sizeof(T));
+}
+
+template <typename T>
+static bool Read(const u8*& data, const u8* end, T& value)
+{
+    if (static_cast<size_t>(end - data) < sizeof(T))
+        return false;
+
+    std::memcpy(&value, data, sizeof(T));
+    data += sizeof(T);
+    return true;
+}
+
+static u64 GenerateToken()
+{
+    static std::mt19937_64 generator(std::random_device{}());
+
+    u64 token = 0;
+    while (token == 0)
+        token = generator();
+
+    return token;
+}
+
+// Drains the client's queued packets into a PACKETS message, frames are kept exactly as they were received
+// This runs every tick for every redirected connection, so the message is assembled in frame memory
+static void ForwardPackets(HandoffLink& link, ConnectionComponent& connection, u64 token)
+{
+    FrameVector<u8> payload;
+    Append(payload, token);
+
+    std::shared_ptr<NetworkPacket> packet;
+    while (connection.packetQueue.try_dequeue(packet))
+    {
+        u16 payloadSize = packet->header.size & PACKET_SIZE_MASK;
+        Append(payload, static_cast<u16>(packet->header.opcode));
+        Append(payload, packet->header.size);
+
+        if (payloadSize)
+        {
+            size_t offset = payload.size();
+            payload.resize(offset + payloadSize);
+            std::memcpy(payload.data() + offset, packet->payload->GetDataPointer(), payloadSize);
+        }
+    }
+
+    if (payload.size() > sizeof(u64))
+        link.Send(link.GetPeerLinkId(), HandoffMessageType::PACKETS, payload.data(), payload.size());
+}
+
+// Dispatches frames forwarded by the old region as if the client had sent them to us
+static bool DispatchForwardedPackets(ConnectionComponent& connection, const u8* data, const u8* end, TickStatsSingleton& tickStats)
+{
+    while (data < end)
+    {
+        u16 opcode = 0;
+        u16 size = 0;
+        if (!Read(data, end, opcode) || !Read(data, end, size))
+            return false;
+
+        u16 payloadSize = size & PACKET_SIZE_MASK;
+        if (payloadSize > NETWORK_BUFFER_SIZE || static_cast<size_t>(end - data) < payloadSize)
+            return false;
+
+        std::shared_ptr<NetworkPacket> packet = NetworkPacket::Borrow();
+        packet->header.opcode = static_cast<Opcode>(opcode);
+        packet->header.size = size;
+
+        if (payloadSize)
+        {
+            packet->payload = Bytebuffer::Borrow<NETWORK_BUFFER_SIZE>();
+            packet->payload->size = payloadSize;
+            packet->payload->writtenData = payloadSize;
+            std::memcpy(packet->payload->GetDataPointer(), data, payloadSize);
+            data += payloadSize;
+        }
+
+        if (!ConnectionUpdateSystem::DispatchClientPacket(connection, packet, tickStats))
+            return false;
+    }
+
+    return true;
+}
+
+static void SendBatch(entt::registry& registry, HandoffSingleton& handoffSingleton, f32 now)
+{
+    static std::atomic<i64>& sentMetric = Metrics::Get("handoff.sent");
+
+    HandoffLink& link = *handoffSingleton.link;
+
+    std::vector<u8> batch;
+    Append(batch, u32(0));
+
+    u32 count = 0;
+    auto view = registry.view<ConnectionComponent>();
+    for (entt::entity entity : view)
+    {
+        if (count == handoffSingleton.requestedCount)
+            break;
+
+        if (registry.try_get<HandoffComponent>(entity))
+            continue;
+
+        u64 token = GenerateToken();
+        Append(batch, token);
+
+        EntityBlob::Write(registry, entity, batch);
+
+        registry.emplace<HandoffComponent>(entity, HandoffComponent{ token, link.GetPeerLinkId(), HandoffState::PENDING, now });
+        handoffSingleton.outgoing[token] = entity;
+        count++;
+    }
+
+    if (count == 0)
+        return;
+
+    std::memcpy(batch.data(), &count, sizeof(u32));
+    link.Send(link.GetPeerLinkId(), HandoffMessageType::BATCH, batch.data(), batch.size());
+
+    sentMetric.fetch_add(count, std::memory_order_relaxed);
+    ServiceLocator::GetEngineLoop()->PrintMessage("[Handoff]: Handing %u connections off to the peer region", count);
+}
+
+static void HandleBatch(HandoffSingleton& handoffSingleton, HandoffMessage& message, f32 now)
+{
+    static std::atomic<i64>& receivedMetric = Metrics::Get("handoff.received");
+
+    const u8* data = message.payload.data();
+    const u8* end = data + message.payload.size();
+
+    u32 count = 0;
+    if (!Read(data, end, count))
+        return;
+
+    FrameVector<u8> reply;
+    Append(reply, u32(0));
+
+    u32 replyCount = 0;
+    for (u32 i = 0; i < count; i++)
+    {
+        u64 token = 0;
+        if (!Read(data, end, token))
+            break;
+
+        const u8* blob = data;
+        if (!EntityBlob::Skip(data, end))
+            break;
+
+        bool isAccepted = handoffSingleton.incoming.find(token) == handoffSingleton.incoming.end();
+        if (isAccepted)
+        {
+            HandoffIncoming& incoming = handoffSingleton.incoming[token];
+            incoming.state.assign(blob, data);
+            incoming.expireTime = now + HANDOFF_RESUME_TIMEOUT;
+        }
+
+        Append(reply, token);
+        Append(reply, static_cast<u8>(isAccepted));
+        replyCount++;
+    }
+
+    std::memcpy(reply.data(), &replyCount, sizeof(u32));
+    handoffSingleton.link->Send(message.linkId, HandoffMessageType::ACCEPT, reply.data(), reply.size());
+    receivedMetric.fetch_add(replyCount, std::memory_order_relaxed);
+}
+
+static void HandleAccept(entt::registry& registry, HandoffSingleton& handoffSingleton, HandoffMessage& message)
+{
+    static std::atomic<i64>& rejectedMetric = Metrics::Get("handoff.rejected");
+
+    HandoffLink& link = *handoffSingleton.link;
+    const u8* data = message.payload.data();
+    const u8* end = data + message.payload.size();
+
+    u32 count = 0;
+    if (!Read(data, end, count))
+        return;
+
+    for (u32 i = 0; i < count; i++)
+    {
+        u64 token = 0;
+        u8 isAccepted = 0;
+        if (!Read(data, end, token) || !Read(data, end, isAccepted))
+            return;
+
+        auto itr = handoffSingleton.outgoing.find(token);
+        if (itr == handoffSingleton.outgoing.end())
+            continue;
+
+        entt::entity entity = itr->second;
+        HandoffComponent* handoff = registry.valid(entity) ? registry.try_get<HandoffComponent>(entity) : nullptr;
+        if (!handoff || handoff->state != HandoffState::PENDING)
+        {
+            handoffSingleton.outgoing.erase(itr);
+            continue;
+        }
+
+        if (!isAccepted)
+        {
+            rejectedMetric.fetch_add(1, std::memory_order_relaxed);
+            registry.remove<HandoffComponent>(entity);
+            handoffSingleton.outgoing.erase(itr);
+            continue;
+        }
+
+        handoff->state = HandoffState::ACCEPTED;
+
+        // The peer owns the state from here on
+        EntityBlob::Remove(registry, entity);
+
+        ConnectionComponent& connection = registry.get<ConnectionComponent>(entity);
+        ForwardPackets(link, connection, token);
+
+        // The token has to reach the client before the redirect does
+        std::shared_ptr<Bytebuffer> buffer = Bytebuffer::Borrow<128>();
+        buffer->Put(ToOpcode(RegionOpcode::SMSG_HANDOFF_TOKEN));
+        buffer->PutU16(sizeof(u64));
+        buffer->Put(token);
+
+        if (PacketUtils::Write_SMSG_SEND_ADDRESS(buffer, 1, link.GetPeerClientAddress(), link.GetPeerClientPort()))
+            ConnectionUpdateSystem::Send(registry, entity, buffer, PacketPriority::HIGH);
+
+        // Packets still in flight to us are forwarded with the token kept on the HandoffComponent, nothing looks this one up again
+        handoffSingleton.outgoing.erase(itr);
+    }
+}
+
+static void HandlePackets(entt::registry& registry, HandoffSingleton& handoffSingleton, HandoffMessage& message)
+{
+    const u8* data = message.payload.data();
+    const u8* end = data + message.payload.size();
+
+    u64 token = 0;
+    if (!Read(data, end, token))
+        return;
+
+    auto itr = handoffSingleton.incoming.find(token);
+    if (itr == handoffSingleton.incoming.end())
+        return;
+
+    HandoffIncoming& incoming = itr->second;
+    if (incoming.boundEntity == entt::null)
+    {
+        incoming.packets.insert(incoming.packets.end(), data, end);
+        return;
+    }
+
+    // The client already resumed here, so these can be dispatched right away
+    if (!registry.valid(incoming.boundEntity))
+        return;
+
+    ConnectionComponent& connection = registry.get<ConnectionComponent>(incoming.boundEntity);
+    if (!DispatchForwardedPackets(connection, data, end, registry.ctx<TickStatsSingleton>()))
+        connection.connection->Close(asio::error::shut_down);
+}
+
+static void RollBack(entt::registry& registry, HandoffSingleton& handoffSingleton, u32 linkId, f32 now)
+{
+    static std::atomic<i64>& rolledBackMetric = Metrics::Get("handoff.rolledBack");
+
+    for (auto itr = handoffSingleton.outgoing.begin(); itr != handoffSingleton.outgoing.end();)
+    {
+        entt::entity entity = itr->second;
+        HandoffComponent* handoff = registry.valid(entity) ? registry.try_get<HandoffComponent>(entity) : nullptr;
+
+        if (!handoff)
+        {
+            itr = handoffSingleton.outgoing.erase(itr);
+            continue;
+        }
+
+        // A connection whose state was never accepted simply carries on here with its queued packets
+        bool isLinkLost = handoff->linkId == linkId;
+        bool isTimedOut = now - handoff->startTime > HANDOFF_ACCEPT_TIMEOUT;
+        if (handoff->state == HandoffState::PENDING && (isLinkLost || isTimedOut))
+        {
+            rolledBackMetric.fetch_add(1, std::memory_order_relaxed);
+            registry.remove<HandoffComponent>(entity);
+            itr = handoffSingleton.outgoing.erase(itr);
+            continue;
+        }
+
+        itr++;
+    }
+}
+
+static void Resume(entt::registry& registry, HandoffSingleton& handoffSingleton, HandoffResume& resume, f32 now)
+{
+    static std::atomic<i64>& resumedMetric = Metrics::Get("handoff.resumed");
+
+    if (!registry.valid(resume.entity))
+        return;
+
+    ConnectionComponent& connection = registry.get<ConnectionComponent>(resume.entity);
+
+    auto itr = handoffSingleton.incoming.find(resume.token);
+    if (itr == handoffSingleton.incoming.end() || itr->second.boundEntity != entt::null)
+    {
+        ServiceLocator::GetEngineLoop()->PrintMessage("[Handoff]: Client presented an unknown handoff token");
+        connection.connection->Close(asio::error::no_permission);
+        return;
+    }
+
+    HandoffIncoming& incoming = itr->second;
+    const u8* data = incoming.state.data();
+    EntityBlob::Read(registry, resume.entity, data, data + incoming.state.size());
+
+    incoming.boundEntity = resume.entity;
+    incoming.expireTime = now + HANDOFF_RESUME_TIMEOUT;
+    incoming.state.clear();
+
+    // Whatever the client sent the old region goes ahead of the packets it queued here after resuming
+    const u8* packets = incoming.packets.data();
+    if (!DispatchForwardedPackets(connection, packets, packets + incoming.packets.size(), registry.ctx<TickStatsSingleton>()))
+        connection.connection->Close(asio::error::shut_down);
+
+    incoming.packets.clear();
+    resumedMetric.fetch_add(1, std::memory_order_relaxed);
+}
+
+void HandoffSystem::Update(entt::registry& registry)
+{
+    HandoffSingleton& handoffSingleton = registry.ctx<HandoffSingleton>();
+    if (!handoffSingleton.link)
+    {
+        handoffSingleton.resumes.clear();
+        return;
+    }
+
+    ZoneScopedNC("HandoffSystem::Update", tracy::Color::Blue2)
+    HandoffLink& link = *handoffSingleton.link;
+    f32 now = registry.ctx<TimeSingleton>().lifeTimeInS;
+
+    u32 requestedCount = 0;
+    while (link.TryGetRequest(requestedCount))
+    {
+        handoffSingleton.requestedCount += requestedCount;
+    }
+
+    if (handoffSingleton.requestedCount > 0)
+    {
+        if (link.IsPeerReady())
+            SendBatch(registry, handoffSingleton, now);
+        else
+            ServiceLocator::GetEngineLoop()->PrintMessage("[Handoff]: No peer region is linked, dropping the handoff request");
+
+        handoffSingleton.requestedCount = 0;
+    }
+
+    HandoffMessage message;
+    while (link.TryGetMessage(message))
+    {
+        switch (message.type)
+        {
+            case HandoffMessageType::BATCH:
+                HandleBatch(handoffSingleton, message, now);
+                break;
+            case HandoffMessageType::ACCEPT:
+                HandleAccept(registry, handoffSingleton, message);
+                break;
+            case HandoffMessageType::PACKETS:
+                HandlePackets(registry, handoffSingleton, message);
+                break;
+            case HandoffMessageType::DISCONNECTED:
+                RollBack(registry, handoffSingleton, message.linkId, now);
+                break;
+            default:
+                break;
+        }
+    }
+
+    for (HandoffResume& resume : handoffSingleton.resumes)
+    {
+        Resume(registry, handoffSingleton, resume, now);
+    }
+    handoffSingleton.resumes.clear();
+
+    // Clients that were redirected may still have had packets in flight to us
+    auto handoffView = registry.view<HandoffComponent, ConnectionComponent>();
+    handoffView.each([&link](const auto, HandoffComponent& handoff, ConnectionComponent& connection)
+        {
+            if (handoff.state == HandoffState::ACCEPTED && link.IsPeerReady())
+                ForwardPackets(link, connection, handoff.token);
+        });
+
+    // Link ids start at 1, so this only rolls back handoffs the peer never answered
+    RollBack(registry, handoffSingleton, 0, now);
+
+    for (auto itr = handoffSingleton.incoming.begin(); itr != handoffSingleton.incoming.end();)
+    {
+        if (now > itr->second.expireTime)
+            itr = handoffSingleton.incoming.erase(itr);
+        else
+            itr++;
+    }
+}
@@ -0,0 +1,12 @@
+#pragma once
+#include <entity/fwd.hpp>
+
+// Moves connections and their entity state between region processes over HandoffLink.
+// The old region sends the entity's components in a batch and holds the client's packets back.
+// Once the peer accepts, it forwards those packets and redirects the client with a token.
+// The client presents that token to the new region, which then attaches the state to its connection.
+class HandoffSystem
+{
+public:
+    static void Update(entt::registry& registry);
+};
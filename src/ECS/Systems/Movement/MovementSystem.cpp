@@ -0,0 +1,183 @@
+#include "MovementSystem.h"
+#include <algorithm>
+#include <entt.hpp>
+#include <tracy/Tracy.hpp>
+#include "../../Components/Singletons/TimeSingleton.h"
+#include "../../Components/Singletons/GovernorSingleton.h"
+#include "../../Components/Movement/PositionComponent.h"
+#include "../../Components/Movement/VelocityComponent.h"
+#include "../../Components/Movement/OrientationComponent.h"
+#include "../../Components/Network/HandoffComponent.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define NC_MOVEMENT_AVX2
+#define NC_MOVEMENT_SSE
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define NC_MOVEMENT_SSE
+#endif
+
+// Number of entities integrated by a single taskflow task
+constexpr size_t MOVEMENT_CHUNK_SIZE = 8192;
+constexpr f32 TWO_PI = 6.28318530718f;
+
+// dst[i] += src[i] * deltaTime for count floats
+static void IntegrateLinear(f32* dst, const f32* src, f32 deltaTime, size_t count)
+{
+    size_t i = 0;
+
+#ifdef NC_MOVEMENT_AVX2
+    const __m256 deltaTime8 = _mm256_set1_ps(deltaTime);
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 position = _mm256_loadu_ps(dst + i);
+        __m256 velocity = _mm256_loadu_ps(src + i);
+#ifdef __FMA__
+        position = _mm256_fmadd_ps(velocity, deltaTime8, position);
+#else
+        position = _mm256_add_ps(position, _mm256_mul_ps(velocity, deltaTime8));
+#endif
+        _mm256_storeu_ps(dst + i, position);
+    }
+#endif // NC_MOVEMENT_AVX2
+
+#ifdef NC_MOVEMENT_SSE
+    const __m128 deltaTime4 = _mm_set1_ps(deltaTime);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 position = _mm_loadu_ps(dst + i);
+        __m128 velocity = _mm_loadu_ps(src + i);
+        position = _mm_add_ps(position, _mm_mul_ps(velocity, deltaTime4));
+        _mm_storeu_ps(dst + i, position);
+    }
+#endif // NC_MOVEMENT_SSE
+
+    for (; i < count; i++)
+    {
+        dst[i] += src[i] * deltaTime;
+    }
+}
+
+// data is laid out as [yaw, turnRate] pairs, yaw += turnRate * deltaTime and is wrapped back into [0, 2*PI)
+// Wrapping assumes a single tick never turns more than a full revolution
+static void IntegrateAngular(f32* data, f32 deltaTime, size_t count)
+{
+    size_t i = 0;
+    size_t floatCount = count * 2;
+
+#ifdef NC_MOVEMENT_AVX2
+    const __m256 step8 = _mm256_setr_ps(deltaTime, 0.0f, deltaTime, 0.0f, deltaTime, 0.0f, deltaTime, 0.0f);
+    const __m256 wrap8 = _mm256_setr_ps(TWO_PI, 0.0f, TWO_PI, 0.0f, TWO_PI, 0.0f, TWO_PI, 0.0f);
+    const __m256 twoPi8 = _mm256_set1_ps(TWO_PI);
+    const __m256 zero8 = _mm256_setzero_ps();
+    for (; i + 8 <= floatCount; i += 8)
+    {
+        __m256 orientation = _mm256_loadu_ps(data + i);
+
+        // Broadcast every turnRate onto the yaw lane next to it, the turnRate lanes are multiplied by 0
+        __m256 turnRate = _mm256_movehdup_ps(orientation);
+        orientation = _mm256_add_ps(orientation, _mm256_mul_ps(turnRate, step8));
+
+        __m256 over = _mm256_and_ps(_mm256_cmp_ps(orientation, twoPi8, _CMP_GE_OQ), wrap8);
+        __m256 under = _mm256_and_ps(_mm256_cmp_ps(orientation, zero8, _CMP_LT_OQ), wrap8);
+        orientation = _mm256_add_ps(_mm256_sub_ps(orientation, over), under);
+
+        _mm256_storeu_ps(data + i, orientation);
+    }
+#endif // NC_MOVEMENT_AVX2
+
+#ifdef NC_MOVEMENT_SSE
+    const __m128 step4 = _mm_setr_ps(deltaTime, 0.0f, deltaTime, 0.0f);
+    const __m128 wrap4 = _mm_setr_ps(TWO_PI, 0.0f, TWO_PI, 0.0f);
+    const __m128 twoPi4 = _mm_set1_ps(TWO_PI);
+    const __m128 zero4 = _mm_setzero_ps();
+    for (; i + 4 <= floatCount; i += 4)
+    {
+        __m128 orientation = _mm_loadu_ps(data + i);
+
+        __m128 turnRate = _mm_shuffle_ps(orientation, orientation, _MM_SHUFFLE(3, 3, 1, 1));
+        orientation = _mm_add_ps(orientation, _mm_mul_ps(turnRate, step4));
+
+        __m128 over = _mm_and_ps(_mm_cmpge_ps(orientation, twoPi4), wrap4);
+        __m128 under = _mm_and_ps(_mm_cmplt_ps(orientation, zero4), wrap4);
+        orientation = _mm_add_ps(_mm_sub_ps(orientation, over), under);
+
+        _mm_storeu_ps(data + i, orientation);
+    }
+#endif // NC_MOVEMENT_SSE
+
+    for (; i < floatCount; i += 2)
+    {
+        f32 yaw = data[i] + data[i + 1] * deltaTime;
+        if (yaw >= TWO_PI)
+            yaw -= TWO_PI;
+        else if (yaw < 0.0f)
+            yaw += TWO_PI;
+
+        data[i] = yaw;
+    }
+}
+
+void MovementSystem::Update(entt::registry& registry, tf::Subflow& subflow)
+{
+    TimeSingleton& timeSingleton = registry.ctx<TimeSingleton>();
+    f32 deltaTime = timeSingleton.deltaTime;
+
+    // Chunks run after Update has returned, so they report their own cost
+    GovernorSingleton* governor = &registry.ctx<GovernorSingleton>();
+    TickStatsSingleton* tickStats = &registry.ctx<TickStatsSingleton>();
+
+    // The owning group keeps both pools sorted in the same order, which lets us integrate their raw arrays directly
+    // Entities being handed off are left out, their state was already sent to the peer and must not move on without it
+    auto linearGroup = registry.group<PositionComponent, VelocityComponent>(entt::exclude<HandoffComponent>);
+    size_t linearCount = linearGroup.size();
+    if (linearCount > 0)
+    {
+        f32* positions = reinterpret_cast<f32*>(linearGroup.raw<PositionComponent>());
+        const f32* velocities = reinterpret_cast<const f32*>(linearGroup.raw<VelocityComponent>());
+
+        if (linearCount <= MOVEMENT_CHUNK_SIZE)
+        {
+            IntegrateLinear(positions, velocities, deltaTime, linearCount * 3);
+        }
+        else
+        {
+            for (size_t begin = 0; begin < linearCount; begin += MOVEMENT_CHUNK_SIZE)
+            {
+                size_t count = std::min(MOVEMENT_CHUNK_SIZE, linearCount - begin);
+                subflow.emplace([governor, tickStats, positions, velocities, deltaTime, begin, count]()
+                {
+                    ZoneScopedNC("MovementSystem::IntegrateLinear", tracy::Color::Blue2)
+                    SystemCostScope costScope(*governor, *tickStats, SystemId::MOVEMENT);
+                    IntegrateLinear(positions + begin * 3, velocities + begin * 3, deltaTime, count * 3);
+                });
+            }
+        }
+    }
+
+    auto angularGroup = registry.group<OrientationComponent>(entt::exclude<HandoffComponent>);
+    size_t angularCount = angularGroup.size();
+    if (angularCount > 0)
+    {
+        f32* orientations = reinterpret_cast<f32*>(angularGroup.raw<OrientationComponent>());
+
+        if (angularCount <= MOVEMENT_CHUNK_SIZE)
+        {
+            IntegrateAngular(orientations, deltaTime, angularCount);
+        }
+        else
+        {
+            for (size_t begin = 0; begin < angularCount; begin += MOVEMENT_CHUNK_SIZE)
+            {
+                size_t count = std::min(MOVEMENT_CHUNK_SIZE, angularCount - begin);
+                subflow.emplace([governor, tickStats, orientations, deltaTime, begin, count]()
+                {
+                    ZoneScopedNC("MovementSystem::IntegrateAngular", tracy::Color::Blue2)
+                    SystemCostScope costScope(*governor, *tickStats, SystemId::MOVEMENT);
+                    IntegrateAngular(orientations + begin * 2, deltaTime, count);
+                });
+            }
+        }
+    }
+}
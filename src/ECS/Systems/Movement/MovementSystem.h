@@ -0,0 +1,11 @@
+#pragma once
+#include <entity/fwd.hpp>
+#include <taskflow/taskflow.hpp>
+
+class MovementSystem
+{
+public:
+    // Integrates PositionComponent/VelocityComponent and OrientationComponent by TimeSingleton::deltaTime,
+    // larger sets are split into chunks that are spread across the taskflow workers
+    static void Update(entt::registry& registry, tf::Subflow& subflow);
+};
@@ -1,55 +1,361 @@
 #include "ConnectionSystems.h"
+#include <algorithm>
+#include <array>
 #include <entt.hpp>
 #include <Networking/MessageHandler.h>
 #include <Networking/NetworkServer.h>
 #include "../../Components/Network/ConnectionSingleton.h"
-#include "../../Components/Network/AuthenticationSingleton.h"
 #include "../../Components/Network/ConnectionComponent.h"
 #include "../../Components/Network/ConnectionDeferredSingleton.h"
+#include "../../Components/Network/HandoffComponent.h"
+#include "../../Components/Network/HandoffSingleton.h"
+#include "../../Components/Network/UdpComponent.h"
+#include "../../Components/Network/UdpSingleton.h"
+#include "../../Components/Singletons/GovernorSingleton.h"
+#include "../../Components/Singletons/TickStatsSingleton.h"
+#include "../../Components/Singletons/TimerSingleton.h"
 #include "../../../Utils/ServiceLocator.h"
+#include "../../../Network/Recording/PacketRecorder.h"
+#include "../../../Network/IoUring/IoUringBackend.h"
+#include "../../../Network/Compression/PacketCompression.h"
+#include "../../../Network/Framing/PacketFramer.h"
+#include "../../../Network/Simulator/NetworkSimulator.h"
+#include "../../../Network/RegionOpcodes.h"
+#include "../../../Network/Handlers/Self/Auth/AuthHandlers.h"
+#include "../../../Utils/Metrics.h"
+#include "../../../Utils/PoolAllocator.h"
+#include "../../../EngineLoop.h"
 #include <tracy/Tracy.hpp>
 
+// Connections are measured once this many bytes were sent to them since the last time, and every tick while they are slow
+constexpr u64 OUTBOUND_MEASURE_BYTES = 16384;
+
+// The slowest connections are exported on their own, the rest only count towards the totals
+constexpr size_t SLOWEST_CONNECTION_COUNT = 5;
+constexpr const char* SLOWEST_CONNECTION_METRICS[SLOWEST_CONNECTION_COUNT][2] =
+{
+    { "network.slowest.0.entity", "network.slowest.0.backlogBytes" },
+    { "network.slowest.1.entity", "network.slowest.1.backlogBytes" },
+    { "network.slowest.2.entity", "network.slowest.2.backlogBytes" },
+    { "network.slowest.3.entity", "network.slowest.3.backlogBytes" },
+    { "network.slowest.4.entity", "network.slowest.4.backlogBytes" }
+};
+
+struct SlowConnection
+{
+    entt::entity entity = entt::null;
+    u64 backlog = 0;
+};
+
+// A slow client only gets what it can't do without, what can be lost is dropped
+static bool IsDroppedForSlowConsumer(const ConnectionComponent& connection, PacketPriority priority)
+{
+    if (connection.slowSinceTick == 0 || priority != PacketPriority::LOW)
+        return false;
+
+    static std::atomic<i64>& droppedMetric = Metrics::Get("network.slowConsumerDroppedFrames");
+    droppedMetric.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+// Returns false once the client fell so far behind on its reads that it has to be evicted
+static bool UpdateOutboundBacklog(ConnectionComponent& connection, const ConnectionDeferredSingleton& limits, u64 tick, u64 maxAgeTicks)
+{
+    OutboundBacklog& outbound = *connection.outbound;
+
+    // Keeping up costs no syscall, a client can only fall behind on bytes it was sent
+    if (connection.slowSinceTick == 0 && outbound.GetUnmeasuredBytes() < OUTBOUND_MEASURE_BYTES)
+        return true;
+
+    u64 backlog = outbound.Measure(static_cast<i64>(connection.connection->socket()->native_handle()));
+
+    // The hard cap applies on its own, even with the soft cap disabled
+    if (limits.outboundHardCap != 0 && backlog >= limits.outboundHardCap)
+        return false;
+
+    if (limits.outboundSoftCap == 0 || backlog < limits.outboundSoftCap)
+    {
+        connection.slowSinceTick = 0;
+        return true;
+    }
+
+    if (connection.slowSinceTick == 0)
+        connection.slowSinceTick = tick;
+
+    return maxAgeTicks == 0 || tick - connection.slowSinceTick < maxAgeTicks;
+}
+
 void ConnectionUpdateSystem::Update(entt::registry& registry)
 {
     ZoneScopedNC("ConnectionUpdateSystem::Update", tracy::Color::Blue)
+    if (!UpdateUpstream(registry))
+        return;
+
+    TickStatsSingleton& tickStats = registry.ctx<TickStatsSingleton>();
+
+    static std::atomic<i64>& budgetExhaustedMetric = Metrics::Get("governor.packetBudgetExhausted");
+    GovernorSingleton& governor = registry.ctx<GovernorSingleton>();
+
+    HandoffSingleton& handoffSingleton = registry.ctx<HandoffSingleton>();
+    UdpSingleton& udpSingleton = registry.ctx<UdpSingleton>();
+    TimerSingleton& timerSingleton = registry.ctx<TimerSingleton>();
+
+    // Activity and slow consumer ages are kept in wheel ticks, which is what the timeouts compare them against
+    u64 tick = timerSingleton.wheel.GetTick();
+
+    auto view = registry.view<ConnectionComponent>();
+    tickStats.connectionCount = static_cast<u32>(view.size());
+
+    static std::atomic<i64>& connectionsMetric = Metrics::Get("network.connections");
+    connectionsMetric.store(tickStats.connectionCount, std::memory_order_relaxed);
+
+    static std::atomic<i64>& backlogMetric = Metrics::Get("network.outboundBacklogBytes");
+    static std::atomic<i64>& slowConnectionsMetric = Metrics::Get("network.slowConnections");
+    static std::atomic<i64>& evictionsMetric = Metrics::Get("network.slowConsumerEvictions");
+
+    const ConnectionDeferredSingleton& outboundLimits = registry.ctx<ConnectionDeferredSingleton>();
+    u64 outboundMaxAgeTicks = timerSingleton.ToTicks(outboundLimits.outboundMaxAge);
+
+    u64 totalBacklog = 0;
+    i64 slowConnectionCount = 0;
+    std::array<SlowConnection, SLOWEST_CONNECTION_COUNT> slowestConnections;
+
+    view.each([&registry, &governor, &tickStats, &handoffSingleton, &udpSingleton, &timerSingleton, tick, &outboundLimits, outboundMaxAgeTicks, &totalBacklog, &slowConnectionCount, &slowestConnections](const auto entity, ConnectionComponent& connection)
+        {
+            tickStats.clientQueueDepth += static_cast<u32>(connection.packetQueue.size_approx());
+
+            // Everything sent to a client that stopped reading would otherwise pile up in its NetworkClient for as long as it stays connected
+            if (!connection.isEvicted && !UpdateOutboundBacklog(connection, outboundLimits, tick, outboundMaxAgeTicks))
+            {
+                evictionsMetric.fetch_add(1, std::memory_order_relaxed);
+                connection.isEvicted = true;
+                connection.connection->Close(asio::error::no_buffer_space);
+            }
+
+            u64 backlog = connection.outbound->GetBacklog();
+            totalBacklog += backlog;
+
+            if (connection.slowSinceTick != 0)
+            {
+                slowConnectionCount++;
+
+                // Kept sorted, slowest first
+                if (backlog > slowestConnections.back().backlog)
+                {
+                    size_t i = SLOWEST_CONNECTION_COUNT - 1;
+                    for (; i > 0 && slowestConnections[i - 1].backlog < backlog; i--)
+                        slowestConnections[i] = slowestConnections[i - 1];
+
+                    slowestConnections[i] = { entity, backlog };
+                }
+            }
+
+            if (connection.isEvicted)
+                return;
+
+            // Connections being handed off keep their packets queued, HandoffSystem forwards them to the new region
+            if (registry.try_get<HandoffComponent>(entity))
+                return;
+
+            // Once a connection used up its deferrable budget the rest of its queue waits for the next tick, which keeps its packets in order
+            u32 deferrableBudget = governor.deferrablePacketBudget;
+
+            std::shared_ptr<NetworkPacket> packet;
+            while (deferrableBudget > 0 && connection.packetQueue.try_dequeue(packet))
+            {
+#ifdef NC_Debug
+                ServiceLocator::GetEngineLoop()->PrintMessage("[Network/ServerSocket]: CMD: %u, Size: %u", packet->header.opcode, packet->header.size);
+#endif // NC_Debug
+
+                if (governor.IsDeferrable(packet->header.opcode))
+                    deferrableBudget--;
+
+                // Only a plain store per packet, the idle timer compares against it once it fires
+                connection.lastActivityTick = tick;
+
+                // The frames intercepted below read their payload, which a compressed frame only has once it was decompressed
+                if (!DecompressClientPacket(connection, packet))
+                {
+                    connection.connection->Close(asio::error::shut_down);
+                    return;
+                }
+
+                // HandoffSystem attaches the handed off state first, the packets behind this one wait for the next tick
+                if (packet->header.opcode == ToOpcode(RegionOpcode::CMSG_HANDOFF_RESUME))
+                {
+                    u64 token = 0;
+                    if (packet->payload && packet->payload->Get(token))
+                        handoffSingleton.resumes.push_back({ entity, token });
+
+                    timerSingleton.Cancel(connection.handshakeTimer);
+
+                    break;
+                }
+
+                // UdpSystem opens the channel on the next tick and answers with SMSG_UDP_TOKEN over this connection
+                if (packet->header.opcode == ToOpcode(RegionOpcode::CMSG_UDP_REQUEST))
+                {
+                    if (udpSingleton.transport)
+                        udpSingleton.requests.push_back(entity);
+
+                    continue;
+                }
+
+                if (!DispatchClientPacket(connection, packet, tickStats))
+                {
+                    connection.connection->Close(asio::error::shut_down);
+                    return;
+                }
+
+                timerSingleton.Cancel(connection.handshakeTimer);
+            }
+
+            if (deferrableBudget == 0)
+                budgetExhaustedMetric.fetch_add(1, std::memory_order_relaxed);
+        });
+
+    backlogMetric.store(static_cast<i64>(totalBacklog), std::memory_order_relaxed);
+    slowConnectionsMetric.store(slowConnectionCount, std::memory_order_relaxed);
+
+    static std::atomic<i64>* slowestConnectionMetrics[SLOWEST_CONNECTION_COUNT][2] = { };
+    for (size_t i = 0; i < SLOWEST_CONNECTION_COUNT; i++)
+    {
+        if (!slowestConnectionMetrics[i][0])
+        {
+            slowestConnectionMetrics[i][0] = &Metrics::Get(SLOWEST_CONNECTION_METRICS[i][0]);
+            slowestConnectionMetrics[i][1] = &Metrics::Get(SLOWEST_CONNECTION_METRICS[i][1]);
+        }
+
+        // Unused slots read as entity -1
+        const SlowConnection& slowConnection = slowestConnections[i];
+        i64 entityId = slowConnection.entity == entt::null ? -1 : static_cast<i64>(entt::to_integral(slowConnection.entity));
+
+        slowestConnectionMetrics[i][0]->store(entityId, std::memory_order_relaxed);
+        slowestConnectionMetrics[i][1]->store(static_cast<i64>(slowConnection.backlog), std::memory_order_relaxed);
+    }
+}
+
+bool ConnectionUpdateSystem::UpdateUpstream(entt::registry& registry)
+{
     ConnectionSingleton& connectionSingleton = registry.ctx<ConnectionSingleton>();
+    TickStatsSingleton& tickStats = registry.ctx<TickStatsSingleton>();
+    tickStats.upstreamQueueDepth = static_cast<u32>(connectionSingleton.packetQueue.size_approx());
+
     if (connectionSingleton.networkClient)
     {
         std::shared_ptr<NetworkPacket> packet = nullptr;
 
+        InternalSocket::AuthHandlers::ApplyCompletedSteps(registry);
+
         MessageHandler* networkMessageHandler = ServiceLocator::GetSelfMessageHandler();
         while (connectionSingleton.packetQueue.try_dequeue(packet))
         {
 #ifdef NC_Debug
-            DebugHandler::PrintSuccess("[Network/ClientSocket]: CMD: %u, Size: %u", packet->header.opcode, packet->header.size);
+            ServiceLocator::GetEngineLoop()->PrintMessage("[Network/ClientSocket]: CMD: %u, Size: %u", packet->header.opcode, packet->header.size);
 #endif // NC_Debug
 
+            tickStats.AddPacket(static_cast<u16>(packet->header.opcode));
             if (!networkMessageHandler->CallHandler(connectionSingleton.networkClient, packet))
             {
                 connectionSingleton.networkClient->Close(asio::error::shut_down);
-                return;
+                return false;
             }
         }
     }
 
-    MessageHandler* clientMessageHandler = ServiceLocator::GetClientMessageHandler();
-    auto view = registry.view<ConnectionComponent>();
-    view.each([&registry, &clientMessageHandler](const auto, ConnectionComponent& connection)
-        {
-            std::shared_ptr<NetworkPacket> packet;
-            while (connection.packetQueue.try_dequeue(packet))
-            {
-#ifdef NC_Debug
-                DebugHandler::PrintSuccess("[Network/ServerSocket]: CMD: %u, Size: %u", packet->header.opcode, packet->header.size);
-#endif // NC_Debug
+    return true;
+}
 
-                if (!clientMessageHandler->CallHandler(connection.connection, packet))
-                {
-                    connection.connection->Close(asio::error::shut_down);
-                    return;
-                }
-            }
-        });
+bool ConnectionUpdateSystem::DecompressClientPacket(ConnectionComponent& connection, std::shared_ptr<NetworkPacket>& packet)
+{
+    if (!(packet->header.size & PACKET_COMPRESSED_FLAG))
+        return true;
+
+    if (!PacketCompression::Decompress(packet))
+        return false;
+
+    // A client sending compressed frames tells us it can also receive them
+    connection.supportsCompression = true;
+    return true;
+}
+
+bool ConnectionUpdateSystem::DispatchClientPacket(ConnectionComponent& connection, std::shared_ptr<NetworkPacket>& packet, TickStatsSingleton& tickStats)
+{
+    if (!DecompressClientPacket(connection, packet))
+        return false;
+
+    tickStats.AddPacket(static_cast<u16>(packet->header.opcode));
+    return ServiceLocator::GetClientMessageHandler()->CallHandler(connection.connection, packet);
+}
+
+void ConnectionUpdateSystem::Send(entt::registry& registry, entt::entity entity, std::shared_ptr<Bytebuffer>& buffer, PacketPriority priority)
+{
+    ConnectionComponent& connection = registry.get<ConnectionComponent>(entity);
+
+    // Checked before anything is compressed for it
+    if (IsDroppedForSlowConsumer(connection, priority))
+        return;
+
+    PacketCompression* compression = ServiceLocator::GetPacketCompression();
+    if (priority == PacketPriority::HIGH)
+    {
+        // Frames that can't be coalesced still have to go out behind the ones that already were
+        FlushCoalesced(registry, connection);
+        compression->Send(connection, buffer);
+        return;
+    }
+
+    // Compressed up front, the flush then sends the coalesced frames as they are
+    std::shared_ptr<Bytebuffer> compressedBuffer = connection.supportsCompression && compression->IsEnabled() ? compression->Compress(buffer) : nullptr;
+    Coalesce(registry, entity, connection, compressedBuffer ? compressedBuffer : buffer, priority);
+}
+
+void ConnectionUpdateSystem::Coalesce(entt::registry& registry, entt::entity entity, ConnectionComponent& connection, const std::shared_ptr<Bytebuffer>& buffer, PacketPriority priority)
+{
+    if (IsDroppedForSlowConsumer(connection, priority))
+        return;
+
+    // What can wait is coalesced for as long as possible while the client is slow
+    if (connection.slowSinceTick != 0)
+        priority = PacketPriority::LOW;
+
+    if (buffer->writtenData > NETWORK_BUFFER_SIZE)
+    {
+        FlushCoalesced(registry, connection);
+        ServiceLocator::GetPacketCompression()->SendPrepared(connection, buffer);
+        return;
+    }
+
+    if (connection.coalescedBuffer && connection.coalescedBuffer->size - connection.coalescedBuffer->writtenData < buffer->writtenData)
+        FlushCoalesced(registry, connection);
+
+    if (!connection.coalescedBuffer)
+        connection.coalescedBuffer = Bytebuffer::Borrow<NETWORK_BUFFER_SIZE>();
+
+    // Only read from, the buffer may be shared with other connections
+    connection.coalescedBuffer->PutBytes(buffer->GetDataPointer(), buffer->writtenData);
+
+    // A frame with a shorter window pulls the flush of everything coalesced before it forward
+    TimerSingleton& timerSingleton = registry.ctx<TimerSingleton>();
+    f32 window = priority == PacketPriority::MEDIUM ? MEDIUM_PRIORITY_TIME : LOW_PRIORITY_TIME;
+    u64 flushTick = timerSingleton.wheel.GetTick() + timerSingleton.ToTicks(window);
+
+    if (connection.flushTimer == 0 || timerSingleton.wheel.GetExpireTick(connection.flushTimer) > flushTick)
+    {
+        timerSingleton.Cancel(connection.flushTimer);
+        connection.flushTimer = timerSingleton.Schedule(window, TimerType::FLUSH, entity);
+    }
+}
+
+void ConnectionUpdateSystem::FlushCoalesced(entt::registry& registry, ConnectionComponent& connection)
+{
+    registry.ctx<TimerSingleton>().Cancel(connection.flushTimer);
+
+    if (!connection.coalescedBuffer)
+        return;
+
+    ServiceLocator::GetPacketCompression()->SendPrepared(connection, connection.coalescedBuffer);
+    connection.coalescedBuffer.reset();
 }
 
 void ConnectionUpdateSystem::Server_HandleConnect(NetworkServer* server, asio::ip::tcp::socket* socket, const asio::error_code& error)
@@ -57,7 +363,7 @@ void ConnectionUpdateSystem::Server_HandleConnect(NetworkServer* server, asio::i
     if (!error)
     {
 #ifdef NC_Debug
-        DebugHandler::PrintSuccess("[Network/Socket]: Client connected from (%s)", socket->remote_endpoint().address().to_string().c_str());
+        ServiceLocator::GetEngineLoop()->PrintMessage("[Network/Socket]: Client connected from (%s)", socket->remote_endpoint().address().to_string().c_str());
 #endif // NC_Debug
 
         socket->non_blocking(true);
@@ -67,6 +373,14 @@ void ConnectionUpdateSystem::Server_HandleConnect(NetworkServer* server, asio::i
 
         entt::registry* registry = ServiceLocator::GetRegistry();
         auto& connectionDeferredSingleton = registry->ctx<ConnectionDeferredSingleton>();
+
+#ifdef SO_BUSY_POLL
+        if (connectionDeferredSingleton.busyPollMicroseconds > 0)
+        {
+            i32 busyPoll = static_cast<i32>(connectionDeferredSingleton.busyPollMicroseconds);
+            setsockopt(socket->native_handle(), SOL_SOCKET, SO_BUSY_POLL, &busyPoll, sizeof(busyPoll));
+        }
+#endif // SO_BUSY_POLL
         connectionDeferredSingleton.newConnectionQueue.enqueue(socket);
     }
 }
@@ -74,58 +388,32 @@ void ConnectionUpdateSystem::Server_HandleConnect(NetworkServer* server, asio::i
 void ConnectionUpdateSystem::Client_HandleRead(BaseSocket* socket)
 {
     NetworkClient* client = static_cast<NetworkClient*>(socket);
-
     std::shared_ptr<Bytebuffer> buffer = client->GetReceiveBuffer();
-    entt::registry* registry = ServiceLocator::GetRegistry();
-
-    entt::entity entity = static_cast<entt::entity>(client->GetEntityId());
-    ConnectionComponent& connectionComponent = registry->get<ConnectionComponent>(entity);
 
-    while (buffer->GetActiveSize())
+    // While the network is impaired the simulator decides when, and in which pieces, the bytes reach the framer
+    if (NetworkSimulator* networkSimulator = ServiceLocator::GetNetworkSimulator())
     {
-        Opcode opcode = Opcode::INVALID;
-        u16 size = 0;
-
-        buffer->Get(opcode);
-        buffer->GetU16(size);
+        networkSimulator->ReceiveFromClient(client->GetEntityId(), buffer->GetReadPointer(), buffer->GetActiveSize());
+    }
+    else
+    {
+        entt::registry* registry = ServiceLocator::GetRegistry();
+        ConnectionComponent& connectionComponent = registry->get<ConnectionComponent>(static_cast<entt::entity>(client->GetEntityId()));
 
-        if (size > NETWORK_BUFFER_SIZE)
+        if (!PacketFramer::Receive(connectionComponent.packetQueue, connectionComponent.partialFrame, client->GetEntityId(), buffer->GetReadPointer(), buffer->GetActiveSize()))
         {
             client->Close(asio::error::shut_down);
             return;
         }
-
-        std::shared_ptr<NetworkPacket> packet = NetworkPacket::Borrow();
-        {
-            // Header
-            {
-                packet->header.opcode = opcode;
-                packet->header.size = size;
-            }
-
-            // Payload
-            {
-                if (size)
-                {
-                    packet->payload = Bytebuffer::Borrow<NETWORK_BUFFER_SIZE>();
-                    packet->payload->size = size;
-                    packet->payload->writtenData = size;
-                    std::memcpy(packet->payload->GetDataPointer(), buffer->GetReadPointer(), size);
-                }
-            }
-
-            connectionComponent.packetQueue.enqueue(packet);
-        }
-
-        buffer->readData += size;
     }
 
+    buffer->readData = buffer->writtenData;
     client->Listen();
 }
 void ConnectionUpdateSystem::Client_HandleDisconnect(BaseSocket* socket)
 {
 #ifdef NC_Debug
-    DebugHandler::PrintWarning("[Network/Socket]: Client disconnected from (%s)", socket->socket()->remote_endpoint().address().to_string().c_str());
+    ServiceLocator::GetEngineLoop()->PrintMessage("[Network/Socket]: Client disconnected from (%s)", socket->socket()->remote_endpoint().address().to_string().c_str());
 #endif // NC_Debug
 
     entt::registry* registry = ServiceLocator::GetRegistry();
@@ -139,98 +427,48 @@ void ConnectionUpdateSystem::Self_HandleConnect(BaseSocket* socket, bool connect
     if (connected)
     {
 #ifdef NC_Debug
-        DebugHandler::PrintSuccess("[Network/Socket]: Successfully connected to (%s, %u)", socket->socket()->remote_endpoint().address().to_string().c_str(), socket->socket()->remote_endpoint().port());
+        ServiceLocator::GetEngineLoop()->PrintMessage("[Network/Socket]: Successfully connected to (%s, %u)", socket->socket()->remote_endpoint().address().to_string().c_str(), socket->socket()->remote_endpoint().port());
 #endif // NC_Debug
 
+        // Generating A is too slow for the IO thread, the tick sends the challenge and starts reading once a worker did it
         entt::registry* registry = ServiceLocator::GetRegistry();
-        AuthenticationSingleton& authentication = registry->ctx<AuthenticationSingleton>();
-
-        /* Send Initial Packet */
-        std::shared_ptr<Bytebuffer> buffer = Bytebuffer::Borrow<512>();
-
-        authentication.srp.username = "region";
-        authentication.srp.password = "password";
-
-        // If StartAuthentication fails, it means A failed to generate and thus we cannot connect
-        if (!authentication.srp.StartAuthentication())
-            return;
-
-        buffer->Put(Opcode::CMSG_LOGON_CHALLENGE);
-        buffer->SkipWrite(sizeof(u16));
-
-        u16 size = static_cast<u16>(buffer->writtenData);
-        buffer->PutString(authentication.srp.username);
-        buffer->PutBytes(authentication.srp.aBuffer->GetDataPointer(), authentication.srp.aBuffer->size);
-
-        u16 writtenData = static_cast<u16>(buffer->writtenData) - size;
-
-        buffer->Put<u16>(writtenData, 2);
-        socket->Send(buffer);
-
-        NetworkClient* networkClient = static_cast<NetworkClient*>(socket);
-        networkClient->SetStatus(ConnectionStatus::AUTH_CHALLENGE);
-        socket->AsyncRead();
+        InternalSocket::AuthHandlers::StartAuthentication(registry->ctx<ConnectionSingleton>().networkClient);
     }
     else
     {
 #ifdef NC_Debug
-        DebugHandler::PrintWarning("[Network/Socket]: Failed connecting to (%s, %u)", socket->socket()->remote_endpoint().address().to_string().c_str(), socket->socket()->remote_endpoint().port());
+        ServiceLocator::GetEngineLoop()->PrintMessage("[Network/Socket]: Failed connecting to (%s, %u)", socket->socket()->remote_endpoint().address().to_string().c_str(), socket->socket()->remote_endpoint().port());
 #endif // NC_Debug
     }
 }
 void ConnectionUpdateSystem::Self_HandleRead(BaseSocket* socket)
 {
-    entt::registry* registry = ServiceLocator::GetRegistry();
-    ConnectionSingleton& connectionSingleton = registry->ctx<ConnectionSingleton>();
-
     NetworkClient* client = static_cast<NetworkClient*>(socket);
     std::shared_ptr<Bytebuffer> buffer = client->GetReceiveBuffer();
 
-    while (buffer->GetActiveSize())
+    if (NetworkSimulator* networkSimulator = ServiceLocator::GetNetworkSimulator())
     {
-        Opcode opcode = Opcode::INVALID;
-        u16 size = 0;
-
-        buffer->Get(opcode);
-        buffer->GetU16(size);
+        networkSimulator->ReceiveFromUpstream(buffer->GetReadPointer(), buffer->GetActiveSize());
+    }
+    else
+    {
+        entt::registry* registry = ServiceLocator::GetRegistry();
+        ConnectionSingleton& connectionSingleton = registry->ctx<ConnectionSingleton>();
 
-        if (size > NETWORK_BUFFER_SIZE)
+        if (!PacketFramer::Receive(connectionSingleton.packetQueue, connectionSingleton.partialFrame, PacketRecorder::UPSTREAM_CONNECTION_ID, buffer->GetReadPointer(), buffer->GetActiveSize()))
         {
             client->Close(asio::error::shut_down);
             return;
         }
-
-        std::shared_ptr<NetworkPacket> packet = NetworkPacket::Borrow();
-        {
-            // Header
-            {
-                packet->header.opcode = opcode;
-                packet->header.size = size;
-            }
-
-            // Payload
-            {
-                if (size)
-                {
-                    packet->payload = Bytebuffer::Borrow<NETWORK_BUFFER_SIZE>();
-                    packet->payload->size = size;
-                    packet->payload->writtenData = size;
-                    std::memcpy(packet->payload->GetDataPointer(), buffer->GetReadPointer(), size);
-                }
-            }
-
-            connectionSingleton.packetQueue.enqueue(packet);
-        }
-
-        buffer->readData += size;
     }
 
+    buffer->readData = buffer->writtenData;
     client->Listen();
 }
 void ConnectionUpdateSystem::Self_HandleDisconnect(BaseSocket* socket)
 {
 #ifdef NC_Debug
-    DebugHandler::PrintWarning("[Network/Socket]: Disconnected from (%s, %u)", socket->socket()->remote_endpoint().address().to_string().c_str(), socket->socket()->remote_endpoint().port());
+    ServiceLocator::GetEngineLoop()->PrintMessage("[Network/Socket]: Disconnected from (%s, %u)", socket->socket()->remote_endpoint().address().to_string().c_str(), socket->socket()->remote_endpoint().port());
 #endif // NC_Debug
 }
 
@@ -238,30 +476,114 @@ void ConnectionDeferredSystem::Update(entt::registry& registry)
 {
     ConnectionDeferredSingleton& connectionDeferredSingleton = registry.ctx<ConnectionDeferredSingleton>();
 
-    if (connectionDeferredSingleton.newConnectionQueue.size_approx() > 0)
+    size_t newConnectionQueueDepth = connectionDeferredSingleton.newConnectionQueue.size_approx();
+    registry.ctx<TickStatsSingleton>().newConnectionQueueDepth = static_cast<u32>(newConnectionQueueDepth);
+
+    if (newConnectionQueueDepth > 0)
     {
-        asio::ip::tcp::socket* socket;
-        while (connectionDeferredSingleton.newConnectionQueue.try_dequeue(socket))
+        static std::atomic<i64>& deferredAcceptsMetric = Metrics::Get("governor.deferredAcceptTicks");
+        static std::atomic<i64>& recycledAcceptsMetric = Metrics::Get("network.recycledAccepts");
+        GovernorSingleton& governor = registry.ctx<GovernorSingleton>();
+        TimerSingleton& timerSingleton = registry.ctx<TimerSingleton>();
+        u64 tick = timerSingleton.wheel.GetTick();
+
+        // Under load admission is capped, sockets past the budget stay queued until the next tick
+        size_t acceptCount = std::min(static_cast<size_t>(governor.acceptBudget), newConnectionQueueDepth);
+
+        std::vector<asio::ip::tcp::socket*>& sockets = connectionDeferredSingleton.acceptedSockets;
+        sockets.resize(acceptCount);
+        sockets.resize(connectionDeferredSingleton.newConnectionQueue.try_dequeue_bulk(sockets.begin(), acceptCount));
+
+        std::vector<entt::entity>& entities = connectionDeferredSingleton.acceptedEntities;
+        entities.resize(sockets.size());
+        registry.create(entities.begin(), entities.end());
+
+        std::vector<ConnectionComponent>& recycledConnections = connectionDeferredSingleton.recycledConnections;
+        i64 recycledCount = 0;
+
+        for (size_t i = 0; i < sockets.size(); i++)
         {
-            entt::entity entity = registry.create();
+            entt::entity entity = entities[i];
 
-            ConnectionComponent& connectionComponent = registry.emplace<ConnectionComponent>(entity);
-            connectionComponent.connection = std::make_shared<NetworkClient>(socket, entt::to_integral(entity));
+            // A recycled component comes with its packet queue already allocated
+            ConnectionComponent* connectionComponent = nullptr;
+            if (recycledConnections.empty())
+            {
+                connectionComponent = &registry.emplace<ConnectionComponent>(entity);
+            }
+            else
+            {
+                connectionComponent = &registry.emplace<ConnectionComponent>(entity, std::move(recycledConnections.back()));
+                recycledConnections.pop_back();
+                recycledCount++;
+            }
 
-            connectionComponent.connection->SetReadHandler(std::bind(&ConnectionUpdateSystem::Client_HandleRead, std::placeholders::_1));
-            connectionComponent.connection->SetDisconnectHandler(std::bind(&ConnectionUpdateSystem::Client_HandleDisconnect, std::placeholders::_1));
-            connectionComponent.connection->Listen();
+            connectionComponent->connection = std::allocate_shared<NetworkClient>(PoolAllocator<NetworkClient>(), sockets[i], entt::to_integral(entity));
+            connectionComponent->connection->SetReadHandler(&ConnectionUpdateSystem::Client_HandleRead);
+            connectionComponent->connection->SetDisconnectHandler(&ConnectionUpdateSystem::Client_HandleDisconnect);
 
-            connectionDeferredSingleton.networkServer->AddConnection(connectionComponent.connection);
+            if (connectionDeferredSingleton.ioUringBackend)
+            {
+                connectionDeferredSingleton.ioUringBackend->AddConnection(connectionComponent->connection, entt::to_integral(entity));
+            }
+            else
+            {
+                connectionComponent->connection->Listen();
+                connectionDeferredSingleton.networkServer->AddConnection(connectionComponent->connection);
+            }
+
+            connectionComponent->lastActivityTick = tick;
+            if (connectionDeferredSingleton.handshakeTimeout > 0.0f)
+                connectionComponent->handshakeTimer = timerSingleton.Schedule(connectionDeferredSingleton.handshakeTimeout, TimerType::HANDSHAKE, entity);
+            if (connectionDeferredSingleton.idleTimeout > 0.0f)
+                connectionComponent->idleTimer = timerSingleton.Schedule(connectionDeferredSingleton.idleTimeout, TimerType::IDLE, entity);
         }
+
+        recycledAcceptsMetric.fetch_add(recycledCount, std::memory_order_relaxed);
+
+        if (acceptCount == governor.acceptBudget)
+            deferredAcceptsMetric.fetch_add(1, std::memory_order_relaxed);
     }
 
-    if (connectionDeferredSingleton.droppedConnectionQueue.size_approx() > 0)
+    size_t droppedConnectionQueueDepth = connectionDeferredSingleton.droppedConnectionQueue.size_approx();
+    if (droppedConnectionQueueDepth > 0)
     {
-        entt::entity entity;
-        while (connectionDeferredSingleton.droppedConnectionQueue.try_dequeue(entity))
+        TimerSingleton& timerSingleton = registry.ctx<TimerSingleton>();
+        UdpSingleton& udpSingleton = registry.ctx<UdpSingleton>();
+
+        std::vector<entt::entity>& entities = connectionDeferredSingleton.droppedEntities;
+        entities.resize(droppedConnectionQueueDepth);
+        entities.resize(connectionDeferredSingleton.droppedConnectionQueue.try_dequeue_bulk(entities.begin(), droppedConnectionQueueDepth));
+
+        std::vector<ConnectionComponent>& recycledConnections = connectionDeferredSingleton.recycledConnections;
+
+        // A connection can be reported twice, the first report resets it and the second only finds an empty component
+        size_t destroyCount = 0;
+        for (entt::entity entity : entities)
         {
-            registry.destroy(entity);
+            ConnectionComponent* connection = registry.valid(entity) ? registry.try_get<ConnectionComponent>(entity) : nullptr;
+            if (!connection || !connection->connection)
+                continue;
+
+            // Timers are keyed by entity, a recycled entity must not inherit them
+            timerSingleton.Cancel(connection->handshakeTimer);
+            timerSingleton.Cancel(connection->idleTimer);
+            timerSingleton.Cancel(connection->upstreamRequestTimer);
+            timerSingleton.Cancel(connection->flushTimer);
+
+            if (UdpComponent* udp = registry.try_get<UdpComponent>(entity))
+                udpSingleton.tokens.erase(udp->token);
+
+            if (connectionDeferredSingleton.ioUringBackend)
+                connectionDeferredSingleton.ioUringBackend->RemoveConnection(entt::to_integral(entity));
+
+            connection->Reset();
+            if (recycledConnections.size() < RECYCLED_CONNECTION_CAPACITY)
+                recycledConnections.push_back(std::move(*connection));
+
+            entities[destroyCount++] = entity;
         }
+
+        registry.destroy(entities.begin(), entities.begin() + destroyCount);
     }
-}
\ No newline at end of file
+}
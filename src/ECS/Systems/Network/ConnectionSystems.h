@@ -4,7 +4,12 @@
 #include <Utils/ConcurrentQueue.h>
 
 class NetworkServer;
+struct NetworkPacket;
 class BaseSocket;
+struct ConnectionComponent;
+struct TickStatsSingleton;
+class Bytebuffer;
+enum class PacketPriority;
 namespace moddycamel
 {
     class ConcurrentQueue;
@@ -14,6 +19,24 @@ class ConnectionUpdateSystem
 public:
     static void Update(entt::registry& registry);
 
+    // Applies finished authentication steps and dispatches the upstream link's packets, false if the link had to be closed.
+    // Also pumped on its own while the region starts up, before the tick loop runs
+    static bool UpdateUpstream(entt::registry& registry);
+
+    // Decompresses a compressed packet from a client in place, false if it is malformed. Packets that aren't compressed are left alone
+    static bool DecompressClientPacket(ConnectionComponent& connection, std::shared_ptr<NetworkPacket>& packet);
+
+    // Decompresses and dispatches a packet from a client, false if the connection should be closed
+    static bool DispatchClientPacket(ConnectionComponent& connection, std::shared_ptr<NetworkPacket>& packet, TickStatsSingleton& tickStats);
+
+    // HIGH priority frames go out right away, MEDIUM and LOW ones are coalesced and sent together within MEDIUM_PRIORITY_TIME or LOW_PRIORITY_TIME.
+    // A slow consumer has its MEDIUM frames coalesced as long as LOW ones and its LOW frames dropped. Every send to a client goes through here
+    static void Send(entt::registry& registry, entt::entity entity, std::shared_ptr<Bytebuffer>& buffer, PacketPriority priority);
+
+    // Appends a buffer that is already compressed, or deliberately left uncompressed, to the connection's coalesced frames without touching it
+    static void Coalesce(entt::registry& registry, entt::entity entity, ConnectionComponent& connection, const std::shared_ptr<Bytebuffer>& buffer, PacketPriority priority);
+    static void FlushCoalesced(entt::registry& registry, ConnectionComponent& connection);
+
     // Handlers for Network Server
     static void Server_HandleConnect(NetworkServer* server, asio::ip::tcp::socket* socket, const asio::error_code& error);
 
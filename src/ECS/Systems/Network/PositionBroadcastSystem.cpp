@@ -0,0 +1,86 @@
+#include "PositionBroadcastSystem.h"
+#include <cstring>
+#include <entt.hpp>
+#include <tracy/Tracy.hpp>
+#include "../../Components/Movement/PositionComponent.h"
+#include "../../Components/Network/ConnectionComponent.h"
+#include "../../Components/Network/ConnectionDeferredSingleton.h"
+#include "../../Components/Network/HandoffComponent.h"
+#include "../../Components/Singletons/TimerSingleton.h"
+#include "../../../Network/Broadcast/PacketBroadcast.h"
+#include "../../../Network/RegionOpcodes.h"
+
+constexpr size_t POSITION_HEADER_SIZE = sizeof(u16) + sizeof(u16) + sizeof(u16);
+constexpr size_t POSITION_ENTRY_SIZE = sizeof(u32) + sizeof(PositionComponent);
+
+// Every frame fits into a connection's coalesced frames on its own
+constexpr size_t POSITIONS_PER_FRAME = (NETWORK_BUFFER_SIZE - POSITION_HEADER_SIZE) / POSITION_ENTRY_SIZE;
+
+static std::shared_ptr<Bytebuffer> BeginFrame()
+{
+    std::shared_ptr<Bytebuffer> buffer = Bytebuffer::Borrow<NETWORK_BUFFER_SIZE>();
+    buffer->Put(ToOpcode(RegionOpcode::SMSG_ENTITY_POSITIONS));
+    buffer->PutU16(0);
+    buffer->PutU16(0);
+    return buffer;
+}
+
+// The size and count are only known once the frame is full, or the entities ran out
+static void BroadcastFrame(entt::registry& registry, std::shared_ptr<Bytebuffer>& buffer, u16 count)
+{
+    u16 payloadSize = static_cast<u16>(buffer->writtenData - sizeof(u16) - sizeof(u16));
+    std::memcpy(buffer->GetDataPointer() + sizeof(u16), &payloadSize, sizeof(u16));
+    std::memcpy(buffer->GetDataPointer() + sizeof(u16) + sizeof(u16), &count, sizeof(u16));
+
+    // Clients being handed off are about to move on, evicted ones are about to be dropped
+    PacketBroadcast broadcast(std::move(buffer), PacketPriority::MEDIUM);
+    broadcast.SendToAll(registry, [&registry](const auto entity, ConnectionComponent& connection)
+    {
+        return !connection.isEvicted && !registry.try_get<HandoffComponent>(entity);
+    });
+}
+
+void PositionBroadcastSystem::Update(entt::registry& registry)
+{
+    ConnectionDeferredSingleton& connectionDeferredSingleton = registry.ctx<ConnectionDeferredSingleton>();
+    if (connectionDeferredSingleton.positionInterval <= 0.0f)
+        return;
+
+    // Kept in wheel ticks, like every other interval on the tick
+    TimerSingleton& timerSingleton = registry.ctx<TimerSingleton>();
+    u64 tick = timerSingleton.wheel.GetTick();
+    if (tick < connectionDeferredSingleton.nextPositionTick)
+        return;
+
+    connectionDeferredSingleton.nextPositionTick = tick + timerSingleton.ToTicks(connectionDeferredSingleton.positionInterval);
+
+    if (registry.view<ConnectionComponent>().empty())
+        return;
+
+    // Entities being handed off are frozen and about to leave, the new region sends them from now on
+    auto view = registry.view<PositionComponent>(entt::exclude<HandoffComponent>);
+
+    std::shared_ptr<Bytebuffer> buffer;
+    u16 count = 0;
+
+    view.each([&registry, &buffer, &count](const auto entity, const PositionComponent& position)
+    {
+        if (!buffer)
+            buffer = BeginFrame();
+
+        buffer->Put(entt::to_integral(entity));
+        buffer->Put(position.x);
+        buffer->Put(position.y);
+        buffer->Put(position.z);
+
+        if (++count == POSITIONS_PER_FRAME)
+        {
+            BroadcastFrame(registry, buffer, count);
+            buffer.reset();
+            count = 0;
+        }
+    });
+
+    if (buffer)
+        BroadcastFrame(registry, buffer, count);
+}
@@ -0,0 +1,9 @@
+#pragma once
+#include <entity/fwd.hpp>
+
+class PositionBroadcastSystem
+{
+public:
+    // Serializes every entity's position once per interval and broadcasts the frames to every client at MEDIUM priority
+    static void Update(entt::registry& registry);
+};
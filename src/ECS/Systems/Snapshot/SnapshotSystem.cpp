@@ -0,0 +1,23 @@
+#include "SnapshotSystem.h"
+#include <entt.hpp>
+#include <tracy/Tracy.hpp>
+#include "../../Components/Singletons/TimeSingleton.h"
+#include "../../Components/Singletons/SnapshotSingleton.h"
+#include "../../../Snapshot/SnapshotWriter.h"
+
+void SnapshotSystem::Update(entt::registry& registry)
+{
+    SnapshotSingleton& snapshotSingleton = registry.ctx<SnapshotSingleton>();
+    if (!snapshotSingleton.writer)
+        return;
+
+    // Compare against the lifetime rather than accumulating deltaTime, the governor may skip our ticks
+    TimeSingleton& timeSingleton = registry.ctx<TimeSingleton>();
+    if (timeSingleton.lifeTimeInS - snapshotSingleton.lastSnapshotTime < snapshotSingleton.interval)
+        return;
+
+    // If the writer is still busy we try again next tick
+    ZoneScopedNC("SnapshotSystem::Capture", tracy::Color::Blue2)
+    if (snapshotSingleton.writer->Submit(snapshotSingleton.registries, timeSingleton.tick))
+        snapshotSingleton.lastSnapshotTime = timeSingleton.lifeTimeInS;
+}
@@ -0,0 +1,9 @@
+#pragma once
+#include <entity/fwd.hpp>
+
+class SnapshotSystem
+{
+public:
+    // Checkpoints every zone, so it runs once all of their graphs finished the tick
+    static void Update(entt::registry& registry);
+};
@@ -0,0 +1,96 @@
+#include "TimerSystem.h"
+#include <entt.hpp>
+#include <tracy/Tracy.hpp>
+#include <Networking/NetworkClient.h>
+#include <Networking/PacketUtils.h>
+#include "../Network/ConnectionSystems.h"
+#include "../../Components/Network/ConnectionComponent.h"
+#include "../../Components/Network/ConnectionDeferredSingleton.h"
+#include "../../Components/Singletons/TimeSingleton.h"
+#include "../../Components/Singletons/TimerSingleton.h"
+#include "../../../Utils/Metrics.h"
+
+static void HandleIdle(entt::registry& registry, TimerSingleton& timerSingleton, TimerEvent& event, ConnectionComponent& connection)
+{
+    static std::atomic<i64>& idleMetric = Metrics::Get("timers.idleDisconnects");
+    connection.idleTimer = 0;
+
+    // Activity does not touch the timer, it is only pushed back here once it fires early
+    u64 idleTicks = timerSingleton.ToTicks(registry.ctx<ConnectionDeferredSingleton>().idleTimeout);
+    u64 idleUntil = connection.lastActivityTick + idleTicks;
+    u64 tick = timerSingleton.wheel.GetTick();
+
+    if (idleUntil > tick)
+    {
+        connection.idleTimer = timerSingleton.wheel.Schedule(idleUntil - tick, event.type, event.id);
+        return;
+    }
+
+    idleMetric.fetch_add(1, std::memory_order_relaxed);
+    connection.connection->Close(asio::error::timed_out);
+}
+
+static void HandleUpstreamRequest(entt::registry& registry, entt::entity entity, ConnectionComponent& connection)
+{
+    static std::atomic<i64>& upstreamMetric = Metrics::Get("timers.upstreamTimeouts");
+    connection.upstreamRequestTimer = 0;
+    upstreamMetric.fetch_add(1, std::memory_order_relaxed);
+
+    // The Novus Service never answered, a failed status lets the client retry instead of waiting forever
+    std::shared_ptr<Bytebuffer> buffer = Bytebuffer::Borrow<128>();
+    if (PacketUtils::Write_SMSG_SEND_ADDRESS(buffer, 0, 0, 0))
+        ConnectionUpdateSystem::Send(registry, entity, buffer, PacketPriority::HIGH);
+}
+
+void TimerSystem::Update(entt::registry& registry)
+{
+    TimerSingleton& timerSingleton = registry.ctx<TimerSingleton>();
+    timerSingleton.expired.clear();
+    timerSingleton.wheel.Advance(TimerSingleton::ToWheelTick(registry.ctx<TimeSingleton>().lifeTimeInS), timerSingleton.expired);
+
+    if (timerSingleton.expired.empty())
+        return;
+
+    ZoneScopedNC("TimerSystem::Update", tracy::Color::Blue2)
+    static std::atomic<i64>& handshakeMetric = Metrics::Get("timers.handshakeTimeouts");
+    static std::atomic<i64>& expiredMetric = Metrics::Get("timers.expired");
+    expiredMetric.fetch_add(static_cast<i64>(timerSingleton.expired.size()), std::memory_order_relaxed);
+
+    for (TimerEvent& event : timerSingleton.expired)
+    {
+        entt::entity entity = static_cast<entt::entity>(event.id);
+        if (!registry.valid(entity))
+            continue;
+
+        ConnectionComponent* connection = registry.try_get<ConnectionComponent>(entity);
+        if (!connection)
+            continue;
+
+        switch (static_cast<TimerType>(event.type))
+        {
+            case TimerType::HANDSHAKE:
+                if (connection->handshakeTimer == event.handle)
+                {
+                    connection->handshakeTimer = 0;
+                    handshakeMetric.fetch_add(1, std::memory_order_relaxed);
+                    connection->connection->Close(asio::error::timed_out);
+                }
+                break;
+            case TimerType::IDLE:
+                if (connection->idleTimer == event.handle)
+                    HandleIdle(registry, timerSingleton, event, *connection);
+                break;
+            case TimerType::UPSTREAM_REQUEST:
+                if (connection->upstreamRequestTimer == event.handle)
+                    HandleUpstreamRequest(registry, entity, *connection);
+                break;
+            case TimerType::FLUSH:
+                if (connection->flushTimer == event.handle)
+                {
+                    connection->flushTimer = 0;
+                    ConnectionUpdateSystem::FlushCoalesced(registry, *connection);
+                }
+                break;
+        }
+    }
+}
@@ -0,0 +1,10 @@
+#pragma once
+#include <entity/fwd.hpp>
+
+// Advances the timer wheel to the current tick and dispatches every timer that expired as one batch,
+// ticks on which nothing expires cost a single slot lookup no matter how many timers are pending
+class TimerSystem
+{
+public:
+    static void Update(entt::registry& registry);
+};
@@ -0,0 +1,356 @@
+#include "UdpSystem.h"
+#include <random>
+#include <cstring>
+#include <algorithm>
+#include <entt.hpp>
+#include <tracy/Tracy.hpp>
+#include <Networking/NetworkClient.h>
+#include <Utils/ByteBuffer.h>
+#include "../Network/ConnectionSystems.h"
+#include "../../Components/Network/ConnectionComponent.h"
+#include "../../Components/Network/UdpComponent.h"
+#include "../../Components/Network/UdpSingleton.h"
+#include "../../Components/Singletons/TimeSingleton.h"
+#include "../../../Network/Udp/UdpTransport.h"
+#include "../../../Network/Framing/PacketFramer.h"
+#include "../../../Network/RegionOpcodes.h"
+#include "../../../Utils/Metrics.h"
+
+// Bounds for resending an unacked datagram, in between it follows twice the smoothed round trip time
+constexpr f32 UDP_MIN_RESEND_TIME = 0.03f;
+constexpr f32 UDP_MAX_RESEND_TIME = 1.0f;
+// A reliable datagram that was sent this often without an ack means the client is gone
+constexpr u8 UDP_MAX_SENDS = 10;
+constexpr size_t UDP_MAX_ACKS_PER_DATAGRAM = UDP_MAX_PAYLOAD_SIZE / sizeof(u16);
+
+static u64 GenerateToken()
+{
+    static std::mt19937_64 generator(std::random_device{}());
+
+    u64 token = 0;
+    while (token == 0)
+        token = generator();
+
+    return token;
+}
+
+static std::shared_ptr<Bytebuffer> BuildDatagram(u64 token, UdpDatagramType type, UdpChannel channel, u16 sequence)
+{
+    UdpHeader header;
+    header.token = token;
+    header.type = type;
+    header.channel = channel;
+    header.sequence = sequence;
+
+    std::shared_ptr<Bytebuffer> datagram = Bytebuffer::Borrow<UDP_MAX_DATAGRAM_SIZE>();
+    datagram->PutBytes(reinterpret_cast<u8*>(&header), sizeof(UdpHeader));
+    return datagram;
+}
+
+static bool IsReliable(UdpChannel channel)
+{
+    return channel != UdpChannel::UNRELIABLE_SEQUENCED;
+}
+
+// How far the oldest unacked datagram of the channel lies behind its next sequence
+static u16 GetSendWindowUsed(UdpComponent& udp, UdpChannel channel)
+{
+    u16 nextSequence = udp.channels[static_cast<size_t>(channel)].nextSendSequence;
+
+    u16 used = 0;
+    for (UdpSentDatagram& sent : udp.unacked)
+    {
+        if (sent.channel == channel)
+            used = std::max(used, static_cast<u16>(nextSequence - sent.sequence));
+    }
+
+    return used;
+}
+
+static void SendData(UdpTransport& transport, UdpComponent& udp, UdpChannel channel, std::shared_ptr<Bytebuffer>& buffer, f32 now)
+{
+    UdpChannelState& channelState = udp.channels[static_cast<size_t>(channel)];
+    u16 sequence = channelState.nextSendSequence++;
+
+    std::shared_ptr<Bytebuffer> datagram = BuildDatagram(udp.token, UdpDatagramType::DATA, channel, sequence);
+    datagram->PutBytes(buffer->GetDataPointer(), buffer->writtenData);
+
+    if (IsReliable(channel))
+        udp.unacked.push_back({ datagram, channel, sequence, 1, now });
+
+    transport.Send(udp.endpoint, datagram);
+}
+
+// Sends the channel's waiting frames for as long as its window has room
+static void SendWaiting(UdpTransport& transport, UdpComponent& udp, UdpChannel channel, f32 now)
+{
+    UdpChannelState& channelState = udp.channels[static_cast<size_t>(channel)];
+
+    size_t sentCount = 0;
+    while (sentCount < channelState.waiting.size() && GetSendWindowUsed(udp, channel) < UDP_RECEIVE_WINDOW)
+    {
+        SendData(transport, udp, channel, channelState.waiting[sentCount], now);
+        sentCount++;
+    }
+
+    channelState.waiting.erase(channelState.waiting.begin(), channelState.waiting.begin() + sentCount);
+}
+
+static void Open(entt::registry& registry, UdpSingleton& udpSingleton, entt::entity entity)
+{
+    if (!registry.valid(entity) || !registry.try_get<ConnectionComponent>(entity) || registry.try_get<UdpComponent>(entity))
+        return;
+
+    UdpComponent& udp = registry.emplace<UdpComponent>(entity);
+    udp.token = GenerateToken();
+    udpSingleton.tokens[udp.token] = entity;
+
+    std::shared_ptr<Bytebuffer> buffer = Bytebuffer::Borrow<128>();
+    buffer->Put(ToOpcode(RegionOpcode::SMSG_UDP_TOKEN));
+    buffer->PutU16(sizeof(u64) + sizeof(u16));
+    buffer->Put(udp.token);
+    buffer->PutU16(udpSingleton.transport->GetPort());
+
+    ConnectionUpdateSystem::Send(registry, entity, buffer, PacketPriority::HIGH);
+}
+
+// Frames a datagram's payload onto the connection's packet queue, false if it held anything but complete frames
+static bool Deliver(UdpSingleton& udpSingleton, ConnectionComponent& connection, const u8* payload, size_t size)
+{
+    bool isValid = PacketFramer::Receive(connection.packetQueue, udpSingleton.partialFrame, connection.connection->GetEntityId(), payload, size) && udpSingleton.partialFrame.empty();
+
+    udpSingleton.partialFrame.clear();
+    return isValid;
+}
+
+static bool HandleData(UdpSingleton& udpSingleton, ConnectionComponent& connection, UdpChannelState& channelState, UdpChannel channel, u16 sequence, const u8* payload, size_t size)
+{
+    static std::atomic<i64>& staleMetric = Metrics::Get("udp.staleDatagrams");
+
+    if (channel == UdpChannel::UNRELIABLE_SEQUENCED)
+    {
+        if (channelState.hasReceived && static_cast<i16>(sequence - channelState.receiveSequence) <= 0)
+        {
+            staleMetric.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        channelState.receiveSequence = sequence;
+        channelState.hasReceived = true;
+        return Deliver(udpSingleton, connection, payload, size);
+    }
+
+    // The sender never has more than the window in flight, anything further ahead is broken
+    u16 distance = sequence - channelState.receiveSequence;
+    if (distance >= UDP_RECEIVE_WINDOW && distance < 0x8000)
+        return false;
+
+    // Duplicates are acked again, the ack that made them unnecessary may have been lost
+    channelState.pendingAcks.push_back(sequence);
+
+    size_t slot = sequence % UDP_RECEIVE_WINDOW;
+    if (distance >= UDP_RECEIVE_WINDOW || channelState.received.test(slot))
+    {
+        staleMetric.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    channelState.received.set(slot);
+
+    if (channel == UdpChannel::RELIABLE_UNORDERED || distance == 0)
+    {
+        if (!Deliver(udpSingleton, connection, payload, size))
+            return false;
+    }
+    else
+    {
+        if (channelState.heldBack.empty())
+            channelState.heldBack.resize(UDP_RECEIVE_WINDOW);
+
+        std::shared_ptr<Bytebuffer> heldBack = Bytebuffer::Borrow<UDP_MAX_DATAGRAM_SIZE>();
+        std::memcpy(heldBack->GetDataPointer(), payload, size);
+        heldBack->writtenData = size;
+        channelState.heldBack[slot] = heldBack;
+        return true;
+    }
+
+    // Moves past everything that arrived in a row, ordered payloads held back for it are delivered on the way
+    while (channelState.received.test(channelState.receiveSequence % UDP_RECEIVE_WINDOW))
+    {
+        size_t receivedSlot = channelState.receiveSequence % UDP_RECEIVE_WINDOW;
+        channelState.received.reset(receivedSlot);
+        channelState.receiveSequence++;
+
+        if (channel != UdpChannel::RELIABLE_ORDERED || channelState.heldBack.empty() || !channelState.heldBack[receivedSlot])
+            continue;
+
+        std::shared_ptr<Bytebuffer> heldBack = std::move(channelState.heldBack[receivedSlot]);
+        if (!Deliver(udpSingleton, connection, heldBack->GetDataPointer(), heldBack->writtenData))
+            return false;
+    }
+
+    return true;
+}
+
+static void HandleAck(UdpTransport& transport, UdpComponent& udp, UdpChannel channel, const u8* payload, size_t size, f32 now)
+{
+    for (size_t offset = 0; offset + sizeof(u16) <= size; offset += sizeof(u16))
+    {
+        u16 sequence = 0;
+        std::memcpy(&sequence, payload + offset, sizeof(u16));
+
+        auto itr = std::find_if(udp.unacked.begin(), udp.unacked.end(), [channel, sequence](const UdpSentDatagram& sent) { return sent.channel == channel && sent.sequence == sequence; });
+        if (itr == udp.unacked.end())
+            continue;
+
+        // Only datagrams sent once tell how long the round trip took
+        if (itr->sendCount == 1)
+            udp.smoothedRtt += ((now - itr->sendTime) - udp.smoothedRtt) * 0.125f;
+
+        *itr = std::move(udp.unacked.back());
+        udp.unacked.pop_back();
+    }
+
+    SendWaiting(transport, udp, channel, now);
+}
+
+static void HandleDatagram(entt::registry& registry, UdpSingleton& udpSingleton, UdpDatagram& datagram, f32 now)
+{
+    static std::atomic<i64>& rejectedMetric = Metrics::Get("udp.rejectedDatagrams");
+
+    UdpHeader header;
+    std::memcpy(&header, datagram.data->GetDataPointer(), sizeof(UdpHeader));
+
+    auto itr = udpSingleton.tokens.find(header.token);
+    if (itr == udpSingleton.tokens.end() || header.channel >= UdpChannel::COUNT)
+    {
+        rejectedMetric.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Tokens are dropped together with their connection, so the entity is still there
+    ConnectionComponent& connection = registry.get<ConnectionComponent>(itr->second);
+    UdpComponent& udp = registry.get<UdpComponent>(itr->second);
+
+    const u8* payload = datagram.data->GetDataPointer() + sizeof(UdpHeader);
+    size_t payloadSize = datagram.data->writtenData - sizeof(UdpHeader);
+
+    // A bad datagram is dropped, anyone who saw the token could have sent it and the client's TCP connection is not theirs to close
+    if (header.type == UdpDatagramType::ACK)
+    {
+        if (payloadSize == 0 || payloadSize % sizeof(u16) != 0)
+        {
+            rejectedMetric.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        // The token identifies the client, a NAT may have moved it to another port since its last datagram
+        udp.endpoint = datagram.endpoint;
+        udp.isBound = true;
+
+        HandleAck(*udpSingleton.transport, udp, header.channel, payload, payloadSize, now);
+        return;
+    }
+
+    UdpChannelState& channelState = udp.channels[static_cast<size_t>(header.channel)];
+    if (header.type != UdpDatagramType::DATA || !HandleData(udpSingleton, connection, channelState, header.channel, header.sequence, payload, payloadSize))
+    {
+        rejectedMetric.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    udp.endpoint = datagram.endpoint;
+    udp.isBound = true;
+}
+
+void UdpSystem::Update(entt::registry& registry)
+{
+    UdpSingleton& udpSingleton = registry.ctx<UdpSingleton>();
+    if (!udpSingleton.transport)
+        return;
+
+    ZoneScopedNC("UdpSystem::Update", tracy::Color::Blue2)
+
+    static std::atomic<i64>& resendsMetric = Metrics::Get("udp.resends");
+    static std::atomic<i64>& ackDatagramsMetric = Metrics::Get("udp.ackDatagrams");
+
+    UdpTransport& transport = *udpSingleton.transport;
+    f32 now = registry.ctx<TimeSingleton>().lifeTimeInS;
+
+    for (entt::entity entity : udpSingleton.requests)
+    {
+        Open(registry, udpSingleton, entity);
+    }
+    udpSingleton.requests.clear();
+
+    UdpDatagram datagram;
+    while (transport.TryGetDatagram(datagram))
+    {
+        HandleDatagram(registry, udpSingleton, datagram, now);
+    }
+
+    auto view = registry.view<ConnectionComponent, UdpComponent>();
+    view.each([&transport, now](ConnectionComponent& connection, UdpComponent& udp)
+    {
+        if (!udp.isBound)
+            return;
+
+        for (size_t i = 0; i < udp.channels.size(); i++)
+        {
+            std::vector<u16>& pendingAcks = udp.channels[i].pendingAcks;
+
+            for (size_t offset = 0; offset < pendingAcks.size(); offset += UDP_MAX_ACKS_PER_DATAGRAM)
+            {
+                size_t ackCount = std::min(pendingAcks.size() - offset, UDP_MAX_ACKS_PER_DATAGRAM);
+
+                std::shared_ptr<Bytebuffer> datagram = BuildDatagram(udp.token, UdpDatagramType::ACK, static_cast<UdpChannel>(i), 0);
+                datagram->PutBytes(reinterpret_cast<u8*>(pendingAcks.data() + offset), ackCount * sizeof(u16));
+                transport.Send(udp.endpoint, datagram);
+
+                ackDatagramsMetric.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            pendingAcks.clear();
+        }
+
+        f32 resendTime = std::clamp(udp.smoothedRtt * 2.0f, UDP_MIN_RESEND_TIME, UDP_MAX_RESEND_TIME);
+        for (UdpSentDatagram& sent : udp.unacked)
+        {
+            if (now - sent.sendTime < resendTime)
+                continue;
+
+            if (sent.sendCount >= UDP_MAX_SENDS)
+            {
+                connection.connection->Close(asio::error::timed_out);
+                return;
+            }
+
+            transport.Send(udp.endpoint, sent.datagram);
+            sent.sendCount++;
+            sent.sendTime = now;
+
+            resendsMetric.fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+}
+
+void UdpSystem::Send(entt::registry& registry, entt::entity entity, std::shared_ptr<Bytebuffer>& buffer, UdpChannel channel)
+{
+    UdpTransport* transport = registry.ctx<UdpSingleton>().transport;
+    UdpComponent* udp = registry.try_get<UdpComponent>(entity);
+
+    if (!transport || !udp || !udp->isBound || buffer->writtenData > UDP_MAX_PAYLOAD_SIZE)
+    {
+        ConnectionUpdateSystem::Send(registry, entity, buffer, PacketPriority::HIGH);
+        return;
+    }
+
+    UdpChannelState& channelState = udp->channels[static_cast<size_t>(channel)];
+    if (IsReliable(channel) && (!channelState.waiting.empty() || GetSendWindowUsed(*udp, channel) >= UDP_RECEIVE_WINDOW))
+    {
+        channelState.waiting.push_back(buffer);
+        return;
+    }
+
+    SendData(*transport, *udp, channel, buffer, registry.ctx<TimeSingleton>().lifeTimeInS);
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <NovusTypes.h>
+#include <memory>
+#include <entity/fwd.hpp>
+
+class Bytebuffer;
+enum class UdpChannel : u8;
+
+// Runs a client's latency sensitive traffic over UDP next to its TCP connection, so a lost datagram only delays
+// the channel it was sent on. Inbound datagrams are framed onto the connection's packet queue and dispatched by
+// ConnectionUpdateSystem like any other packet. Acks for everything received are sent once per tick.
+class UdpSystem
+{
+public:
+    static void Update(entt::registry& registry);
+
+    // Falls back to TCP until the client bound its UDP endpoint, and for frames that don't fit a datagram
+    static void Send(entt::registry& registry, entt::entity entity, std::shared_ptr<Bytebuffer>& buffer, UdpChannel channel);
+};
@@ -0,0 +1,53 @@
+#include "ZoneMessageSystem.h"
+#include <entt.hpp>
+#include <tracy/Tracy.hpp>
+#include "../../Components/Singletons/ZoneSingleton.h"
+#include "../../Components/Network/ConnectionComponent.h"
+#include "../../../Snapshot/EntityBlob.h"
+#include "../../../Utils/Metrics.h"
+
+void ZoneMessageSystem::Update(entt::registry& registry)
+{
+    ZoneSingleton& zoneSingleton = registry.ctx<ZoneSingleton>();
+    if (!zoneSingleton.router)
+        return;
+
+    ZoneScopedNC("ZoneMessageSystem::Update", tracy::Color::Blue2)
+    static std::atomic<i64>& transfersMetric = Metrics::Get("zone.transfers");
+
+    ZoneMessage message;
+    while (zoneSingleton.router->TryReceive(zoneSingleton.zoneId, message))
+    {
+        if (message.type != ZoneMessageType::TRANSFER_ENTITY)
+            continue;
+
+        entt::entity entity = registry.create();
+
+        const u8* data = message.payload.data();
+        if (!EntityBlob::Read(registry, entity, data, data + message.payload.size()))
+        {
+            registry.destroy(entity);
+            continue;
+        }
+
+        transfersMetric.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool ZoneMessageSystem::TransferEntity(entt::registry& registry, entt::entity entity, u32 toZoneId)
+{
+    ZoneSingleton& zoneSingleton = registry.ctx<ZoneSingleton>();
+    if (!zoneSingleton.router || toZoneId == zoneSingleton.zoneId || registry.try_get<ConnectionComponent>(entity))
+        return false;
+
+    ZoneMessage message;
+    message.fromZoneId = zoneSingleton.zoneId;
+    message.type = ZoneMessageType::TRANSFER_ENTITY;
+    EntityBlob::Write(registry, entity, message.payload);
+
+    if (!zoneSingleton.router->Send(toZoneId, std::move(message)))
+        return false;
+
+    registry.destroy(entity);
+    return true;
+}
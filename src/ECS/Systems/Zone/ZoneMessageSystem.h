@@ -0,0 +1,13 @@
+#pragma once
+#include <NovusTypes.h>
+#include <entity/fwd.hpp>
+
+class ZoneMessageSystem
+{
+public:
+    static void Update(entt::registry& registry);
+
+    // Moves the entity's state to another zone and destroys it here, the entity is recreated there on its next tick.
+    // Connections are owned by the primary zone and can't be transferred
+    static bool TransferEntity(entt::registry& registry, entt::entity entity, u32 toZoneId);
+};
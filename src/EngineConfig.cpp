@@ -0,0 +1,263 @@
+#include "EngineConfig.h"
+#include <cstring>
+#include <cstdlib>
+#include <Utils/DebugHandler.h>
+
+static void PrintUsage()
+{
+    DebugHandler::Print("Usage: novus-region [options]");
+    DebugHandler::Print("    --port <port>       Client port, defaults to 3724");
+    DebugHandler::Print("    --udp-port <port>   Offer clients a UDP channel on <port> for latency sensitive traffic");
+    DebugHandler::Print("    --io-uring          Use the io_uring network backend (Linux)");
+    DebugHandler::Print("    --pin-io <cpu>      Pin the IO thread");
+    DebugHandler::Print("    --pin-tick <cpu>    Pin the tick thread, it then spins instead of sleeping between ticks");
+    DebugHandler::Print("    --pin-workers <cpus> Pin taskflow workers, e.g. 4-7 or 4,6");
+    DebugHandler::Print("    --workers <count>   Number of taskflow workers");
+    DebugHandler::Print("    --numa-node <node>  Allocate from and default the pinned CPUs to this NUMA node");
+    DebugHandler::Print("    --busy-poll <us>    SO_BUSY_POLL budget for client sockets (Linux)");
+    DebugHandler::Print("    --handshake-timeout <seconds> Close connections that sent nothing valid by then, 0 disables");
+    DebugHandler::Print("    --idle-timeout <seconds> Close connections that went quiet, 0 disables");
+    DebugHandler::Print("    --upstream-timeout <seconds> Fail client requests the Novus Service did not answer, 0 disables");
+    DebugHandler::Print("    --upstream-wait <seconds> Longest startup waits for the Novus Service before accepting clients, 0 waits forever");
+    DebugHandler::Print("    --outbound-soft-cap <bytes> Unacknowledged bytes past which a client only gets what it can't do without, 0 disables");
+    DebugHandler::Print("    --outbound-hard-cap <bytes> Unacknowledged bytes past which a client is evicted, 0 disables");
+    DebugHandler::Print("    --outbound-max-age <seconds> Evict clients that stay over the soft cap this long, 0 disables");
+    DebugHandler::Print("    --position-interval <seconds> Broadcast entity positions to clients this often, 0 disables");
+    DebugHandler::Print("    --netsim-latency <ms> Simulated one way latency on every connection");
+    DebugHandler::Print("    --netsim-jitter <ms> Simulated latency varies by up to this much either way");
+    DebugHandler::Print("    --netsim-bandwidth <bytes> Simulated bandwidth per connection and direction each second");
+    DebugHandler::Print("    --netsim-loss <percent> Simulated segment loss, each one stalls its connection until the retransmit");
+    DebugHandler::Print("    --netsim-short-reads <bytes> Cut simulated reads into random pieces of at most this many bytes");
+    DebugHandler::Print("    --netsim-seed <seed> Seed for the simulator's random conditions");
+    DebugHandler::Print("    --slow-tick <ms>    Dump the last ticks as a Chrome trace when a tick takes longer, 0 disables");
+    DebugHandler::Print("    --flight-recorder-dir <dir>");
+    DebugHandler::Print("    --compression-threshold <bytes> Smallest frame compressed for clients that support it, 0 disables");
+    DebugHandler::Print("    --compression-threads <count>");
+    DebugHandler::Print("    --admin-socket <path> Accept console commands on a local socket, \"tail\" streams the log");
+    DebugHandler::Print("    --metrics-file <file> Dump every metric into <file> once per interval");
+    DebugHandler::Print("    --metrics-interval <seconds>");
+    DebugHandler::Print("    --zones <count>     Zones hosted by this process, defaults to 1");
+    DebugHandler::Print("    --handoff-port <port> Accept entities handed off by other regions on <port>");
+    DebugHandler::Print("    --handoff-peer <ip:port> Region that the handoff command hands entities to");
+    DebugHandler::Print("    --record <file>     Record every inbound packet to <file>");
+    DebugHandler::Print("    --replay <file>     Replay <file> without sockets and exit");
+    DebugHandler::Print("    --snapshot <file>   Restore from and checkpoint into <file>");
+    DebugHandler::Print("    --snapshot-interval <seconds>");
+}
+
+bool EngineConfig::Parse(i32 argc, char* argv[])
+{
+    for (i32 i = 1; i < argc; i++)
+    {
+        const char* argument = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (std::strcmp(argument, "--port") == 0 && hasValue)
+        {
+            port = static_cast<u16>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argument, "--udp-port") == 0 && hasValue)
+        {
+            udpPort = static_cast<u16>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argument, "--io-uring") == 0)
+        {
+            useIoUring = true;
+        }
+        else if (std::strcmp(argument, "--pin-io") == 0 && hasValue)
+        {
+            affinity.ioCpu = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argument, "--pin-tick") == 0 && hasValue)
+        {
+            affinity.tickCpu = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argument, "--pin-workers") == 0 && hasValue)
+        {
+            if (!ThreadAffinity::ParseCpuList(argv[++i], affinity.workerCpus))
+            {
+                DebugHandler::PrintError("Malformed CPU list: %s", argv[i]);
+                return false;
+            }
+        }
+        else if (std::strcmp(argument, "--workers") == 0 && hasValue)
+        {
+            workerCount = static_cast<u32>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argument, "--numa-node") == 0 && hasValue)
+        {
+            affinity.numaNode = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argument, "--busy-poll") == 0 && hasValue)
+        {
+            busyPollMicroseconds = static_cast<u32>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argument, "--handshake-timeout") == 0 && hasValue)
+        {
+            handshakeTimeout = std::strtof(argv[++i], nullptr);
+        }
+        else if (std::strcmp(argument, "--idle-timeout") == 0 && hasValue)
+        {
+            idleTimeout = std::strtof(argv[++i], nullptr);
+        }
+        else if (std::strcmp(argument, "--upstream-timeout") == 0 && hasValue)
+        {
+            upstreamRequestTimeout = std::strtof(argv[++i], nullptr);
+        }
+        else if (std::strcmp(argument, "--upstream-wait") == 0 && hasValue)
+        {
+            upstreamWait = std::strtof(argv[++i], nullptr);
+        }
+        else if (std::strcmp(argument, "--outbound-soft-cap") == 0 && hasValue)
+        {
+            outboundSoftCap = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argument, "--outbound-hard-cap") == 0 && hasValue)
+        {
+            outboundHardCap = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argument, "--outbound-max-age") == 0 && hasValue)
+        {
+            outboundMaxAge = std::strtof(argv[++i], nullptr);
+        }
+        else if (std::strcmp(argument, "--position-interval") == 0 && hasValue)
+        {
+            positionInterval = std::strtof(argv[++i], nullptr);
+        }
+        else if (std::strcmp(argument, "--netsim-latency") == 0 && hasValue)
+        {
+            networkConditions.latencyMS = std::strtof(argv[++i], nullptr);
+        }
+        else if (std::strcmp(argument, "--netsim-jitter") == 0 && hasValue)
+        {
+            networkConditions.jitterMS = std::strtof(argv[++i], nullptr);
+        }
+        else if (std::strcmp(argument, "--netsim-bandwidth") == 0 && hasValue)
+        {
+            networkConditions.bandwidth = static_cast<u32>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argument, "--netsim-loss") == 0 && hasValue)
+        {
+            networkConditions.lossPercent = std::strtof(argv[++i], nullptr);
+            if (networkConditions.lossPercent < 0.0f || networkConditions.lossPercent > 100.0f)
+            {
+                DebugHandler::PrintError("--netsim-loss must be between 0 and 100");
+                return false;
+            }
+        }
+        else if (std::strcmp(argument, "--netsim-short-reads") == 0 && hasValue)
+        {
+            networkConditions.maxReadSize = static_cast<u32>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argument, "--netsim-seed") == 0 && hasValue)
+        {
+            networkConditions.seed = static_cast<u32>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argument, "--slow-tick") == 0 && hasValue)
+        {
+            slowTickThresholdMS = static_cast<f32>(std::atof(argv[++i]));
+        }
+        else if (std::strcmp(argument, "--flight-recorder-dir") == 0 && hasValue)
+        {
+            flightRecorderDirectory = argv[++i];
+        }
+        else if (std::strcmp(argument, "--compression-threshold") == 0 && hasValue)
+        {
+            compressionThreshold = static_cast<u16>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argument, "--compression-threads") == 0 && hasValue)
+        {
+            compressionThreads = static_cast<u32>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argument, "--admin-socket") == 0 && hasValue)
+        {
+            adminSocketPath = argv[++i];
+        }
+        else if (std::strcmp(argument, "--metrics-file") == 0 && hasValue)
+        {
+            metricsFilePath = argv[++i];
+        }
+        else if (std::strcmp(argument, "--metrics-interval") == 0 && hasValue)
+        {
+            metricsFileInterval = std::strtof(argv[++i], nullptr);
+            if (metricsFileInterval <= 0.0f)
+            {
+                DebugHandler::PrintError("--metrics-interval must be greater than 0");
+                return false;
+            }
+        }
+        else if (std::strcmp(argument, "--zones") == 0 && hasValue)
+        {
+            zoneCount = static_cast<u32>(std::strtoul(argv[++i], nullptr, 10));
+            if (zoneCount == 0)
+            {
+                DebugHandler::PrintError("--zones must be at least 1");
+                return false;
+            }
+        }
+        else if (std::strcmp(argument, "--handoff-port") == 0 && hasValue)
+        {
+            handoffPort = static_cast<u16>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argument, "--handoff-peer") == 0 && hasValue)
+        {
+            const char* peer = argv[++i];
+            const char* separator = std::strrchr(peer, ':');
+            if (!separator || separator == peer)
+            {
+                DebugHandler::PrintError("Malformed handoff peer, expected <ip:port>: %s", peer);
+                return false;
+            }
+
+            handoffPeerHost.assign(peer, separator - peer);
+            handoffPeerPort = static_cast<u16>(std::strtoul(separator + 1, nullptr, 10));
+        }
+        else if (std::strcmp(argument, "--record") == 0 && hasValue)
+        {
+            recordPath = argv[++i];
+        }
+        else if (std::strcmp(argument, "--replay") == 0 && hasValue)
+        {
+            replayPath = argv[++i];
+        }
+        else if (std::strcmp(argument, "--snapshot") == 0 && hasValue)
+        {
+            snapshotPath = argv[++i];
+        }
+        else if (std::strcmp(argument, "--snapshot-interval") == 0 && hasValue)
+        {
+            snapshotInterval = std::strtof(argv[++i], nullptr);
+            if (snapshotInterval <= 0.0f)
+            {
+                DebugHandler::PrintError("--snapshot-interval must be greater than 0");
+                return false;
+            }
+        }
+        else
+        {
+            DebugHandler::PrintError("Unknown or incomplete argument: %s", argument);
+            PrintUsage();
+            return false;
+        }
+    }
+
+    if (!recordPath.empty() && !replayPath.empty())
+    {
+        DebugHandler::PrintError("--record and --replay can not be combined");
+        return false;
+    }
+
+    if (outboundSoftCap != 0 && outboundHardCap != 0 && outboundSoftCap > outboundHardCap)
+    {
+        DebugHandler::PrintError("--outbound-soft-cap can not be larger than --outbound-hard-cap");
+        return false;
+    }
+
+    if (networkConditions.IsEnabled() && !replayPath.empty())
+    {
+        DebugHandler::PrintError("--replay has no sockets for the network simulator to impair");
+        return false;
+    }
+
+    return true;
+}
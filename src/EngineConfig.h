@@ -0,0 +1,102 @@
+/*
+    MIT License
+
+    Copyright (c) 2020 NovusCore
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#pragma once
+#include <NovusTypes.h>
+#include <string>
+#include "Utils/ThreadAffinity.h"
+#include "Network/Simulator/NetworkSimulator.h"
+
+struct EngineConfig
+{
+    // Parses command line arguments, returns false and prints the usage on unknown or malformed arguments
+    bool Parse(i32 argc, char* argv[]);
+
+    u16 port = 3724;
+
+    // Clients may ask for a UDP channel on this port next to their TCP connection, 0 disables it
+    u16 udpPort = 0;
+
+    // Accept and receive client traffic through io_uring, falls back to asio when unavailable
+    bool useIoUring = false;
+
+    // Low latency deployment, CPU pinning for the IO, tick and worker threads plus busy polling on client sockets
+    AffinityConfig affinity;
+    u32 workerCount = 0; // 0 lets taskflow use every hardware thread
+    u32 busyPollMicroseconds = 0;
+
+    // Connection timeouts in seconds, 0 disables one
+    f32 handshakeTimeout = 10.0f; // Until a new connection's first valid packet
+    f32 idleTimeout = 300.0f;
+    f32 upstreamRequestTimeout = 5.0f; // Until the Novus Service answers a request made for a client
+
+    // Clients are only accepted once the Novus Service accepted us, or once this many seconds passed without it. 0 waits forever
+    f32 upstreamWait = 30.0f;
+
+    // Bytes sent to a client that it did not acknowledge yet. Over the soft cap it only gets HIGH priority frames right away,
+    // MEDIUM ones are coalesced as long as LOW ones and LOW ones are dropped. Over the hard cap, or over the soft cap for
+    // longer than outboundMaxAge seconds, it is evicted. 0 disables either limit
+    u64 outboundSoftCap = 256 * 1024;
+    u64 outboundHardCap = 4 * 1024 * 1024;
+    f32 outboundMaxAge = 30.0f;
+
+    // Seconds between broadcasts of every entity's position to the clients, 0 disables them
+    f32 positionInterval = 0.1f;
+
+    // Runs every client connection and the upstream link through the network simulator when any condition is set
+    NetworkConditions networkConditions;
+
+    // Ticks whose update takes longer than this get the flight recorder dumped as a trace, 0 disables dumping
+    f32 slowTickThresholdMS = 50.0f;
+    std::string flightRecorderDirectory = ".";
+
+    // Frames of at least this many bytes are compressed for clients that negotiated it, 0 disables compression
+    u16 compressionThreshold = 512;
+    u32 compressionThreads = 1;
+
+    // Local Unix socket taking console commands, stats queries and log tailing from admin tools, empty disables it
+    std::string adminSocketPath = "";
+
+    // Dumps every metric into this file each metricsFileInterval seconds, read by the soak tool
+    std::string metricsFilePath = "";
+    f32 metricsFileInterval = 1.0f;
+
+    // Zones hosted by this process, each with its own registry and system graph on the shared worker pool.
+    // Zone 0 owns the connections, the others only simulate
+    u32 zoneCount = 1;
+
+    // Inter-region link used to hand entities off, 0 and an empty host leave either side disabled
+    u16 handoffPort = 0;
+    std::string handoffPeerHost = "";
+    u16 handoffPeerPort = 0;
+
+    // Appends every framed inbound packet to this file
+    std::string recordPath = "";
+
+    // Feeds this recording through the systems as fast as possible instead of serving, then exits
+    std::string replayPath = "";
+
+    // Restores the region from this file on startup and checkpoints into it every snapshotInterval seconds
+    std::string snapshotPath = "";
+    f32 snapshotInterval = 10.0f;
+};
@@ -1,7 +1,13 @@
 #include "EngineLoop.h"
 #include <thread>
+#include <chrono>
+#include <cstring>
 #include <Utils/Timer.h>
 #include "Utils/ServiceLocator.h"
+#include "Utils/Metrics.h"
+#include "Utils/ThreadAffinity.h"
+#include "Utils/FrameArena.h"
+#include "Utils/AllocationTracker.h"
 #include <Networking/InputQueue.h>
 #include <Networking/MessageHandler.h>
 #include <Networking/NetworkClient.h>
@@ -9,26 +15,83 @@
 
 // Component Singletons
 #include "ECS/Components/Singletons/TimeSingleton.h"
+#include "ECS/Components/Singletons/SnapshotSingleton.h"
+#include "ECS/Components/Singletons/GovernorSingleton.h"
+#include "ECS/Components/Singletons/TickStatsSingleton.h"
+#include "ECS/Components/Singletons/ZoneSingleton.h"
+#include "ECS/Components/Singletons/TimerSingleton.h"
 #include "ECS/Components/Network/ConnectionSingleton.h"
 #include "ECS/Components/Network/ConnectionDeferredSingleton.h"
 #include "ECS/Components/Network/AuthenticationSingleton.h"
+#include "ECS/Components/Network/HandoffSingleton.h"
+#include "ECS/Components/Network/UdpSingleton.h"
 
 // Components
+#include "ECS/Components/Network/ConnectionComponent.h"
+#include "ECS/Components/Movement/PositionComponent.h"
 
 // Systems
+#include "ECS/Systems/Timer/TimerSystem.h"
 #include "ECS/Systems/Network/ConnectionSystems.h"
+#include "ECS/Systems/Movement/MovementSystem.h"
+#include "ECS/Systems/Network/PositionBroadcastSystem.h"
+#include "ECS/Systems/Snapshot/SnapshotSystem.h"
+#include "ECS/Systems/Handoff/HandoffSystem.h"
+#include "ECS/Systems/Zone/ZoneMessageSystem.h"
+#include "ECS/Systems/Udp/UdpSystem.h"
+#include "ECS/Systems/Governor/GovernorSystem.h"
 
 // Handlers
 #include "Network/Handlers/Self/Auth/AuthHandlers.h"
 #include "Network/Handlers/Self/GeneralHandlers.h"
 #include "Network/Handlers/Client/GeneralHandlers.h"
+#include "Network/IoUring/IoUringBackend.h"
+#include "Network/Compression/PacketCompression.h"
+#include "Network/Handoff/HandoffLink.h"
+#include "Network/Simulator/NetworkSimulator.h"
+#include "Network/Udp/UdpTransport.h"
 
-EngineLoop::EngineLoop()
-    : _isRunning(false), _inputQueue(256), _outputQueue(16)
+// Recording
+#include "Network/Recording/PacketRecorder.h"
+#include "Network/Recording/PacketReplay.h"
+
+// Diagnostics
+#include "Diagnostics/FlightRecorder.h"
+
+// Snapshots
+#include "Snapshot/RegionSnapshot.h"
+#include "Snapshot/SnapshotWriter.h"
+
+// Startup
+#include "Utils/StartupOrchestrator.h"
+
+// Console
+#include "ConsoleCommands.h"
+
+// Zones
+#include "Zones/Zone.h"
+#include "Zones/ZoneRouter.h"
+
+// Seconds between reminders that startup is still waiting for the Novus Service
+constexpr f64 STARTUP_WAITING_MESSAGE_INTERVAL = 5.0;
+
+EngineLoop::EngineLoop(const EngineConfig& config)
+    : _isRunning(false), _config(config), _inputQueue(256), _outputQueue(16), _commandQueue(16), _replyQueue(64), _updateFramework(config.workerCount)
 {
+    // Set before any thread starts, everything they print goes through our output queue
+    ServiceLocator::SetEngineLoop(this);
+
+    _commandHandler = std::make_unique<ConsoleCommandHandler>();
     _network.asioService = std::make_shared<asio::io_service>(2);
     _network.client = std::make_shared<NetworkClient>(new asio::ip::tcp::socket(*_network.asioService.get()));
-    _network.server = std::make_shared<NetworkServer>(_network.asioService, 3724);
+
+    // With io_uring the backend owns the client port, so the asio server only exists when we are not using it
+    if (!_config.useIoUring)
+        _network.server = std::make_shared<NetworkServer>(_network.asioService, _config.port);
+
+    // Created up front so the console can request handoffs before the tick thread is running
+    if (_config.handoffPort != 0 || !_config.handoffPeerHost.empty())
+        _handoffLink = std::make_shared<HandoffLink>(_network.asioService, _config.port);
 }
 
 EngineLoop::~EngineLoop()
@@ -40,8 +103,14 @@ void EngineLoop::Start()
     if (_isRunning)
         return;
 
-    std::thread threadRunIoService = std::thread(&EngineLoop::RunIoService, this);
-    threadRunIoService.detach();
+    ThreadAffinity::Configure(_config.affinity);
+
+    // Replays never touch a socket, so there is nothing for the io service to do
+    if (_config.replayPath.empty())
+    {
+        std::thread threadRunIoService = std::thread(&EngineLoop::RunIoService, this);
+        threadRunIoService.detach();
+    }
 
     std::thread threadRun = std::thread(&EngineLoop::Run, this);
     threadRun.detach();
@@ -60,8 +129,72 @@ void EngineLoop::Stop()
 void EngineLoop::PassMessage(Message& message)
 {
     _inputQueue.enqueue(message);
+    _hasInput.store(true, std::memory_order_release);
+}
+
+void EngineLoop::QueueCommand(u32 sessionId, std::string command)
+{
+    _commandQueue.enqueue({ sessionId, std::move(command) });
+    _hasInput.store(true, std::memory_order_release);
+}
+
+void EngineLoop::Reply(u32 sessionId, const std::string& text)
+{
+    _replyQueue.enqueue({ sessionId, text });
+    NotifyOutput();
+}
+
+void EngineLoop::EnqueueOutput(Message& message)
+{
+    _outputQueue.enqueue(message);
+    NotifyOutput();
 }
 
+void EngineLoop::NotifyOutput()
+{
+    // Only the first output since the last drain wakes the reader, the drain picks up everything queued after it
+    if (_outputNotifier && !_isOutputNotified.exchange(true, std::memory_order_acq_rel))
+        _outputNotifier();
+}
+
+void EngineLoop::RequestHandoff(u32 count)
+{
+    if (!_handoffLink)
+    {
+        PrintMessage("[Handoff]: No handoff link is configured, see --handoff-peer");
+        return;
+    }
+
+    _handoffLink->RequestHandoff(count);
+}
+
+u32 EngineLoop::TransferZoneEntities(u32 fromZoneId, u32 toZoneId, u32 count)
+{
+    if (!_zoneRouter || fromZoneId >= _zoneRouter->GetZoneCount() || toZoneId >= _zoneRouter->GetZoneCount())
+        return 0;
+
+    entt::registry& registry = fromZoneId == 0 ? _updateFramework.gameRegistry : _zones[fromZoneId - 1]->GetRegistry();
+
+    // Picked before transferring, TransferEntity destroys them
+    std::vector<entt::entity> entities;
+    auto view = registry.view<PositionComponent>(entt::exclude<ConnectionComponent>);
+    for (entt::entity entity : view)
+    {
+        if (entities.size() == count)
+            break;
+
+        entities.push_back(entity);
+    }
+
+    u32 transferCount = 0;
+    for (entt::entity entity : entities)
+    {
+        if (ZoneMessageSystem::TransferEntity(registry, entity, toZoneId))
+            transferCount++;
+    }
+
+    return transferCount;
+}
 bool EngineLoop::TryGetMessage(Message& message)
 {
     return _outputQueue.try_dequeue(message);
@@ -69,12 +202,16 @@ bool EngineLoop::TryGetMessage(Message& message)
 
 void EngineLoop::RunIoService()
 {
+    ThreadAffinity::PinIoThread();
+
     asio::io_service::work ioWork(*_network.asioService.get());
     _network.asioService->run();
 }
 void EngineLoop::Run()
 {
     _isRunning = true;
+    ThreadAffinity::PinTickThread();
+    PinWorkerThreads();
 
     SetupUpdateFramework();
     _updateFramework.gameRegistry.create();
@@ -83,6 +220,114 @@ void EngineLoop::Run()
     ConnectionSingleton& connectionSingleton = _updateFramework.gameRegistry.set<ConnectionSingleton>();
     ConnectionDeferredSingleton& connectionDeferredSingleton = _updateFramework.gameRegistry.set<ConnectionDeferredSingleton>();
     AuthenticationSingleton& authenticationSingleton = _updateFramework.gameRegistry.set<AuthenticationSingleton>();
+    SnapshotSingleton& snapshotSingleton = _updateFramework.gameRegistry.set<SnapshotSingleton>();
+    GovernorSingleton& governorSingleton = _updateFramework.gameRegistry.set<GovernorSingleton>();
+    TickStatsSingleton& tickStatsSingleton = _updateFramework.gameRegistry.set<TickStatsSingleton>();
+    HandoffSingleton& handoffSingleton = _updateFramework.gameRegistry.set<HandoffSingleton>();
+    ZoneSingleton& zoneSingleton = _updateFramework.gameRegistry.set<ZoneSingleton>();
+    UdpSingleton& udpSingleton = _updateFramework.gameRegistry.set<UdpSingleton>();
+    _updateFramework.gameRegistry.set<TimerSingleton>();
+
+    // Everything not tagged here is essential and never shed by the governor
+    governorSingleton.SetSystemClass(SystemId::SNAPSHOT, WorkClass::DEFERRABLE);
+    governorSingleton.SetSystemClass(SystemId::POSITION_BROADCAST, WorkClass::DEFERRABLE);
+    governorSingleton.SetPacketClass(Opcode::MSG_REQUEST_ADDRESS, WorkClass::DEFERRABLE);
+
+    if (_config.zoneCount > 1)
+    {
+        _zoneRouter = std::make_unique<ZoneRouter>(_config.zoneCount);
+        zoneSingleton.router = _zoneRouter.get();
+
+        for (u32 i = 1; i < _config.zoneCount; i++)
+        {
+            _zones.push_back(std::make_unique<Zone>(i, _zoneRouter.get()));
+        }
+        PrintMessage("[Zones]: Hosting %u zones", _config.zoneCount);
+    }
+
+    snapshotSingleton.registries.push_back(&_updateFramework.gameRegistry);
+    for (auto& zone : _zones)
+    {
+        snapshotSingleton.registries.push_back(&zone->GetRegistry());
+    }
+
+    // Everything the region needs before it can serve starts at once, clients are only accepted once all of it finished
+    StartupOrchestrator startup;
+
+    startup.Begin("pools");
+
+    _packetCompression = std::make_unique<PacketCompression>();
+    _packetCompression->Start(_config.compressionThreshold, _config.compressionThreads);
+    ServiceLocator::SetPacketCompression(_packetCompression.get());
+
+    // Handshake math stays off the IO and tick threads, a burst of logons only delays the logons
+    authenticationSingleton.workers.Start(1);
+
+    startup.Complete("pools", true);
+
+    if (!_config.replayPath.empty())
+    {
+        RunReplay();
+        _packetCompression->Stop();
+
+        Message exitMessage;
+        exitMessage.code = MSG_OUT_EXIT_CONFIRM;
+        EnqueueOutput(exitMessage);
+        return;
+    }
+
+    // Nothing else touches the registry's entities before the first tick, so the snapshot loads while the rest starts up
+    if (!_config.snapshotPath.empty())
+    {
+        startup.RunAsync("snapshot", [this, &snapshotSingleton]()
+        {
+            u64 snapshotTick = 0;
+            u32 componentCount = 0;
+            u32 skippedCount = 0;
+            if (RegionSnapshot::Load(_config.snapshotPath, snapshotSingleton.registries, snapshotTick, componentCount, skippedCount))
+                PrintMessage("[Snapshot]: Restored %u components from tick %u", componentCount, static_cast<u32>(snapshotTick));
+
+            if (skippedCount > 0)
+                PrintMessage("[Snapshot]: Skipped %u components of zones past --zones %u", skippedCount, _config.zoneCount);
+
+            _snapshotWriter = std::make_unique<SnapshotWriter>();
+            if (!_snapshotWriter->Open(_config.snapshotPath))
+            {
+                PrintMessage("[Snapshot]: Failed to open (%s)", _config.snapshotPath.c_str());
+                return false;
+            }
+
+            snapshotSingleton.writer = _snapshotWriter.get();
+            snapshotSingleton.interval = _config.snapshotInterval;
+            return true;
+        });
+    }
+
+    if (!_config.recordPath.empty())
+    {
+        _packetRecorder = std::make_unique<PacketRecorder>();
+        if (_packetRecorder->Open(_config.recordPath))
+        {
+            ServiceLocator::SetPacketRecorder(_packetRecorder.get());
+            PrintMessage("[PacketRecorder]: Recording inbound packets to (%s)", _config.recordPath.c_str());
+        }
+        else
+        {
+            PrintMessage("[PacketRecorder]: Failed to open (%s)", _config.recordPath.c_str());
+        }
+    }
+
+    // Set up before the first socket exists, every read and send from then on goes through it
+    if (_config.networkConditions.IsEnabled())
+    {
+        const NetworkConditions& conditions = _config.networkConditions;
+        _networkSimulator = std::make_unique<NetworkSimulator>(conditions);
+        ServiceLocator::SetNetworkSimulator(_networkSimulator.get());
+        PrintMessage("[NetworkSimulator]: %.1f ms latency, %.1f ms jitter, %u bytes/s, %.2f%% loss, %u byte reads", conditions.latencyMS, conditions.jitterMS, conditions.bandwidth, conditions.lossPercent, conditions.maxReadSize);
+    }
+
+    // Completed by WaitForStartup once the Novus Service accepted us
+    startup.Begin("upstream");
 
     connectionSingleton.networkClient = _network.client;
     connectionSingleton.networkClient->SetReadHandler(std::bind(&ConnectionUpdateSystem::Self_HandleRead, std::placeholders::_1));
@@ -90,31 +335,141 @@ void EngineLoop::Run()
     connectionSingleton.networkClient->SetDisconnectHandler(std::bind(&ConnectionUpdateSystem::Self_HandleDisconnect, std::placeholders::_1));
     connectionSingleton.networkClient->Connect("127.0.0.1", 8000); // This is the IP/Port for the local Novus-Service
     
+    // The client port is bound here, but connections wait in its backlog until startup finished
+    startup.Begin("listener");
+
+    if (_config.useIoUring)
+    {
+        _ioUringBackend = std::make_unique<IoUringBackend>(_network.asioService);
+        if (_ioUringBackend->Start(_config.port))
+        {
+            connectionDeferredSingleton.ioUringBackend = _ioUringBackend.get();
+            PrintMessage("[Network]: Using the io_uring backend on port %u", _config.port);
+        }
+        else
+        {
+            PrintMessage("[Network]: io_uring is unavailable, falling back to asio");
+            _ioUringBackend.reset();
+            _network.server = std::make_shared<NetworkServer>(_network.asioService, _config.port);
+        }
+    }
+
     connectionDeferredSingleton.networkServer = _network.server;
+    connectionDeferredSingleton.listenPort = _config.port;
+    connectionDeferredSingleton.busyPollMicroseconds = _config.busyPollMicroseconds;
+    connectionDeferredSingleton.handshakeTimeout = _config.handshakeTimeout;
+    connectionDeferredSingleton.idleTimeout = _config.idleTimeout;
+    connectionDeferredSingleton.upstreamRequestTimeout = _config.upstreamRequestTimeout;
+    connectionDeferredSingleton.outboundSoftCap = _config.outboundSoftCap;
+    connectionDeferredSingleton.outboundHardCap = _config.outboundHardCap;
+    connectionDeferredSingleton.outboundMaxAge = _config.outboundMaxAge;
+    connectionDeferredSingleton.positionInterval = _config.positionInterval;
+
+    if (_network.server)
+        _network.server->SetConnectionHandler(std::bind(&ConnectionUpdateSystem::Server_HandleConnect, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+
+    if (_handoffLink)
+    {
+        if (_config.handoffPort != 0)
+        {
+            if (_handoffLink->Listen(_config.handoffPort))
+                PrintMessage("[Handoff]: Accepting handoffs on port %u", _config.handoffPort);
+            else
+                PrintMessage("[Handoff]: Failed to listen on port %u", _config.handoffPort);
+        }
 
-    _network.server->SetConnectionHandler(std::bind(&ConnectionUpdateSystem::Server_HandleConnect, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
-    _network.server->Start();
+        if (!_config.handoffPeerHost.empty())
+            _handoffLink->Connect(_config.handoffPeerHost, _config.handoffPeerPort);
+
+        handoffSingleton.link = _handoffLink.get();
+    }
+
+    if (_config.udpPort != 0)
+    {
+        _udpTransport = std::make_shared<UdpTransport>(_network.asioService);
+        if (_udpTransport->Open(_config.udpPort))
+        {
+            udpSingleton.transport = _udpTransport.get();
+            PrintMessage("[Udp]: Offering UDP channels on port %u", _udpTransport->GetPort());
+        }
+        else
+        {
+            PrintMessage("[Udp]: Failed to bind port %u, clients stay on TCP", _config.udpPort);
+            _udpTransport.reset();
+        }
+    }
+
+    startup.Complete("listener", true);
+
+    bool isServing = WaitForStartup(startup);
+    if (isServing)
+    {
+        if (_ioUringBackend)
+            _ioUringBackend->StartAccepting();
+        else
+            _network.server->Start();
+    }
+
+    _flightRecorder = std::make_unique<FlightRecorder>();
+    _flightRecorder->Start(_config.flightRecorderDirectory, _config.slowTickThresholdMS);
 
     Timer timer;
-    f32 targetDelta = 1.0f / 60.0f;
-    while (true)
+    f32 targetDelta = 1.0f / TICKS_PER_SECOND;
+
+    // A tick thread with a core to itself spins out the whole wait, sleeping would hand the core back to the scheduler and add wakeup jitter
+    f32 sleepMargin = _config.affinity.tickCpu >= 0 ? targetDelta : 0.0025f;
+
+    // Only counts anything when built with REGION_TRACK_ALLOCATIONS
+    std::atomic<i64>& tickAllocationsMetric = Metrics::Get("tick.heapAllocations");
+    f32 lastAllocationWarningTime = -1.0f;
+    f32 lastMetricsFileTime = 0.0f;
+
+    while (isServing)
     {
         f32 deltaTime = timer.GetDeltaTime();
         timer.Tick();
+        auto tickStart = std::chrono::steady_clock::now();
 
         timeSingleton.lifeTimeInS = timer.GetLifeTime();
         timeSingleton.lifeTimeInMS = timeSingleton.lifeTimeInS * 1000;
         timeSingleton.deltaTime = deltaTime;
+        timeSingleton.tick++;
 
-        if (!Update())
-            break;
+        if (_packetRecorder)
+            _packetRecorder->SetTick(timeSingleton.tick);
+
+        {
+            AllocationScope allocationScope;
+            if (!Update())
+                break;
+
+            GovernorSystem::Update(_updateFramework.gameRegistry, timer.GetDeltaTime(), targetDelta);
+        }
+
+        // Every task has finished, frame memory handed out this tick is no longer referenced
+        FrameArena::EndFrame();
+
+        u64 tickAllocations = AllocationTracker::Flush();
+        if (tickAllocations > 0)
+        {
+            tickAllocationsMetric.fetch_add(static_cast<i64>(tickAllocations), std::memory_order_relaxed);
+
+            if (timeSingleton.lifeTimeInS - lastAllocationWarningTime >= 1.0f)
+            {
+                PrintMessage("[Allocations]: %llu heap allocations during tick %llu", static_cast<unsigned long long>(tickAllocations), static_cast<unsigned long long>(timeSingleton.tick));
+                lastAllocationWarningTime = timeSingleton.lifeTimeInS;
+            }
+        }
+
+        Metrics::Publish();
+        auto updateEnd = std::chrono::steady_clock::now();
 
         {
             ZoneScopedNC("WaitForTickRate", tracy::Color::AntiqueWhite1)
 
             // Wait for tick rate, this might be an overkill implementation but it has the even tickrate I've seen - MPursche
             {
-                ZoneScopedNC("Sleep", tracy::Color::AntiqueWhite1) for (deltaTime = timer.GetDeltaTime(); deltaTime < targetDelta - 0.0025f; deltaTime = timer.GetDeltaTime())
+                ZoneScopedNC("Sleep", tracy::Color::AntiqueWhite1) for (deltaTime = timer.GetDeltaTime(); deltaTime < targetDelta - sleepMargin; deltaTime = timer.GetDeltaTime())
                 {
                     std::this_thread::sleep_for(std::chrono::milliseconds(1));
                 }
@@ -127,48 +482,294 @@ void EngineLoop::Run()
             }
         }
 
+        {
+            ZoneScopedNC("FlightRecorder::Record", tracy::Color::AntiqueWhite1)
+            auto toNanoseconds = [](auto duration) { return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()); };
+
+            _flightRecorder->Record(timeSingleton.tick, toNanoseconds(tickStart.time_since_epoch()), toNanoseconds(updateEnd - tickStart), toNanoseconds(std::chrono::steady_clock::now() - updateEnd), governorSingleton.level, tickStatsSingleton);
+            tickStatsSingleton.Reset();
+        }
+
+        // Written once the flight recorder took its sample, the file IO never shows up in a tick's update time
+        if (!_config.metricsFilePath.empty() && timeSingleton.lifeTimeInS - lastMetricsFileTime >= _config.metricsFileInterval)
+        {
+            ZoneScopedNC("Metrics::WriteFile", tracy::Color::AntiqueWhite1)
+            if (!Metrics::WriteFile(_config.metricsFilePath))
+                PrintMessage("[Metrics]: Failed to write (%s)", _config.metricsFilePath.c_str());
+
+            lastMetricsFileTime = timeSingleton.lifeTimeInS;
+        }
 
         FrameMark
     }
 
     // Clean up stuff here
+    if (_packetRecorder)
+        _packetRecorder->Close();
+
+    if (_snapshotWriter)
+        _snapshotWriter->Close();
+
+    if (_ioUringBackend)
+        _ioUringBackend->Stop();
+
+    if (_handoffLink)
+        _handoffLink->Close();
+
+    if (_udpTransport)
+        _udpTransport->Close();
+
+    _packetCompression->Stop();
+    authenticationSingleton.workers.Stop();
+    _flightRecorder->Stop();
 
     Message exitMessage;
     exitMessage.code = MSG_OUT_EXIT_CONFIRM;
-    _outputQueue.enqueue(exitMessage);
+    EnqueueOutput(exitMessage);
 }
 
-bool EngineLoop::Update()
+void EngineLoop::RunReplay()
 {
-    ZoneScopedNC("Update", tracy::Color::Blue2)
+    PacketReplay replay;
+    if (!replay.Open(_config.replayPath))
     {
-        ZoneScopedNC("HandleMessages", tracy::Color::Green3)
-            Message message;
+        PrintMessage("[Replay]: Failed to open (%s)", _config.replayPath.c_str());
+        return;
+    }
+
+    entt::registry& registry = _updateFramework.gameRegistry;
+    TimeSingleton& timeSingleton = registry.ctx<TimeSingleton>();
+    ConnectionSingleton& connectionSingleton = registry.ctx<ConnectionSingleton>();
+
+    // The upstream link is never authenticated during a replay, its sends are queued on the idle io service
+    connectionSingleton.networkClient = _network.client;
+    connectionSingleton.networkClient->SetStatus(ConnectionStatus::CONNECTED);
+
+    PacketRecord record;
+    const u8* payload = nullptr;
+    bool hasRecord = replay.Next(record, payload);
+    if (!hasRecord)
+    {
+        PrintMessage("[Replay]: (%s) contains no packets", _config.replayPath.c_str());
+        return;
+    }
+
+    u32 packetCount = 0;
+    u32 tickCount = 0;
+    f64 maxTickTimeMS = 0;
 
-        while (_inputQueue.try_dequeue(message))
+    const f32 targetDelta = 1.0f / TICKS_PER_SECOND;
+    auto replayStart = std::chrono::high_resolution_clock::now();
+
+    // Packets recorded during tick N were dispatched by the Update of tick N + 1
+    for (u64 tick = record.tick + 1; hasRecord; tick++)
+    {
+        while (hasRecord && record.tick < tick)
         {
-            if (message.code == -1)
-                assert(false);
+            Opcode opcode = static_cast<Opcode>(record.opcode);
+            moodycamel::ConcurrentQueue<std::shared_ptr<NetworkPacket>>* packetQueue = nullptr;
 
-            if (message.code == MSG_IN_EXIT)
+            if (record.connectionId == PacketRecorder::UPSTREAM_CONNECTION_ID)
             {
-                return false;
+                // We can not repeat the SRP exchange against a recording, so the upstream link starts out connected
+                bool isAuthPacket = opcode == Opcode::SMSG_LOGON_CHALLENGE || opcode == Opcode::SMSG_LOGON_HANDSHAKE || opcode == Opcode::SMSG_CONNECTED;
+                if (!isAuthPacket)
+                    packetQueue = &connectionSingleton.packetQueue;
             }
-            else if (message.code == MSG_IN_PING)
+            else
             {
-                ZoneScopedNC("Ping", tracy::Color::Green3)
-                    Message pongMessage;
-                pongMessage.code = MSG_OUT_PRINT;
-                pongMessage.message = new std::string("PONG!");
-                _outputQueue.enqueue(pongMessage);
+                // Recreate connections with their recorded entity id, upstream replies reference them by it
+                entt::entity entity = static_cast<entt::entity>(record.connectionId);
+                if (!registry.valid(entity))
+                {
+                    entity = registry.create(entity);
+
+                    ConnectionComponent& connectionComponent = registry.emplace<ConnectionComponent>(entity);
+                    connectionComponent.connection = std::make_shared<NetworkClient>(new asio::ip::tcp::socket(*_network.asioService.get()), entt::to_integral(entity));
+                }
+
+                packetQueue = &registry.get<ConnectionComponent>(entity).packetQueue;
             }
+
+            if (packetQueue)
+            {
+                std::shared_ptr<NetworkPacket> packet = NetworkPacket::Borrow();
+                packet->header.opcode = opcode;
+                packet->header.size = record.size;
+
+                u16 payloadSize = record.size & PACKET_SIZE_MASK;
+                if (payloadSize)
+                {
+                    packet->payload = Bytebuffer::Borrow<NETWORK_BUFFER_SIZE>();
+                    packet->payload->size = payloadSize;
+                    packet->payload->writtenData = payloadSize;
+                    std::memcpy(packet->payload->GetDataPointer(), payload, payloadSize);
+                }
+
+                packetQueue->enqueue(packet);
+                packetCount++;
+            }
+
+            hasRecord = replay.Next(record, payload);
         }
+
+        // Time is stepped at the fixed tick rate to keep replays deterministic
+        timeSingleton.tick = tick;
+        timeSingleton.deltaTime = targetDelta;
+        timeSingleton.lifeTimeInS = tickCount * targetDelta;
+        timeSingleton.lifeTimeInMS = timeSingleton.lifeTimeInS * 1000;
+
+        auto tickStart = std::chrono::high_resolution_clock::now();
+        if (!Update())
+            break;
+
+        FrameArena::EndFrame();
+        registry.ctx<TickStatsSingleton>().Reset();
+
+        f64 tickTimeMS = std::chrono::duration<f64, std::milli>(std::chrono::high_resolution_clock::now() - tickStart).count();
+        if (tickTimeMS > maxTickTimeMS)
+            maxTickTimeMS = tickTimeMS;
+
+        tickCount++;
+        FrameMark
+    }
+
+    f64 replayTimeMS = std::chrono::duration<f64, std::milli>(std::chrono::high_resolution_clock::now() - replayStart).count();
+    f64 averageTickTimeMS = tickCount > 0 ? replayTimeMS / tickCount : 0;
+
+    PrintMessage("[Replay]: Replayed %u packets over %u ticks in %.2f ms (avg tick %.3f ms, max tick %.3f ms)", packetCount, tickCount, replayTimeMS, averageTickTimeMS, maxTickTimeMS);
+}
+
+bool EngineLoop::Update()
+{
+    ZoneScopedNC("Update", tracy::Color::Blue2)
+    if (!HandleMessages())
+        return false;
+
+    if (_networkSimulator)
+    {
+        ZoneScopedNC("NetworkSimulator::Update", tracy::Color::Green3)
+        _networkSimulator->Update(_updateFramework.gameRegistry);
     }
 
     UpdateSystems();
     return true;
 }
 
+bool EngineLoop::HandleMessages()
+{
+    if (!_hasInput.exchange(false, std::memory_order_acquire))
+        return true;
+
+    ZoneScopedNC("HandleMessages", tracy::Color::Green3)
+        Message message;
+
+    while (_inputQueue.try_dequeue(message))
+    {
+        if (message.code == -1)
+            assert(false);
+
+        if (message.code == MSG_IN_EXIT)
+        {
+            return false;
+        }
+    }
+
+    // Commands from the console and every admin session run here together, at the same point of the tick
+    CommandRequest request;
+    while (_commandQueue.try_dequeue(request))
+    {
+        _commandHandler->HandleCommand(*this, request.sessionId, request.command);
+    }
+
+    return true;
+}
+
+bool EngineLoop::WaitForStartup(StartupOrchestrator& startup)
+{
+    static std::atomic<i64>& timeToServingMetric = Metrics::Get("startup.timeToServingMs");
+
+    entt::registry& registry = _updateFramework.gameRegistry;
+    AuthenticationSingleton& authenticationSingleton = registry.ctx<AuthenticationSingleton>();
+    f64 lastWaitingMessageMS = 0.0;
+
+    // The tick loop isn't running yet, so the upstream link's handshake is pumped from here
+    while (!startup.IsComplete())
+    {
+        if (!HandleMessages())
+        {
+            startup.Join();
+            return false;
+        }
+
+        if (_networkSimulator)
+            _networkSimulator->Update(registry);
+
+        ConnectionUpdateSystem::UpdateUpstream(registry);
+
+        f64 elapsedMS = startup.GetElapsedMS();
+        if (authenticationSingleton.isAuthenticated)
+        {
+            startup.Complete("upstream", true);
+        }
+        else if (_config.upstreamWait > 0.0f && elapsedMS >= _config.upstreamWait * 1000.0)
+        {
+            // Client requests made without the Novus Service fail through the upstream timeout instead, which beats not serving at all
+            PrintMessage("[Startup]: The Novus Service did not accept us within %.1f seconds, serving without it", _config.upstreamWait);
+            startup.Complete("upstream", false);
+        }
+        else if (elapsedMS - lastWaitingMessageMS >= STARTUP_WAITING_MESSAGE_INTERVAL * 1000.0)
+        {
+            PrintMessage("[Startup]: Waiting for the Novus Service");
+            lastWaitingMessageMS = elapsedMS;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    startup.Join();
+    startup.ForEach([this](const std::string& name, f64 durationMS, bool succeeded)
+    {
+        Metrics::Set("startup." + name + "Ms", static_cast<i64>(durationMS));
+        PrintMessage("[Startup]: %s took %.2f ms%s", name.c_str(), durationMS, succeeded ? "" : " and failed");
+    });
+
+    f64 timeToServingMS = startup.GetElapsedMS();
+    timeToServingMetric.store(static_cast<i64>(timeToServingMS), std::memory_order_relaxed);
+    PrintMessage("[Startup]: Accepting clients on port %u after %.2f ms", _config.port, timeToServingMS);
+    return true;
+}
+
+void EngineLoop::PinWorkerThreads()
+{
+    if (!ThreadAffinity::IsConfigured())
+        return;
+
+    // Every task holds its worker until all of them arrived, so each worker runs exactly one and is pinned before the first tick
+    u32 workerCount = _config.workerCount > 0 ? _config.workerCount : std::thread::hardware_concurrency();
+    std::atomic<u32> arrivedCount{ 0 };
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+
+    tf::Framework pinFramework;
+    for (u32 i = 0; i < workerCount; i++)
+    {
+        pinFramework.emplace([&arrivedCount, workerCount, deadline]()
+        {
+            ThreadAffinity::PinWorkerThread();
+            arrivedCount.fetch_add(1, std::memory_order_acq_rel);
+
+            while (arrivedCount.load(std::memory_order_acquire) < workerCount && std::chrono::steady_clock::now() < deadline)
+                std::this_thread::yield();
+        });
+    }
+
+    _updateFramework.taskflow.run(pinFramework);
+    _updateFramework.taskflow.wait_for_all();
+
+    if (arrivedCount.load(std::memory_order_acquire) < workerCount)
+        PrintMessage("[Affinity]: Only pinned %u of %u worker threads", arrivedCount.load(std::memory_order_acquire), workerCount);
+}
+
 void EngineLoop::SetupUpdateFramework()
 {
     tf::Framework& framework = _updateFramework.framework;
@@ -177,20 +778,76 @@ void EngineLoop::SetupUpdateFramework()
     ServiceLocator::SetRegistry(&registry);
     SetMessageHandler();
 
+    // TimerSystem
+    tf::Task timerSystemTask = framework.emplace([&registry]()
+    {
+        SystemCostScope costScope(registry.ctx<GovernorSingleton>(), registry.ctx<TickStatsSingleton>(), SystemId::TIMERS);
+        TimerSystem::Update(registry);
+    });
+
+    // UdpSystem, frames its datagrams onto the packet queues before ConnectionUpdateSystem dispatches them
+    tf::Task udpSystemTask = framework.emplace([&registry]()
+    {
+        SystemCostScope costScope(registry.ctx<GovernorSingleton>(), registry.ctx<TickStatsSingleton>(), SystemId::UDP);
+        UdpSystem::Update(registry);
+    });
+    udpSystemTask.gather(timerSystemTask);
+
     // ConnectionUpdateSystem
     tf::Task connectionUpdateSystemTask = framework.emplace([&registry]()
     {
         ZoneScopedNC("ConnectionUpdateSystem::Update", tracy::Color::Blue2)
+        SystemCostScope costScope(registry.ctx<GovernorSingleton>(), registry.ctx<TickStatsSingleton>(), SystemId::CONNECTION_UPDATE);
         ConnectionUpdateSystem::Update(registry);
     });
+    connectionUpdateSystemTask.gather(udpSystemTask);
 
     // ConnectionDeferredSystem
     tf::Task connectionDeferredSystemTask = framework.emplace([&registry]()
     {
         ZoneScopedNC("ConnectionDeferredSystem::Update", tracy::Color::Blue2)
+        SystemCostScope costScope(registry.ctx<GovernorSingleton>(), registry.ctx<TickStatsSingleton>(), SystemId::CONNECTION_DEFERRED);
         ConnectionDeferredSystem::Update(registry);
     });
     connectionDeferredSystemTask.gather(connectionUpdateSystemTask);
+
+    // HandoffSystem
+    tf::Task handoffSystemTask = framework.emplace([&registry]()
+    {
+        SystemCostScope costScope(registry.ctx<GovernorSingleton>(), registry.ctx<TickStatsSingleton>(), SystemId::HANDOFF);
+        HandoffSystem::Update(registry);
+    });
+    handoffSystemTask.gather(connectionDeferredSystemTask);
+
+    // ZoneMessageSystem
+    tf::Task zoneMessageSystemTask = framework.emplace([&registry]()
+    {
+        SystemCostScope costScope(registry.ctx<GovernorSingleton>(), registry.ctx<TickStatsSingleton>(), SystemId::ZONE_MESSAGES);
+        ZoneMessageSystem::Update(registry);
+    });
+    zoneMessageSystemTask.gather(handoffSystemTask);
+
+    // MovementSystem
+    tf::Task movementSystemTask = framework.emplace([&registry](tf::Subflow& subflow)
+    {
+        ZoneScopedNC("MovementSystem::Update", tracy::Color::Blue2)
+        SystemCostScope costScope(registry.ctx<GovernorSingleton>(), registry.ctx<TickStatsSingleton>(), SystemId::MOVEMENT);
+        MovementSystem::Update(registry, subflow);
+    });
+    movementSystemTask.gather(zoneMessageSystemTask);
+
+    // PositionBroadcastSystem, sends the positions MovementSystem just integrated
+    tf::Task positionBroadcastSystemTask = framework.emplace([&registry]()
+    {
+        GovernorSingleton& governor = registry.ctx<GovernorSingleton>();
+        if (!governor.ShouldRun(SystemId::POSITION_BROADCAST))
+            return;
+
+        ZoneScopedNC("PositionBroadcastSystem::Update", tracy::Color::Blue2)
+        SystemCostScope costScope(governor, registry.ctx<TickStatsSingleton>(), SystemId::POSITION_BROADCAST);
+        PositionBroadcastSystem::Update(registry);
+    });
+    positionBroadcastSystemTask.gather(movementSystemTask);
 }
 void EngineLoop::SetMessageHandler()
 {
@@ -206,12 +863,38 @@ void EngineLoop::SetMessageHandler()
 void EngineLoop::UpdateSystems()
 {
     ZoneScopedNC("UpdateSystems", tracy::Color::Blue2)
+    entt::registry& primaryRegistry = _updateFramework.gameRegistry;
+    for (auto& zone : _zones)
     {
+        zone->BeginTick(primaryRegistry);
+    }
+
+    {
+        // Every zone's graph goes to the same executor, whose workers steal across all of them
         ZoneScopedNC("Taskflow::Run", tracy::Color::Blue2)
             _updateFramework.taskflow.run(_updateFramework.framework);
+
+        for (auto& zone : _zones)
+        {
+            _updateFramework.taskflow.run(zone->GetFramework());
+        }
     }
     {
         ZoneScopedNC("Taskflow::WaitForAll", tracy::Color::Blue2)
             _updateFramework.taskflow.wait_for_all();
     }
+
+    for (auto& zone : _zones)
+    {
+        zone->EndTick(primaryRegistry);
+    }
+
+    // SnapshotSystem, outside the graphs since it captures every zone and they only hold still once all of them finished
+    GovernorSingleton& governor = primaryRegistry.ctx<GovernorSingleton>();
+    if (governor.ShouldRun(SystemId::SNAPSHOT))
+    {
+        ZoneScopedNC("SnapshotSystem::Update", tracy::Color::Blue2)
+        SystemCostScope costScope(governor, primaryRegistry.ctx<TickStatsSingleton>(), SystemId::SNAPSHOT);
+        SnapshotSystem::Update(primaryRegistry);
+    }
 }
@@ -23,6 +23,12 @@
 */
 #pragma once
 #include <NovusTypes.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 #include <entt.hpp>
 #include <taskflow/taskflow.hpp>
 #include <asio/io_service.hpp>
@@ -30,14 +36,29 @@
 #include <Utils/StringUtils.h>
 #include <Utils/ConcurrentQueue.h>
 #include <Networking/NetworkServer.h>
+#include "EngineConfig.h"
 
 namespace tf
 {
 class Framework;
 }
+class PacketRecorder;
+class SnapshotWriter;
+class IoUringBackend;
+class PacketCompression;
+class StartupOrchestrator;
+class ConsoleCommandHandler;
+class FlightRecorder;
+class HandoffLink;
+class NetworkSimulator;
+class UdpTransport;
+class ZoneRouter;
+class Zone;
 
 struct FrameworkRegistryPair
 {
+    FrameworkRegistryPair(u32 workerCount) : taskflow(workerCount > 0 ? workerCount : std::thread::hardware_concurrency()) { }
+
     entt::registry gameRegistry;
     tf::Framework framework;
     tf::Taskflow taskflow;
@@ -50,10 +71,25 @@ struct NetworkPair
     std::shared_ptr<asio::io_service> asioService;
 };
 
+// Commands and their replies are addressed by session, the console is always session 0 and admin sessions count up from 1
+constexpr u32 CONSOLE_SESSION_ID = 0;
+
+struct CommandRequest
+{
+    u32 sessionId;
+    std::string command;
+};
+
+struct CommandReply
+{
+    u32 sessionId;
+    std::string text;
+};
+
 class EngineLoop
 {
 public:
-    EngineLoop();
+    EngineLoop(const EngineConfig& config);
     ~EngineLoop();
 
     void Start();
@@ -62,6 +98,23 @@ public:
     void PassMessage(Message& message);
     bool TryGetMessage(Message& message);
 
+    // Runs the command at the start of the next tick, its replies go back to sessionId. Safe from any thread
+    void QueueCommand(u32 sessionId, std::string command);
+    void Reply(u32 sessionId, const std::string& text);
+    bool TryGetReply(CommandReply& reply) { return _replyQueue.try_dequeue(reply); }
+
+    // Called by whichever thread queues output while the notification is clear, set before Start.
+    // Clear it before draining TryGetMessage and TryGetReply so nothing queued meanwhile goes unnoticed
+    void SetOutputNotifier(std::function<void()>&& notifier) { _outputNotifier = std::move(notifier); }
+    void ClearOutputNotification() { _isOutputNotified.store(false, std::memory_order_release); }
+
+    // Hands up to count connections off to the handoff peer, picked up by HandoffSystem on the next tick
+    void RequestHandoff(u32 count);
+
+    // Moves up to count entities without a connection from one zone to another, returns how many were sent
+    // Only called by console commands, which run on the tick thread while no zone is ticking
+    u32 TransferZoneEntities(u32 fromZoneId, u32 toZoneId, u32 count);
+
     template <typename... Args>
     void PrintMessage(std::string message, Args... args)
     {
@@ -71,22 +124,48 @@ public:
         Message printMessage;
         printMessage.code = MSG_OUT_PRINT;
         printMessage.message = new std::string(str);
-        _outputQueue.enqueue(printMessage);
+        EnqueueOutput(printMessage);
     }
 
 private:
+    void EnqueueOutput(Message& message);
+    void NotifyOutput();
+
     void Run();
+    void RunReplay();
     void RunIoService();
     bool Update();
     void UpdateSystems();
+    bool HandleMessages();
+
+    // Returns once every startup phase finished, false if we were asked to exit before that
+    bool WaitForStartup(StartupOrchestrator& startup);
 
     void SetupUpdateFramework();
     void SetMessageHandler();
+    void PinWorkerThreads();
 private:
     bool _isRunning;
+    EngineConfig _config;
 
     moodycamel::ConcurrentQueue<Message> _inputQueue;
     moodycamel::ConcurrentQueue<Message> _outputQueue;
+    moodycamel::ConcurrentQueue<CommandRequest> _commandQueue;
+    moodycamel::ConcurrentQueue<CommandReply> _replyQueue;
+    std::atomic<bool> _hasInput{ false }; // Raised after queueing a message or command, an idle tick only loads it
+    std::atomic<bool> _isOutputNotified{ false };
+    std::function<void()> _outputNotifier;
+    std::unique_ptr<ConsoleCommandHandler> _commandHandler;
     FrameworkRegistryPair _updateFramework;
     NetworkPair _network;
+    std::unique_ptr<PacketRecorder> _packetRecorder;
+    std::unique_ptr<SnapshotWriter> _snapshotWriter;
+    std::unique_ptr<IoUringBackend> _ioUringBackend;
+    std::unique_ptr<PacketCompression> _packetCompression;
+    std::unique_ptr<FlightRecorder> _flightRecorder;
+    std::shared_ptr<HandoffLink> _handoffLink; // Shared with its handlers on the io service
+    std::unique_ptr<NetworkSimulator> _networkSimulator;
+    std::shared_ptr<UdpTransport> _udpTransport; // Shared with its handlers on the io service
+    std::unique_ptr<ZoneRouter> _zoneRouter;
+    std::vector<std::unique_ptr<Zone>> _zones; // Every zone but the primary one, which is _updateFramework
 };
@@ -0,0 +1,53 @@
+#include "PacketBroadcast.h"
+#include "../Compression/PacketCompression.h"
+#include "../../ECS/Systems/Network/ConnectionSystems.h"
+#include "../../Utils/ServiceLocator.h"
+#include "../../Utils/Metrics.h"
+
+PacketBroadcast::PacketBroadcast(std::shared_ptr<Bytebuffer> buffer, PacketPriority priority) : _buffer(std::move(buffer)), _compression(ServiceLocator::GetPacketCompression()), _priority(priority)
+{
+}
+
+PacketBroadcast::~PacketBroadcast()
+{
+    static std::atomic<i64>& messagesMetric = Metrics::Get("broadcast.messages");
+    static std::atomic<i64>& recipientsMetric = Metrics::Get("broadcast.recipients");
+    static std::atomic<i64>& bytesMetric = Metrics::Get("broadcast.bytesSaved");
+
+    if (_recipientCount == 0)
+        return;
+
+    // Every recipient past the first would have cost a serialization and a copy of its own
+    messagesMetric.fetch_add(1, std::memory_order_relaxed);
+    recipientsMetric.fetch_add(_recipientCount, std::memory_order_relaxed);
+    bytesMetric.fetch_add(static_cast<i64>(_buffer->writtenData) * (_recipientCount - 1), std::memory_order_relaxed);
+}
+
+void PacketBroadcast::Send(entt::registry& registry, entt::entity entity, ConnectionComponent& connection)
+{
+    _recipientCount++;
+
+    if (_priority != PacketPriority::HIGH)
+    {
+        ConnectionUpdateSystem::Coalesce(registry, entity, connection, Prepare(connection), _priority);
+        return;
+    }
+
+    // Queued behind whatever the connection already has coalesced
+    ConnectionUpdateSystem::FlushCoalesced(registry, connection);
+    _compression->SendPrepared(connection, Prepare(connection));
+}
+
+const std::shared_ptr<Bytebuffer>& PacketBroadcast::Prepare(const ConnectionComponent& connection)
+{
+    if (!connection.supportsCompression || !_compression->IsEnabled())
+        return _buffer;
+
+    if (!_isCompressionAttempted)
+    {
+        _compressedBuffer = _compression->Compress(_buffer);
+        _isCompressionAttempted = true;
+    }
+
+    return _compressedBuffer ? _compressedBuffer : _buffer;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <NovusTypes.h>
+#include <memory>
+#include <entt.hpp>
+#include <Utils/ByteBuffer.h>
+#include "../../ECS/Components/Network/ConnectionComponent.h"
+
+class PacketCompression;
+
+// A message serialized once and queued as the very same buffer on any number of connections.
+// The buffer is shared between every send, so it must not be written to once the broadcast owns it.
+// Connections that negotiated compression share a single compressed copy, made the first time one of them is reached.
+// MEDIUM and LOW priority broadcasts are coalesced per connection like any other frame of that priority, only their bytes are copied
+class PacketBroadcast
+{
+public:
+    PacketBroadcast(std::shared_ptr<Bytebuffer> buffer, PacketPriority priority = PacketPriority::HIGH);
+    ~PacketBroadcast();
+
+    void Send(entt::registry& registry, entt::entity entity, ConnectionComponent& connection);
+
+    // Sends to every entity in the range that has a connection, an interest set or any other list of entities
+    template <typename Entities>
+    void SendTo(entt::registry& registry, const Entities& entities)
+    {
+        for (entt::entity entity : entities)
+        {
+            if (ConnectionComponent* connection = registry.try_get<ConnectionComponent>(entity))
+                Send(registry, entity, *connection);
+        }
+    }
+
+    // Sends to every connection the filter accepts, the filter is called as filter(entity, connection) -> bool
+    template <typename Filter>
+    void SendToAll(entt::registry& registry, Filter&& filter)
+    {
+        auto view = registry.view<ConnectionComponent>();
+        view.each([this, &registry, &filter](const auto entity, ConnectionComponent& connection)
+        {
+            if (filter(entity, connection))
+                Send(registry, entity, connection);
+        });
+    }
+
+    void SendToAll(entt::registry& registry)
+    {
+        SendToAll(registry, [](const auto, ConnectionComponent&) { return true; });
+    }
+
+    u32 GetRecipientCount() const { return _recipientCount; }
+
+private:
+    // The buffer as it goes to the connection, the shared compressed copy if it negotiated compression
+    const std::shared_ptr<Bytebuffer>& Prepare(const ConnectionComponent& connection);
+
+    std::shared_ptr<Bytebuffer> _buffer;
+    std::shared_ptr<Bytebuffer> _compressedBuffer;
+    PacketCompression* _compression;
+    PacketPriority _priority;
+    bool _isCompressionAttempted = false;
+    u32 _recipientCount = 0;
+};
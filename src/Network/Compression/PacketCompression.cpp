@@ -0,0 +1,185 @@
+#include "PacketCompression.h"
+#include <chrono>
+#include <cstring>
+#include <Networking/NetworkPacket.h>
+#include <Networking/NetworkClient.h>
+#include <Utils/ByteBuffer.h>
+#include "../../ECS/Components/Network/ConnectionComponent.h"
+#include "../../Utils/LZ4Codec.h"
+#include "../../Utils/Metrics.h"
+#include "../Simulator/NetworkSimulator.h"
+
+constexpr size_t FRAME_HEADER_SIZE = sizeof(u16) + sizeof(u16);
+static_assert(NETWORK_BUFFER_SIZE <= PACKET_SIZE_MASK, "Payload sizes must leave the compressed flag free");
+
+PacketCompression::~PacketCompression()
+{
+    Stop();
+}
+
+void PacketCompression::Start(u16 threshold, u32 threadCount)
+{
+    _threshold = threshold;
+
+    if (_threshold > 0 && threadCount > 0)
+        _workers.Start(threadCount);
+}
+
+void PacketCompression::Stop()
+{
+    _workers.Stop();
+}
+
+void PacketCompression::Send(ConnectionComponent& connection, std::shared_ptr<Bytebuffer>& buffer)
+{
+    if (!connection.supportsCompression || !IsEnabled())
+    {
+        connection.outbound->AddSent(buffer->writtenData);
+        NetworkSimulator::Send(connection.connection, buffer);
+        return;
+    }
+
+    // Small buffers skip compression, but still have to queue behind the connection's earlier frames
+    std::shared_ptr<NetworkClient> client = connection.connection;
+    std::shared_ptr<OutboundBacklog> outbound = connection.outbound;
+    _workers.Submit(client->GetEntityId(), [this, client, outbound, buffer]() mutable
+    {
+        std::shared_ptr<Bytebuffer> compressedBuffer = Compress(buffer);
+        std::shared_ptr<Bytebuffer>& sentBuffer = compressedBuffer ? compressedBuffer : buffer;
+
+        outbound->AddSent(sentBuffer->writtenData);
+        NetworkSimulator::Send(client, sentBuffer);
+    });
+}
+
+void PacketCompression::SendPrepared(ConnectionComponent& connection, const std::shared_ptr<Bytebuffer>& buffer)
+{
+    connection.outbound->AddSent(buffer->writtenData);
+
+    if (!connection.supportsCompression || !IsEnabled())
+    {
+        NetworkSimulator::Send(connection.connection, buffer);
+        return;
+    }
+
+    std::shared_ptr<NetworkClient> client = connection.connection;
+    _workers.Submit(client->GetEntityId(), [client, buffer]() mutable
+    {
+        NetworkSimulator::Send(client, buffer);
+    });
+}
+
+std::shared_ptr<Bytebuffer> PacketCompression::Compress(const std::shared_ptr<Bytebuffer>& buffer)
+{
+    static std::atomic<i64>& framesMetric = Metrics::Get("compression.frames");
+    static std::atomic<i64>& bytesInMetric = Metrics::Get("compression.bytesIn");
+    static std::atomic<i64>& bytesOutMetric = Metrics::Get("compression.bytesOut");
+    static std::atomic<i64>& ratioMetric = Metrics::Get("compression.ratioPermille");
+    static std::atomic<i64>& costMetric = Metrics::Get("compression.costUs");
+
+    // Small buffers can't hold a frame worth compressing, and compressed frames are never larger than the original, so the original size bounds the output
+    if (buffer->writtenData < _threshold || buffer->writtenData > NETWORK_BUFFER_SIZE)
+        return nullptr;
+
+    thread_local LZ4Context context;
+    auto start = std::chrono::steady_clock::now();
+
+    std::shared_ptr<Bytebuffer> compressedBuffer = Bytebuffer::Borrow<NETWORK_BUFFER_SIZE>();
+    const u8* input = buffer->GetDataPointer();
+    u8* output = compressedBuffer->GetDataPointer();
+
+    size_t inputOffset = 0;
+    size_t outputOffset = 0;
+    i64 bytesIn = 0;
+    i64 bytesOut = 0;
+    u32 frameCount = 0;
+
+    // A buffer can hold several frames, only the ones worth compressing are touched
+    while (buffer->writtenData - inputOffset >= FRAME_HEADER_SIZE)
+    {
+        u16 payloadSize = 0;
+        std::memcpy(&payloadSize, input + inputOffset + sizeof(u16), sizeof(u16));
+
+        size_t frameSize = FRAME_HEADER_SIZE + payloadSize;
+        if (buffer->writtenData - inputOffset < frameSize)
+            return nullptr;
+
+        if (payloadSize >= _threshold)
+        {
+            u8* compressedFrame = output + outputOffset;
+            i32 capacity = static_cast<i32>(payloadSize) - static_cast<i32>(sizeof(u16));
+            i32 compressedSize = LZ4Codec::Compress(input + inputOffset + FRAME_HEADER_SIZE, payloadSize, compressedFrame + FRAME_HEADER_SIZE + sizeof(u16), capacity, context);
+
+            // Data that does not shrink is sent as it is
+            if (compressedSize > 0)
+            {
+                u16 compressedPayloadSize = static_cast<u16>(sizeof(u16) + compressedSize) | PACKET_COMPRESSED_FLAG;
+                std::memcpy(compressedFrame, input + inputOffset, sizeof(u16));
+                std::memcpy(compressedFrame + sizeof(u16), &compressedPayloadSize, sizeof(u16));
+                std::memcpy(compressedFrame + FRAME_HEADER_SIZE, &payloadSize, sizeof(u16));
+
+                inputOffset += frameSize;
+                outputOffset += FRAME_HEADER_SIZE + sizeof(u16) + compressedSize;
+
+                bytesIn += payloadSize;
+                bytesOut += sizeof(u16) + compressedSize;
+                frameCount++;
+                continue;
+            }
+        }
+
+        std::memcpy(output + outputOffset, input + inputOffset, frameSize);
+        inputOffset += frameSize;
+        outputOffset += frameSize;
+    }
+
+    auto duration = std::chrono::steady_clock::now() - start;
+    costMetric.fetch_add(std::chrono::duration_cast<std::chrono::microseconds>(duration).count(), std::memory_order_relaxed);
+
+    if (frameCount == 0)
+        return nullptr;
+
+    framesMetric.fetch_add(frameCount, std::memory_order_relaxed);
+    i64 totalBytesIn = bytesInMetric.fetch_add(bytesIn, std::memory_order_relaxed) + bytesIn;
+    i64 totalBytesOut = bytesOutMetric.fetch_add(bytesOut, std::memory_order_relaxed) + bytesOut;
+    ratioMetric.store(totalBytesOut * 1000 / totalBytesIn, std::memory_order_relaxed);
+
+    compressedBuffer->writtenData = outputOffset;
+    return compressedBuffer;
+}
+
+bool PacketCompression::Decompress(std::shared_ptr<NetworkPacket>& packet)
+{
+    static std::atomic<i64>& framesMetric = Metrics::Get("decompression.frames");
+    static std::atomic<i64>& costMetric = Metrics::Get("decompression.costUs");
+
+    u16 payloadSize = packet->header.size & PACKET_SIZE_MASK;
+    if (payloadSize < sizeof(u16) || !packet->payload)
+        return false;
+
+    const u8* input = packet->payload->GetDataPointer();
+
+    u16 uncompressedSize = 0;
+    std::memcpy(&uncompressedSize, input, sizeof(u16));
+
+    if (uncompressedSize > NETWORK_BUFFER_SIZE)
+        return false;
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::shared_ptr<Bytebuffer> payload = Bytebuffer::Borrow<NETWORK_BUFFER_SIZE>();
+    i32 decompressedSize = LZ4Codec::Decompress(input + sizeof(u16), payloadSize - sizeof(u16), payload->GetDataPointer(), uncompressedSize);
+    if (decompressedSize != uncompressedSize)
+        return false;
+
+    payload->size = uncompressedSize;
+    payload->writtenData = uncompressedSize;
+
+    packet->header.size = uncompressedSize;
+    packet->payload = payload;
+
+    auto duration = std::chrono::steady_clock::now() - start;
+    costMetric.fetch_add(std::chrono::duration_cast<std::chrono::microseconds>(duration).count(), std::memory_order_relaxed);
+    framesMetric.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
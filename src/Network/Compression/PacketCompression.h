@@ -0,0 +1,42 @@
+#pragma once
+#include <NovusTypes.h>
+#include <memory>
+#include <Networking/NetworkPacket.h>
+#include "../../Utils/WorkerPool.h"
+
+struct ConnectionComponent;
+
+// The high bit of a frame's size field marks an LZ4 compressed payload: a u16 holding the uncompressed size followed by the LZ4 block.
+// Payloads never come close to 32 KB, so the bit is otherwise always clear
+constexpr u16 PACKET_COMPRESSED_FLAG = 0x8000;
+constexpr u16 PACKET_SIZE_MASK = 0x7FFF;
+
+// Compression is negotiated per connection, a client opts in by sending a compressed frame of its own.
+// From then on every frame we send it of at least the threshold size is compressed on a worker thread,
+// frames for one connection always go through the same worker to keep them in order
+class PacketCompression
+{
+public:
+    ~PacketCompression();
+
+    // A threshold of 0 disables compressing outbound frames, compressed inbound frames are always accepted
+    void Start(u16 threshold, u32 threadCount);
+    void Stop();
+
+    bool IsEnabled() const { return _threshold > 0 && _workers.IsRunning(); }
+
+    void Send(ConnectionComponent& connection, std::shared_ptr<Bytebuffer>& buffer);
+
+    // Queues an already compressed, or deliberately uncompressed, buffer behind the connection's earlier frames without touching it
+    void SendPrepared(ConnectionComponent& connection, const std::shared_ptr<Bytebuffer>& buffer);
+
+    // Returns a copy of the buffer with every frame of at least the threshold size compressed, nullptr if no frame was worth it
+    std::shared_ptr<Bytebuffer> Compress(const std::shared_ptr<Bytebuffer>& buffer);
+
+    // Swaps a compressed packet's payload for the decompressed one, false if the payload is malformed
+    static bool Decompress(std::shared_ptr<NetworkPacket>& packet);
+
+private:
+    u16 _threshold = 0;
+    WorkerPool _workers;
+};
@@ -0,0 +1,74 @@
+#include "PacketFramer.h"
+#include <cstring>
+#include <Networking/NetworkPacket.h>
+#include <Utils/ByteBuffer.h>
+#include "../Compression/PacketCompression.h"
+#include "../Recording/PacketRecorder.h"
+#include "../../Utils/ServiceLocator.h"
+
+constexpr size_t FRAME_HEADER_SIZE = sizeof(u16) + sizeof(u16);
+
+bool PacketFramer::Receive(moodycamel::ConcurrentQueue<std::shared_ptr<NetworkPacket>>& packetQueue, std::vector<u8>& partialFrame, u32 connectionId, const u8* data, size_t size)
+{
+    if (partialFrame.empty())
+    {
+        i64 consumed = FramePackets(packetQueue, connectionId, data, size);
+        if (consumed < 0)
+            return false;
+
+        partialFrame.assign(data + consumed, data + size);
+        return true;
+    }
+
+    partialFrame.insert(partialFrame.end(), data, data + size);
+
+    i64 consumed = FramePackets(packetQueue, connectionId, partialFrame.data(), partialFrame.size());
+    if (consumed < 0)
+        return false;
+
+    partialFrame.erase(partialFrame.begin(), partialFrame.begin() + consumed);
+    return true;
+}
+
+i64 PacketFramer::FramePackets(moodycamel::ConcurrentQueue<std::shared_ptr<NetworkPacket>>& packetQueue, u32 connectionId, const u8* data, size_t size)
+{
+    PacketRecorder* packetRecorder = ServiceLocator::GetPacketRecorder();
+
+    size_t offset = 0;
+    while (size - offset >= FRAME_HEADER_SIZE)
+    {
+        u16 opcode = 0;
+        u16 sizeField = 0;
+        std::memcpy(&opcode, data + offset, sizeof(u16));
+        std::memcpy(&sizeField, data + offset + sizeof(u16), sizeof(u16));
+
+        // The compressed flag stays in the header, the payload is decompressed when the packet gets dispatched
+        u16 payloadSize = sizeField & PACKET_SIZE_MASK;
+        if (payloadSize > NETWORK_BUFFER_SIZE)
+            return -1;
+
+        if (size - offset - FRAME_HEADER_SIZE < payloadSize)
+            break;
+
+        const u8* payload = data + offset + FRAME_HEADER_SIZE;
+        if (packetRecorder)
+            packetRecorder->Record(connectionId, opcode, sizeField, payload);
+
+        std::shared_ptr<NetworkPacket> packet = NetworkPacket::Borrow();
+        packet->header.opcode = static_cast<Opcode>(opcode);
+        packet->header.size = sizeField;
+
+        if (payloadSize)
+        {
+            packet->payload = Bytebuffer::Borrow<NETWORK_BUFFER_SIZE>();
+            packet->payload->size = payloadSize;
+            packet->payload->writtenData = payloadSize;
+            std::memcpy(packet->payload->GetDataPointer(), payload, payloadSize);
+        }
+
+        packetQueue.enqueue(packet);
+        offset += FRAME_HEADER_SIZE + payloadSize;
+    }
+
+    return static_cast<i64>(offset);
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include <NovusTypes.h>
+#include <memory>
+#include <vector>
+#include <Utils/ConcurrentQueue.h>
+
+struct NetworkPacket;
+
+// Splits a TCP byte stream into pooled packets. Reads don't have to line up with frames,
+// the bytes of a frame split across reads are kept in partialFrame until the rest of it arrives
+class PacketFramer
+{
+public:
+    // Returns false on a malformed frame, the connection has to be closed then
+    static bool Receive(moodycamel::ConcurrentQueue<std::shared_ptr<NetworkPacket>>& packetQueue, std::vector<u8>& partialFrame, u32 connectionId, const u8* data, size_t size);
+
+private:
+    // Returns the number of bytes consumed by complete frames or -1 for a malformed frame
+    static i64 FramePackets(moodycamel::ConcurrentQueue<std::shared_ptr<NetworkPacket>>& packetQueue, u32 connectionId, const u8* data, size_t size);
+};
@@ -7,6 +7,10 @@
 #include <Networking/AddressType.h>
 #include "../../../Utils/ServiceLocator.h"
 #include "../../../ECS/Components/Network/ConnectionSingleton.h"
+#include "../../../ECS/Components/Network/ConnectionComponent.h"
+#include "../../../ECS/Components/Network/ConnectionDeferredSingleton.h"
+#include "../../../ECS/Components/Singletons/TimerSingleton.h"
+#include "../../Simulator/NetworkSimulator.h"
 
 namespace Client
 {
@@ -28,7 +32,13 @@ namespace Client
         // Send the buffer to the Novus Service
         entt::registry* registry = ServiceLocator::GetRegistry();
         auto& connection = registry->ctx<ConnectionSingleton>();
-        connection.networkClient->Send(buffer);
+        NetworkSimulator::Send(connection.networkClient, buffer);
+
+        // A request that is already waiting keeps its deadline, the answer to either one settles it
+        f32 timeout = registry->ctx<ConnectionDeferredSingleton>().upstreamRequestTimeout;
+        ConnectionComponent& connectionComponent = registry->get<ConnectionComponent>(networkClient->GetEntity());
+        if (timeout > 0.0f && connectionComponent.upstreamRequestTimer == 0)
+            connectionComponent.upstreamRequestTimer = registry->ctx<TimerSingleton>().Schedule(timeout, TimerType::UPSTREAM_REQUEST, networkClient->GetEntity());
 
         return true;
     }
@@ -1,4 +1,5 @@
 #include "AuthHandlers.h"
+#include <chrono>
 #include <entt.hpp>
 #include <Networking/NetworkPacket.h>
 #include <Networking/MessageHandler.h>
@@ -6,19 +7,60 @@
 #include <Networking/AddressType.h>
 #include <Utils/ByteBuffer.h>
 #include "../../../../Utils/ServiceLocator.h"
+#include "../../../../Utils/Metrics.h"
 #include "../../../../ECS/Components/Network/AuthenticationSingleton.h"
 #include "../../../../ECS/Components/Network/ConnectionDeferredSingleton.h"
-
-// @TODO: Remove Temporary Includes when they're no longer needed
-#include <Utils/DebugHandler.h>
+#include "../../../Simulator/NetworkSimulator.h"
+#include "../../../../EngineLoop.h"
 
 namespace InternalSocket
 {
+    // There is a single SRPUser, so every step is submitted with the same key and they never overlap
+    constexpr u32 AUTHENTICATION_JOB_KEY = 0;
+
+    template <typename Step>
+    static void SubmitStep(AuthenticationSingleton& authentication, std::shared_ptr<NetworkClient> networkClient, AuthenticationStep step, Step&& math)
+    {
+        static std::atomic<i64>& stepsMetric = Metrics::Get("authentication.steps");
+        static std::atomic<i64>& costMetric = Metrics::Get("authentication.costUs");
+
+        auto job = [&authentication, networkClient, step, math = std::forward<Step>(math)]() mutable
+        {
+            auto start = std::chrono::steady_clock::now();
+            bool succeeded = math(authentication.srp);
+
+            auto duration = std::chrono::steady_clock::now() - start;
+            costMetric.fetch_add(std::chrono::duration_cast<std::chrono::microseconds>(duration).count(), std::memory_order_relaxed);
+            stepsMetric.fetch_add(1, std::memory_order_relaxed);
+
+            authentication.results.enqueue({ std::move(networkClient), step, succeeded });
+        };
+
+        if (authentication.workers.IsRunning())
+            authentication.workers.Submit(AUTHENTICATION_JOB_KEY, std::move(job));
+        else
+            job();
+    }
+
     void AuthHandlers::Setup(MessageHandler* messageHandler)
     {
         messageHandler->SetMessageHandler(Opcode::SMSG_LOGON_CHALLENGE, { ConnectionStatus::AUTH_CHALLENGE, sizeof(ServerLogonChallenge), AuthHandlers::HandshakeHandler });
         messageHandler->SetMessageHandler(Opcode::SMSG_LOGON_HANDSHAKE, { ConnectionStatus::AUTH_HANDSHAKE, sizeof(ServerLogonHandshake), AuthHandlers::HandshakeResponseHandler });
     }
+    void AuthHandlers::StartAuthentication(std::shared_ptr<NetworkClient> networkClient)
+    {
+        entt::registry* registry = ServiceLocator::GetRegistry();
+        AuthenticationSingleton& authenticationSingleton = registry->ctx<AuthenticationSingleton>();
+
+        SubmitStep(authenticationSingleton, std::move(networkClient), AuthenticationStep::START, [](SRPUser& srp)
+        {
+            srp.username = "region";
+            srp.password = "password";
+
+            // If StartAuthentication fails, it means A failed to generate and thus we cannot connect
+            return srp.StartAuthentication();
+        });
+    }
     bool AuthHandlers::HandshakeHandler(std::shared_ptr<NetworkClient> networkClient, std::shared_ptr<NetworkPacket>& packet)
     {
         ServerLogonChallenge logonChallenge;
@@ -27,13 +69,50 @@ namespace InternalSocket
         entt::registry* registry = ServiceLocator::GetRegistry();
         AuthenticationSingleton& authenticationSingleton = registry->ctx<AuthenticationSingleton>();
 
-        // If "ProcessChallenge" fails, we have either hit a bad memory allocation or a SRP-6a safety check, thus we should close the connection
-        if (!authenticationSingleton.srp.ProcessChallenge(logonChallenge.s, logonChallenge.B))
+        SubmitStep(authenticationSingleton, std::move(networkClient), AuthenticationStep::CHALLENGE, [logonChallenge](SRPUser& srp) mutable
         {
-            networkClient->Close(asio::error::no_data);
-            return true;
-        }
+            return srp.ProcessChallenge(logonChallenge.s, logonChallenge.B);
+        });
+        return true;
+    }
+    bool AuthHandlers::HandshakeResponseHandler(std::shared_ptr<NetworkClient> networkClient, std::shared_ptr<NetworkPacket>& packet)
+    {
+        // Handle handshake response
+        ServerLogonHandshake logonResponse;
+        logonResponse.Deserialize(packet->payload);
+
+        entt::registry* registry = ServiceLocator::GetRegistry();
+        AuthenticationSingleton& authenticationSingleton = registry->ctx<AuthenticationSingleton>();
+
+        SubmitStep(authenticationSingleton, std::move(networkClient), AuthenticationStep::VERIFY, [logonResponse](SRPUser& srp) mutable
+        {
+            return srp.VerifySession(logonResponse.HAMK);
+        });
+        return true;
+    }
 
+    static void SendLogonChallenge(AuthenticationSingleton& authenticationSingleton, std::shared_ptr<NetworkClient>& networkClient)
+    {
+        /* Send Initial Packet */
+        std::shared_ptr<Bytebuffer> buffer = Bytebuffer::Borrow<512>();
+
+        buffer->Put(Opcode::CMSG_LOGON_CHALLENGE);
+        buffer->SkipWrite(sizeof(u16));
+
+        u16 size = static_cast<u16>(buffer->writtenData);
+        buffer->PutString(authenticationSingleton.srp.username);
+        buffer->PutBytes(authenticationSingleton.srp.aBuffer->GetDataPointer(), authenticationSingleton.srp.aBuffer->size);
+
+        u16 writtenData = static_cast<u16>(buffer->writtenData) - size;
+
+        buffer->Put<u16>(writtenData, 2);
+        NetworkSimulator::Send(networkClient, buffer);
+
+        networkClient->SetStatus(ConnectionStatus::AUTH_CHALLENGE);
+        networkClient->AsyncRead();
+    }
+    static void SendLogonHandshake(AuthenticationSingleton& authenticationSingleton, std::shared_ptr<NetworkClient>& networkClient)
+    {
         std::shared_ptr<Bytebuffer> buffer = Bytebuffer::Borrow<36>();
         ClientLogonHandshake clientResponse;
 
@@ -44,46 +123,65 @@ namespace InternalSocket
 
         u16 payloadSize = clientResponse.Serialize(buffer);
         buffer->Put<u16>(payloadSize, 2);
-        networkClient->Send(buffer);
+        NetworkSimulator::Send(networkClient, buffer);
 
         networkClient->SetStatus(ConnectionStatus::AUTH_HANDSHAKE);
-        return true;
     }
-    bool AuthHandlers::HandshakeResponseHandler(std::shared_ptr<NetworkClient> networkClient, std::shared_ptr<NetworkPacket>& packet)
+    static void SendConnected(ConnectionDeferredSingleton& connectionDeferredSingleton, std::shared_ptr<NetworkClient>& networkClient)
     {
-        // Handle handshake response
-        ServerLogonHandshake logonResponse;
-        logonResponse.Deserialize(packet->payload);
-
-        entt::registry* registry = ServiceLocator::GetRegistry();
-        AuthenticationSingleton& authenticationSingleton = registry->ctx<AuthenticationSingleton>();
-        ConnectionDeferredSingleton& connectionDeferredSingleton = registry->ctx<ConnectionDeferredSingleton>();
-
-        if (!authenticationSingleton.srp.VerifySession(logonResponse.HAMK))
-        {
-            DebugHandler::PrintWarning("Unsuccessful Login");
-            networkClient->Close(asio::error::no_permission);
-            return true;
-        }
-        else
-        {
-            DebugHandler::PrintSuccess("Successful Login");
-        }
-
         std::shared_ptr<Bytebuffer> buffer = Bytebuffer::Borrow<128>();
         buffer->Put(Opcode::CMSG_CONNECTED);
         buffer->PutU16(8);
         buffer->Put(AddressType::REGION);
         buffer->PutU8(0);
 
-        std::shared_ptr<NetworkServer> server = connectionDeferredSingleton.networkServer;
+        // The listening port can belong to the io_uring backend rather than NetworkServer, so we advertise the configured one
         auto localEndpoint = networkClient->socket()->local_endpoint();
         buffer->PutU32(localEndpoint.address().to_v4().to_uint());
-        buffer->PutU16(server->GetPort());
+        buffer->PutU16(connectionDeferredSingleton.listenPort);
 
-        networkClient->Send(buffer);
+        NetworkSimulator::Send(networkClient, buffer);
 
         networkClient->SetStatus(ConnectionStatus::AUTH_SUCCESS);
-        return true;
     }
-}
\ No newline at end of file
+
+    void AuthHandlers::ApplyCompletedSteps(entt::registry& registry)
+    {
+        AuthenticationSingleton& authenticationSingleton = registry.ctx<AuthenticationSingleton>();
+
+        AuthenticationResult result;
+        while (authenticationSingleton.results.try_dequeue(result))
+        {
+            switch (result.step)
+            {
+                case AuthenticationStep::START:
+                    authenticationSingleton.isAuthenticated = false;
+                    if (result.succeeded)
+                        SendLogonChallenge(authenticationSingleton, result.networkClient);
+                    break;
+
+                case AuthenticationStep::CHALLENGE:
+                    // If "ProcessChallenge" fails, we have either hit a bad memory allocation or a SRP-6a safety check, thus we should close the connection
+                    if (result.succeeded)
+                        SendLogonHandshake(authenticationSingleton, result.networkClient);
+                    else
+                        result.networkClient->Close(asio::error::no_data);
+                    break;
+
+                case AuthenticationStep::VERIFY:
+                    if (result.succeeded)
+                    {
+                        ServiceLocator::GetEngineLoop()->PrintMessage("Successful Login");
+                        authenticationSingleton.isAuthenticated = true;
+                        SendConnected(registry.ctx<ConnectionDeferredSingleton>(), result.networkClient);
+                    }
+                    else
+                    {
+                        ServiceLocator::GetEngineLoop()->PrintMessage("Unsuccessful Login");
+                        result.networkClient->Close(asio::error::no_permission);
+                    }
+                    break;
+            }
+        }
+    }
+}
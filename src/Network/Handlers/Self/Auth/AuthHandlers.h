@@ -1,16 +1,22 @@
 #pragma once
 #include <memory>
+#include <entity/fwd.hpp>
 
 class MessageHandler;
 class NetworkClient;
 struct NetworkPacket;
 namespace InternalSocket
 {
+    // The SRP math runs on AuthenticationSingleton's workers, the handlers only submit it and the tick applies what came of it
     class AuthHandlers
     {
     public:
         static void Setup(MessageHandler*);
+        static void StartAuthentication(std::shared_ptr<NetworkClient>);
         static bool HandshakeHandler(std::shared_ptr<NetworkClient>, std::shared_ptr<NetworkPacket>&);
         static bool HandshakeResponseHandler(std::shared_ptr<NetworkClient>, std::shared_ptr<NetworkPacket>&);
+
+        // Sends what the finished steps produced, tick thread only
+        static void ApplyCompletedSteps(entt::registry& registry);
     };
-}
\ No newline at end of file
+}
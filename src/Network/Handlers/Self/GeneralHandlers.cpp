@@ -7,6 +7,8 @@
 #include <Networking/AddressType.h>
 #include "../../../Utils/ServiceLocator.h"
 #include "../../../ECS/Components/Network/ConnectionComponent.h"
+#include "../../../ECS/Components/Singletons/TimerSingleton.h"
+#include "../../../ECS/Systems/Network/ConnectionSystems.h"
 
 namespace InternalSocket
 {
@@ -49,7 +51,8 @@ namespace InternalSocket
 
         entt::registry* registry = ServiceLocator::GetRegistry();
         auto& connectionComponent = registry->get<ConnectionComponent>(entity);
-        connectionComponent.connection->Send(buffer);
+        registry->ctx<TimerSingleton>().Cancel(connectionComponent.upstreamRequestTimer);
+        ConnectionUpdateSystem::Send(*registry, entity, buffer, PacketPriority::HIGH);
         return true;
     }
 }
\ No newline at end of file
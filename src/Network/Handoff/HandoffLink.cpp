@@ -0,0 +1,310 @@
+#include "HandoffLink.h"
+#include <cstring>
+#include "../../Utils/ServiceLocator.h"
+#include "../../EngineLoop.h"
+
+constexpr u32 HANDOFF_RECONNECT_SECONDS = 2;
+constexpr u32 HANDOFF_ACCEPT_BACKOFF_SECONDS = 1;
+
+static std::vector<u8> BuildFrame(HandoffMessageType type, const u8* payload, size_t size)
+{
+    HandoffFrameHeader header;
+    header.type = type;
+    header.size = static_cast<u32>(size);
+
+    std::vector<u8> frame(sizeof(HandoffFrameHeader) + size);
+    std::memcpy(frame.data(), &header, sizeof(HandoffFrameHeader));
+    if (size > 0)
+        std::memcpy(frame.data() + sizeof(HandoffFrameHeader), payload, size);
+
+    return frame;
+}
+
+HandoffLink::HandoffLink(std::shared_ptr<asio::io_service> asioService, u16 clientPort) : _asioService(asioService), _clientPort(clientPort), _messages(64), _requests(8)
+{
+    _reconnectTimer = std::make_unique<asio::steady_timer>(*_asioService);
+    _acceptTimer = std::make_unique<asio::steady_timer>(*_asioService);
+}
+
+HandoffLink::~HandoffLink()
+{
+}
+
+bool HandoffLink::Listen(u16 port)
+{
+    asio::error_code error;
+    asio::ip::tcp::endpoint endpoint(asio::ip::tcp::v4(), port);
+
+    _acceptor = std::make_unique<asio::ip::tcp::acceptor>(*_asioService);
+    _acceptor->open(endpoint.protocol(), error);
+    if (!error)
+        _acceptor->set_option(asio::ip::tcp::acceptor::reuse_address(true), error);
+    if (!error)
+        _acceptor->bind(endpoint, error);
+    if (!error)
+        _acceptor->listen(asio::socket_base::max_connections, error);
+
+    if (error)
+    {
+        ServiceLocator::GetEngineLoop()->PrintMessage("[Handoff]: Failed to listen on port %u (%s)", port, error.message().c_str());
+        _acceptor.reset();
+        return false;
+    }
+
+    asio::post(*_asioService, [this, self = shared_from_this()]() { Accept(); });
+    return true;
+}
+
+void HandoffLink::Connect(const std::string& host, u16 port)
+{
+    _peerHost = host;
+    _peerPort = port;
+
+    asio::post(*_asioService, [this, self = shared_from_this()]() { StartConnect(); });
+}
+
+void HandoffLink::Close()
+{
+    // Whatever is still pending completes with operation_aborted and lets go of the link
+    asio::post(*_asioService, [this, self = shared_from_this()]()
+    {
+        _isClosed = true;
+
+        asio::error_code error;
+        if (_acceptor)
+            _acceptor->close(error);
+
+        _reconnectTimer->cancel(error);
+        _acceptTimer->cancel(error);
+
+        for (auto& session : _sessions)
+        {
+            session.second->socket.close(error);
+        }
+    });
+}
+
+void HandoffLink::Send(u32 linkId, HandoffMessageType type, const u8* payload, size_t size)
+{
+    std::vector<u8> frame = BuildFrame(type, payload, size);
+    asio::post(*_asioService, [this, self = shared_from_this(), linkId, frame = std::move(frame)]() mutable
+    {
+        auto itr = _sessions.find(linkId);
+        if (itr != _sessions.end())
+            Write(itr->second, std::move(frame));
+    });
+}
+
+void HandoffLink::Accept()
+{
+    std::shared_ptr<Session> session = std::make_shared<Session>(*_asioService);
+    _acceptor->async_accept(session->socket, [this, self = shared_from_this(), session](const asio::error_code& error)
+    {
+        if (_isClosed)
+            return;
+
+        if (!error)
+        {
+            StartSession(session);
+
+            // The connecting region needs our client port before it can redirect anyone here
+            Write(session, BuildFrame(HandoffMessageType::HELLO, reinterpret_cast<const u8*>(&_clientPort), sizeof(u16)));
+
+            Accept();
+            return;
+        }
+
+        // The peer gave up while it was still queued, the next one is unaffected
+        if (error == asio::error::connection_aborted || error == asio::error::try_again || error == asio::error::interrupted)
+        {
+            Accept();
+            return;
+        }
+
+        // Out of descriptors or memory, accepting again right away would only fail the same way
+        if (error == asio::error::no_descriptors || error == asio::error::no_buffer_space || error == asio::error::no_memory)
+        {
+            ServiceLocator::GetEngineLoop()->PrintMessage("[Handoff]: Failed to accept (%s), retrying in %u seconds", error.message().c_str(), HANDOFF_ACCEPT_BACKOFF_SECONDS);
+
+            _acceptTimer->expires_after(std::chrono::seconds(HANDOFF_ACCEPT_BACKOFF_SECONDS));
+            _acceptTimer->async_wait([this, self](const asio::error_code& timerError)
+            {
+                if (!timerError && !_isClosed)
+                    Accept();
+            });
+            return;
+        }
+
+        ServiceLocator::GetEngineLoop()->PrintMessage("[Handoff]: Stopped accepting handoffs (%s)", error.message().c_str());
+    });
+}
+
+void HandoffLink::StartConnect()
+{
+    if (_isClosed)
+        return;
+
+    asio::error_code error;
+    asio::ip::address address = asio::ip::make_address(_peerHost, error);
+    if (error)
+    {
+        ServiceLocator::GetEngineLoop()->PrintMessage("[Handoff]: (%s) is not a valid peer address", _peerHost.c_str());
+        return;
+    }
+
+    std::shared_ptr<Session> session = std::make_shared<Session>(*_asioService);
+    session->isOutgoing = true;
+
+    session->socket.async_connect(asio::ip::tcp::endpoint(address, _peerPort), [this, self = shared_from_this(), session](const asio::error_code& error)
+    {
+        if (error)
+        {
+            RetryConnect();
+            return;
+        }
+
+        StartSession(session);
+    });
+}
+
+void HandoffLink::RetryConnect()
+{
+    if (_isClosed)
+        return;
+
+    _reconnectTimer->expires_after(std::chrono::seconds(HANDOFF_RECONNECT_SECONDS));
+    _reconnectTimer->async_wait([this, self = shared_from_this()](const asio::error_code& error)
+    {
+        if (!error)
+            StartConnect();
+    });
+}
+
+void HandoffLink::StartSession(std::shared_ptr<Session> session)
+{
+    asio::error_code error;
+    session->socket.set_option(asio::ip::tcp::no_delay(true), error);
+
+    session->linkId = _nextLinkId++;
+    _sessions[session->linkId] = session;
+
+    ReadHeader(session);
+}
+
+void HandoffLink::ReadHeader(std::shared_ptr<Session> session)
+{
+    asio::async_read(session->socket, asio::buffer(&session->header, sizeof(HandoffFrameHeader)), [this, self = shared_from_this(), session](const asio::error_code& error, size_t) mutable
+    {
+        if (error || session->header.size > HANDOFF_MAX_MESSAGE_SIZE)
+        {
+            Drop(session);
+            return;
+        }
+
+        session->body.resize(session->header.size);
+        if (session->header.size == 0)
+        {
+            HandleMessage(session);
+            ReadHeader(session);
+            return;
+        }
+
+        ReadBody(session);
+    });
+}
+
+void HandoffLink::ReadBody(std::shared_ptr<Session> session)
+{
+    asio::async_read(session->socket, asio::buffer(session->body), [this, self = shared_from_this(), session](const asio::error_code& error, size_t) mutable
+    {
+        if (error)
+        {
+            Drop(session);
+            return;
+        }
+
+        HandleMessage(session);
+        ReadHeader(session);
+    });
+}
+
+void HandoffLink::HandleMessage(std::shared_ptr<Session>& session)
+{
+    if (session->header.type == HandoffMessageType::HELLO)
+    {
+        if (!session->isOutgoing || session->body.size() < sizeof(u16))
+            return;
+
+        u16 clientPort = 0;
+        std::memcpy(&clientPort, session->body.data(), sizeof(u16));
+
+        // Clients reach the peer on the same address we do
+        asio::error_code error;
+        asio::ip::tcp::endpoint endpoint = session->socket.remote_endpoint(error);
+        if (error || !endpoint.address().is_v4())
+            return;
+
+        _peerClientAddress.store(endpoint.address().to_v4().to_uint(), std::memory_order_relaxed);
+        _peerClientPort.store(clientPort, std::memory_order_relaxed);
+        _peerLinkId.store(session->linkId, std::memory_order_release);
+
+        ServiceLocator::GetEngineLoop()->PrintMessage("[Handoff]: Linked to peer region (%s:%u), its clients connect on port %u", _peerHost.c_str(), _peerPort, clientPort);
+        return;
+    }
+
+    HandoffMessage message;
+    message.linkId = session->linkId;
+    message.type = session->header.type;
+    message.payload = std::move(session->body);
+    _messages.enqueue(std::move(message));
+}
+
+void HandoffLink::Write(std::shared_ptr<Session> session, std::vector<u8>&& frame)
+{
+    session->writeQueue.push_back(std::move(frame));
+    if (!session->isWriting)
+        WriteNext(session);
+}
+
+void HandoffLink::WriteNext(std::shared_ptr<Session> session)
+{
+    session->isWriting = true;
+    asio::async_write(session->socket, asio::buffer(session->writeQueue.front()), [this, self = shared_from_this(), session](const asio::error_code& error, size_t) mutable
+    {
+        if (error)
+        {
+            Drop(session);
+            return;
+        }
+
+        session->writeQueue.pop_front();
+        if (session->writeQueue.empty())
+            session->isWriting = false;
+        else
+            WriteNext(session);
+    });
+}
+
+void HandoffLink::Drop(std::shared_ptr<Session>& session)
+{
+    // Reads and writes both fail once a socket breaks, only the first one gets to drop it
+    if (_sessions.erase(session->linkId) == 0)
+        return;
+
+    asio::error_code error;
+    session->socket.close(error);
+
+    if (_peerLinkId.load(std::memory_order_relaxed) == session->linkId)
+        _peerLinkId.store(0, std::memory_order_release);
+
+    HandoffMessage message;
+    message.linkId = session->linkId;
+    message.type = HandoffMessageType::DISCONNECTED;
+    _messages.enqueue(std::move(message));
+
+    if (session->isOutgoing)
+    {
+        ServiceLocator::GetEngineLoop()->PrintMessage("[Handoff]: Lost the link to peer region (%s:%u)", _peerHost.c_str(), _peerPort);
+        RetryConnect();
+    }
+}
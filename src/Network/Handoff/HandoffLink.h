@@ -0,0 +1,98 @@
+#pragma once
+#include <NovusTypes.h>
+#include <memory>
+#include <atomic>
+#include <string>
+#include <deque>
+#include <vector>
+#include <unordered_map>
+#include <asio.hpp>
+#include <Utils/ConcurrentQueue.h>
+#include "HandoffProtocol.h"
+
+struct HandoffMessage
+{
+    u32 linkId;
+    HandoffMessageType type;
+    std::vector<u8> payload;
+};
+
+// Dedicated TCP link between region processes used to hand entities off. Every region listens for the peers
+// handing entities to it and keeps one outgoing link to the peer it hands its own entities to.
+// All socket work happens on the io service, the tick talks to it through thread safe queues.
+// Every handler holds a reference to the link, so it stays alive until Close drained them
+class HandoffLink : public std::enable_shared_from_this<HandoffLink>
+{
+public:
+    HandoffLink(std::shared_ptr<asio::io_service> asioService, u16 clientPort);
+    ~HandoffLink();
+
+    bool Listen(u16 port);
+
+    // Keeps reconnecting until the peer is reachable
+    void Connect(const std::string& host, u16 port);
+    void Close();
+
+    // Safe to call from any thread, the payload is copied into the frame so it may live in frame memory
+    void Send(u32 linkId, HandoffMessageType type, const u8* payload, size_t size);
+    bool TryGetMessage(HandoffMessage& message) { return _messages.try_dequeue(message); }
+
+    // Handoffs requested from outside the tick, for example by the console
+    void RequestHandoff(u32 count) { _requests.enqueue(count); }
+    bool TryGetRequest(u32& count) { return _requests.try_dequeue(count); }
+
+    // The outgoing link is ready once the peer told us where its clients connect
+    bool IsPeerReady() const { return _peerLinkId.load(std::memory_order_acquire) != 0; }
+    u32 GetPeerLinkId() const { return _peerLinkId.load(std::memory_order_acquire); }
+    u32 GetPeerClientAddress() const { return _peerClientAddress.load(std::memory_order_relaxed); }
+    u16 GetPeerClientPort() const { return _peerClientPort.load(std::memory_order_relaxed); }
+
+private:
+    struct Session
+    {
+        Session(asio::io_service& asioService) : socket(asioService) { }
+
+        asio::ip::tcp::socket socket;
+        u32 linkId = 0;
+        bool isOutgoing = false;
+
+        HandoffFrameHeader header;
+        std::vector<u8> body;
+
+        std::deque<std::vector<u8>> writeQueue;
+        bool isWriting = false;
+    };
+
+    void Accept();
+    void StartConnect();
+    void RetryConnect();
+    void StartSession(std::shared_ptr<Session> session);
+    void ReadHeader(std::shared_ptr<Session> session);
+    void ReadBody(std::shared_ptr<Session> session);
+    void HandleMessage(std::shared_ptr<Session>& session);
+    void Write(std::shared_ptr<Session> session, std::vector<u8>&& frame);
+    void WriteNext(std::shared_ptr<Session> session);
+    void Drop(std::shared_ptr<Session>& session);
+
+private:
+    std::shared_ptr<asio::io_service> _asioService;
+    std::unique_ptr<asio::ip::tcp::acceptor> _acceptor;
+    std::unique_ptr<asio::steady_timer> _reconnectTimer;
+    std::unique_ptr<asio::steady_timer> _acceptTimer;
+    u16 _clientPort;
+
+    std::string _peerHost;
+    u16 _peerPort = 0;
+    bool _isClosed = false;
+
+    // Only touched on the io service
+    std::unordered_map<u32, std::shared_ptr<Session>> _sessions;
+    u32 _nextLinkId = 1;
+
+    std::atomic<u32> _peerLinkId{ 0 };
+    std::atomic<u32> _peerClientAddress{ 0 };
+    std::atomic<u16> _peerClientPort{ 0 };
+
+    moodycamel::ConcurrentQueue<HandoffMessage> _messages;
+    moodycamel::ConcurrentQueue<u32> _requests;
+};
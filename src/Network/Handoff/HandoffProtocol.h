@@ -0,0 +1,23 @@
+#pragma once
+#include <NovusTypes.h>
+
+// Every message on the inter-region link is a HandoffFrameHeader followed by size bytes of payload
+enum class HandoffMessageType : u16
+{
+    HELLO, // u16 client port, sent by the accepting region so the connecting one knows where to redirect clients
+    BATCH, // u32 count, then per entity: u64 token and the entity's EntityBlob
+    ACCEPT, // u32 count, then per entity: u64 token, u8 accepted
+    PACKETS, // u64 token, then client frames exactly as they were received
+    DISCONNECTED // Never sent, queued locally when a link drops
+};
+
+#pragma pack(push, 1)
+struct HandoffFrameHeader
+{
+    HandoffMessageType type;
+    u32 size;
+};
+#pragma pack(pop)
+
+// Batches of a few thousand entities stay far below this, anything larger is a broken peer
+constexpr u32 HANDOFF_MAX_MESSAGE_SIZE = 64 * 1024 * 1024;
@@ -0,0 +1,392 @@
+#include "IoUringBackend.h"
+
+#ifdef NC_REGION_IO_URING
+#include <cstring>
+#include <vector>
+#include <unordered_map>
+#include <entt.hpp>
+#include <liburing.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#include <Networking/NetworkClient.h>
+#include <Networking/NetworkPacket.h>
+#include "../../Utils/Metrics.h"
+#include "../../Utils/ServiceLocator.h"
+#include "../../Utils/ThreadAffinity.h"
+#include "../Framing/PacketFramer.h"
+#include "../Simulator/NetworkSimulator.h"
+#include "../../ECS/Components/Network/ConnectionComponent.h"
+#include "../../ECS/Systems/Network/ConnectionSystems.h"
+#include "../../EngineLoop.h"
+
+constexpr u32 IO_URING_QUEUE_DEPTH = 4096;
+constexpr u16 IO_URING_BUFFER_GROUP = 0;
+constexpr u32 IO_URING_BUFFER_COUNT = 4096; // Must be a power of two
+constexpr u32 IO_URING_BUFFER_SIZE = NETWORK_BUFFER_SIZE;
+
+// user_data layout: [operation:8][generation:24][fd:32], the generation keeps completions for a closed fd from reaching whoever reuses it
+enum class IoUringOperation : u8
+{
+    ACCEPT = 1,
+    RECV = 2,
+    WAKE = 3,
+    CANCEL = 4
+};
+
+static u64 EncodeUserData(IoUringOperation operation, u32 generation, i32 fd)
+{
+    return (static_cast<u64>(operation) << 56) | (static_cast<u64>(generation & 0xFFFFFF) << 32) | static_cast<u32>(fd);
+}
+
+struct IoUringConnection
+{
+    std::shared_ptr<NetworkClient> client;
+    u32 entityId = 0;
+    u32 generation = 0;
+    std::vector<u8> partialFrame; // Bytes of a frame that was split across completions
+};
+
+struct IoUringState
+{
+    io_uring ring;
+    io_uring_buf_ring* bufferRing = nullptr;
+    u8* buffers = nullptr;
+
+    i32 listenFd = -1;
+    bool isAcceptArmed = false;
+    i32 wakeFd = -1;
+    u64 wakeValue = 0;
+    u32 nextGeneration = 1;
+
+    std::unordered_map<i32, IoUringConnection> connections;
+    std::unordered_map<u32, i32> connectionFds; // Entity id to fd, a closed socket no longer knows its fd
+};
+
+IoUringBackend::IoUringBackend(std::shared_ptr<asio::io_service> asioService) : _asioService(asioService), _pendingConnections(64), _removedConnections(64) { }
+
+IoUringBackend::~IoUringBackend()
+{
+    Stop();
+}
+
+bool IoUringBackend::Start(u16 port)
+{
+    std::unique_ptr<IoUringState> state = std::make_unique<IoUringState>();
+
+    if (io_uring_queue_init(IO_URING_QUEUE_DEPTH, &state->ring, 0) < 0)
+        return false;
+
+    i32 result = 0;
+    state->bufferRing = io_uring_setup_buf_ring(&state->ring, IO_URING_BUFFER_COUNT, IO_URING_BUFFER_GROUP, 0, &result);
+    if (!state->bufferRing)
+    {
+        io_uring_queue_exit(&state->ring);
+        return false;
+    }
+
+    // Every completion borrows one of these, it is handed back to the ring as soon as its frames are copied into the packet pool
+    state->buffers = new u8[static_cast<size_t>(IO_URING_BUFFER_COUNT) * IO_URING_BUFFER_SIZE];
+    for (u32 i = 0; i < IO_URING_BUFFER_COUNT; i++)
+    {
+        io_uring_buf_ring_add(state->bufferRing, state->buffers + static_cast<size_t>(i) * IO_URING_BUFFER_SIZE, IO_URING_BUFFER_SIZE, static_cast<u16>(i), io_uring_buf_ring_mask(IO_URING_BUFFER_COUNT), i);
+    }
+    io_uring_buf_ring_advance(state->bufferRing, IO_URING_BUFFER_COUNT);
+
+    state->listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    i32 reuseAddress = 1;
+    setsockopt(state->listenFd, SOL_SOCKET, SO_REUSEADDR, &reuseAddress, sizeof(reuseAddress));
+
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+
+    if (bind(state->listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || listen(state->listenFd, SOMAXCONN) < 0)
+    {
+        ServiceLocator::GetEngineLoop()->PrintMessage("[IoUring]: Failed to listen on port %u", port);
+        close(state->listenFd);
+        io_uring_free_buf_ring(&state->ring, state->bufferRing, IO_URING_BUFFER_COUNT, IO_URING_BUFFER_GROUP);
+        io_uring_queue_exit(&state->ring);
+        delete[] state->buffers;
+        return false;
+    }
+
+    state->wakeFd = eventfd(0, EFD_CLOEXEC);
+    if (state->wakeFd < 0)
+    {
+        ServiceLocator::GetEngineLoop()->PrintMessage("[IoUring]: Failed to create the wake eventfd");
+        close(state->listenFd);
+        io_uring_free_buf_ring(&state->ring, state->bufferRing, IO_URING_BUFFER_COUNT, IO_URING_BUFFER_GROUP);
+        io_uring_queue_exit(&state->ring);
+        delete[] state->buffers;
+        return false;
+    }
+
+    _state = std::move(state);
+    _isRunning = true;
+    _thread = std::thread(&IoUringBackend::Run, this);
+    return true;
+}
+
+void IoUringBackend::Stop()
+{
+    if (!_isRunning.exchange(false))
+        return;
+
+    eventfd_write(_state->wakeFd, 1);
+    _thread.join();
+
+    close(_state->listenFd);
+    close(_state->wakeFd);
+    io_uring_free_buf_ring(&_state->ring, _state->bufferRing, IO_URING_BUFFER_COUNT, IO_URING_BUFFER_GROUP);
+    io_uring_queue_exit(&_state->ring);
+    delete[] _state->buffers;
+    _state.reset();
+}
+
+void IoUringBackend::StartAccepting()
+{
+    _isAccepting = true;
+    eventfd_write(_state->wakeFd, 1);
+}
+
+void IoUringBackend::AddConnection(std::shared_ptr<NetworkClient> client, u32 entityId)
+{
+    _pendingConnections.enqueue({ client, entityId });
+    eventfd_write(_state->wakeFd, 1);
+}
+
+void IoUringBackend::RemoveConnection(u32 entityId)
+{
+    _removedConnections.enqueue(entityId);
+    eventfd_write(_state->wakeFd, 1);
+}
+
+static io_uring_sqe* GetSqe(io_uring* ring)
+{
+    // A full submission queue is flushed early rather than dropping the request
+    io_uring_sqe* sqe = io_uring_get_sqe(ring);
+    while (!sqe)
+    {
+        io_uring_submit(ring);
+        sqe = io_uring_get_sqe(ring);
+    }
+    return sqe;
+}
+
+static void ArmAccept(IoUringState& state)
+{
+    io_uring_sqe* sqe = GetSqe(&state.ring);
+    io_uring_prep_multishot_accept(sqe, state.listenFd, nullptr, nullptr, SOCK_NONBLOCK);
+    io_uring_sqe_set_data64(sqe, EncodeUserData(IoUringOperation::ACCEPT, 0, state.listenFd));
+}
+
+static void ArmWake(IoUringState& state)
+{
+    io_uring_sqe* sqe = GetSqe(&state.ring);
+    io_uring_prep_read(sqe, state.wakeFd, &state.wakeValue, sizeof(state.wakeValue), 0);
+    io_uring_sqe_set_data64(sqe, EncodeUserData(IoUringOperation::WAKE, 0, state.wakeFd));
+}
+
+static void ArmRecv(IoUringState& state, i32 fd, u32 generation)
+{
+    io_uring_sqe* sqe = GetSqe(&state.ring);
+    io_uring_prep_recv_multishot(sqe, fd, nullptr, 0, 0);
+    sqe->flags |= IOSQE_BUFFER_SELECT;
+    sqe->buf_group = IO_URING_BUFFER_GROUP;
+    io_uring_sqe_set_data64(sqe, EncodeUserData(IoUringOperation::RECV, generation, fd));
+}
+
+static void EraseConnection(IoUringState& state, std::unordered_map<i32, IoUringConnection>::iterator itr, bool cancelRecv)
+{
+    // The multishot recv holds its own reference to the socket, closing the fd alone neither stops it nor releases the socket
+    if (cancelRecv)
+    {
+        io_uring_sqe* sqe = GetSqe(&state.ring);
+        io_uring_prep_cancel64(sqe, EncodeUserData(IoUringOperation::RECV, itr->second.generation, itr->first), 0);
+        io_uring_sqe_set_data64(sqe, EncodeUserData(IoUringOperation::CANCEL, 0, itr->first));
+    }
+
+    state.connectionFds.erase(itr->second.entityId);
+    state.connections.erase(itr);
+}
+
+static bool HandleReceive(IoUringConnection& connection, const u8* data, size_t size)
+{
+    // While the network is impaired the simulator decides when, and in which pieces, the bytes reach the framer
+    if (NetworkSimulator* networkSimulator = ServiceLocator::GetNetworkSimulator())
+    {
+        networkSimulator->ReceiveFromClient(connection.entityId, data, size);
+        return true;
+    }
+
+    entt::registry* registry = ServiceLocator::GetRegistry();
+    ConnectionComponent& connectionComponent = registry->get<ConnectionComponent>(static_cast<entt::entity>(connection.entityId));
+
+    return PacketFramer::Receive(connectionComponent.packetQueue, connection.partialFrame, connection.entityId, data, size);
+}
+
+void IoUringBackend::Run()
+{
+    ThreadAffinity::PinIoThread();
+    IoUringState& state = *_state;
+
+    static std::atomic<i64>& submitsMetric = Metrics::Get("ioUring.submits");
+    static std::atomic<i64>& completionsMetric = Metrics::Get("ioUring.completions");
+    static std::atomic<i64>& acceptsMetric = Metrics::Get("ioUring.accepts");
+    static std::atomic<i64>& bytesReceivedMetric = Metrics::Get("ioUring.bytesReceived");
+    static std::atomic<i64>& bufferStarvedMetric = Metrics::Get("ioUring.bufferStarved");
+
+    ArmWake(state);
+
+    while (_isRunning.load(std::memory_order_relaxed))
+    {
+        // Everything queued while handling the last sweep goes out in this single call
+        io_uring_submit_and_wait(&state.ring, 1);
+        submitsMetric.fetch_add(1, std::memory_order_relaxed);
+
+        u32 head;
+        u32 completionCount = 0;
+        u32 returnedBuffers = 0;
+        io_uring_cqe* cqe;
+
+        io_uring_for_each_cqe(&state.ring, head, cqe)
+        {
+            completionCount++;
+
+            u64 userData = io_uring_cqe_get_data64(cqe);
+            IoUringOperation operation = static_cast<IoUringOperation>(userData >> 56);
+            u32 generation = static_cast<u32>(userData >> 32) & 0xFFFFFF;
+            i32 fd = static_cast<i32>(userData & 0xFFFFFFFF);
+
+            if (operation == IoUringOperation::ACCEPT)
+            {
+                if (cqe->res >= 0)
+                {
+                    acceptsMetric.fetch_add(1, std::memory_order_relaxed);
+
+                    // From here on the connection follows the regular path through ConnectionDeferredSystem
+                    asio::ip::tcp::socket* socket = new asio::ip::tcp::socket(*_asioService.get(), asio::ip::tcp::v4(), cqe->res);
+                    ConnectionUpdateSystem::Server_HandleConnect(nullptr, socket, asio::error_code());
+                }
+
+                if (!(cqe->flags & IORING_CQE_F_MORE))
+                    ArmAccept(state);
+            }
+            else if (operation == IoUringOperation::WAKE)
+            {
+                if (!state.isAcceptArmed && _isAccepting.load(std::memory_order_relaxed))
+                {
+                    ArmAccept(state);
+                    state.isAcceptArmed = true;
+                }
+
+                PendingConnection pending;
+                while (_pendingConnections.try_dequeue(pending))
+                {
+                    i32 connectionFd = static_cast<i32>(pending.client->socket()->native_handle());
+
+                    // The fd was closed and reused before the removal of its previous connection got here
+                    auto staleItr = state.connections.find(connectionFd);
+                    if (staleItr != state.connections.end())
+                        EraseConnection(state, staleItr, true);
+
+                    state.connectionFds[pending.entityId] = connectionFd;
+                    IoUringConnection& connection = state.connections[connectionFd];
+                    connection.client = pending.client;
+                    connection.entityId = pending.entityId;
+                    connection.generation = state.nextGeneration++;
+                    connection.partialFrame.clear();
+
+                    ArmRecv(state, connectionFd, connection.generation);
+                }
+
+                // Connections the server closed itself, ones that ended with their recv were erased already
+                u32 entityId;
+                while (_removedConnections.try_dequeue(entityId))
+                {
+                    auto fdItr = state.connectionFds.find(entityId);
+                    if (fdItr == state.connectionFds.end())
+                        continue;
+
+                    auto itr = state.connections.find(fdItr->second);
+                    if (itr != state.connections.end() && itr->second.entityId == entityId)
+                        EraseConnection(state, itr, true);
+                    else
+                        state.connectionFds.erase(fdItr);
+                }
+
+                if (_isRunning.load(std::memory_order_relaxed))
+                    ArmWake(state);
+            }
+            else if (operation == IoUringOperation::RECV)
+            {
+                auto itr = state.connections.find(fd);
+                bool isCurrent = itr != state.connections.end() && (itr->second.generation & 0xFFFFFF) == generation;
+
+                if (cqe->flags & IORING_CQE_F_BUFFER)
+                {
+                    u16 bufferId = static_cast<u16>(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+                    u8* buffer = state.buffers + static_cast<size_t>(bufferId) * IO_URING_BUFFER_SIZE;
+
+                    if (isCurrent && cqe->res > 0)
+                    {
+                        bytesReceivedMetric.fetch_add(cqe->res, std::memory_order_relaxed);
+
+                        if (!HandleReceive(itr->second, buffer, static_cast<size_t>(cqe->res)))
+                            itr->second.client->Close(asio::error::shut_down);
+                    }
+
+                    io_uring_buf_ring_add(state.bufferRing, buffer, IO_URING_BUFFER_SIZE, bufferId, io_uring_buf_ring_mask(IO_URING_BUFFER_COUNT), returnedBuffers++);
+                }
+
+                if (!isCurrent)
+                    continue;
+
+                if (cqe->res == -ENOBUFS)
+                {
+                    // Every buffer was in flight, the buffers returned during this sweep let us try again
+                    bufferStarvedMetric.fetch_add(1, std::memory_order_relaxed);
+                    ArmRecv(state, fd, generation);
+                }
+                else if (cqe->res <= 0)
+                {
+                    // Closing through NetworkClient fires Client_HandleDisconnect, which drops the entity exactly once
+                    itr->second.client->Close(asio::error::eof);
+                    EraseConnection(state, itr, false);
+                }
+                else if (!(cqe->flags & IORING_CQE_F_MORE))
+                {
+                    ArmRecv(state, fd, generation);
+                }
+            }
+        }
+
+        io_uring_buf_ring_advance(state.bufferRing, returnedBuffers);
+        io_uring_cq_advance(&state.ring, completionCount);
+        completionsMetric.fetch_add(completionCount, std::memory_order_relaxed);
+    }
+}
+
+#else
+
+struct IoUringState { };
+
+IoUringBackend::IoUringBackend(std::shared_ptr<asio::io_service> asioService) : _asioService(asioService), _pendingConnections(64), _removedConnections(64) { }
+IoUringBackend::~IoUringBackend() { }
+
+bool IoUringBackend::Start(u16 /*port*/)
+{
+    return false;
+}
+
+void IoUringBackend::Stop() { }
+void IoUringBackend::StartAccepting() { }
+void IoUringBackend::AddConnection(std::shared_ptr<NetworkClient> /*client*/, u32 /*entityId*/) { }
+void IoUringBackend::RemoveConnection(u32 /*entityId*/) { }
+void IoUringBackend::Run() { }
+
+#endif // NC_REGION_IO_URING
@@ -0,0 +1,53 @@
+#pragma once
+#include <NovusTypes.h>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <asio/io_service.hpp>
+#include <Utils/ConcurrentQueue.h>
+
+class NetworkClient;
+struct IoUringState;
+
+// Optional Linux backend that accepts on the client port and receives from client sockets through io_uring,
+// using multishot accept/recv, a provided buffer ring and one batched submission per completion sweep.
+// Sockets are still owned by NetworkClient, so sends keep going through asio.
+class IoUringBackend
+{
+public:
+    IoUringBackend(std::shared_ptr<asio::io_service> asioService);
+    ~IoUringBackend();
+
+    // Returns false if the backend was not compiled in or the kernel refused to set up the ring.
+    // The port is bound right away, connections wait in its backlog until StartAccepting
+    bool Start(u16 port);
+    void Stop();
+
+    // Safe to call from any thread
+    void StartAccepting();
+
+    // Starts receiving on a connection once ConnectionDeferredSystem gave it an entity, safe to call from any thread
+    void AddConnection(std::shared_ptr<NetworkClient> client, u32 entityId);
+
+    // Cancels the receive of a connection the server dropped, its socket is only released once nothing is pending on it.
+    // Safe to call from any thread
+    void RemoveConnection(u32 entityId);
+
+private:
+    void Run();
+
+private:
+    std::shared_ptr<asio::io_service> _asioService;
+    std::unique_ptr<IoUringState> _state;
+    std::thread _thread;
+    std::atomic<bool> _isRunning{ false };
+    std::atomic<bool> _isAccepting{ false };
+
+    struct PendingConnection
+    {
+        std::shared_ptr<NetworkClient> client;
+        u32 entityId;
+    };
+    moodycamel::ConcurrentQueue<PendingConnection> _pendingConnections;
+    moodycamel::ConcurrentQueue<u32> _removedConnections;
+};
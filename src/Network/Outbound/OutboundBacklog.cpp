@@ -0,0 +1,32 @@
+#include "OutboundBacklog.h"
+#include <cstddef>
+
+#ifdef __linux__
+// The glibc header lacks the acknowledged byte count, the kernel's one can't be mixed with it so it is only included here
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <linux/tcp.h>
+#endif // __linux__
+
+u64 OutboundBacklog::Measure(i64 socketHandle)
+{
+    u64 sentBytes = _sentBytes.load(std::memory_order_relaxed);
+
+#ifdef __linux__
+    tcp_info info = {};
+    socklen_t infoSize = sizeof(info);
+
+    // Older kernels fill in less of the struct, without the acknowledged byte count there is nothing to measure
+    if (getsockopt(static_cast<int>(socketHandle), IPPROTO_TCP, TCP_INFO, &info, &infoSize) == 0 && infoSize >= offsetof(tcp_info, tcpi_bytes_acked) + sizeof(info.tcpi_bytes_acked))
+    {
+        _measuredBytes = sentBytes;
+        _backlog = sentBytes > info.tcpi_bytes_acked ? sentBytes - info.tcpi_bytes_acked : 0;
+    }
+#else
+    // Only measured on Linux, elsewhere no connection ever falls behind
+    (void)socketHandle;
+    _measuredBytes = sentBytes;
+#endif // __linux__
+
+    return _backlog;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <NovusTypes.h>
+#include <atomic>
+
+// Bytes sent to a client that it did not acknowledge yet. NetworkClient keeps what the socket can't take yet in a queue of
+// its own, so the backlog is measured from both ends instead: every send adds its bytes here and Measure asks the kernel how
+// many of them the client acknowledged. The difference sits in NetworkClient's queue, the socket buffer or in flight, and
+// only keeps growing for a client that doesn't keep up with its reads
+class OutboundBacklog
+{
+public:
+    // Any thread, compression workers count the bytes of the frames they send
+    void AddSent(size_t bytes) { _sentBytes.fetch_add(bytes, std::memory_order_relaxed); }
+
+    // Tick thread only. Returns the backlog, or the last measured one when the socket can't tell
+    u64 Measure(i64 socketHandle);
+
+    u64 GetBacklog() const { return _backlog; }
+    u64 GetUnmeasuredBytes() const { return _sentBytes.load(std::memory_order_relaxed) - _measuredBytes; }
+
+private:
+    std::atomic<u64> _sentBytes{ 0 };
+    u64 _measuredBytes = 0; // _sentBytes as of the last Measure
+    u64 _backlog = 0;
+};
@@ -0,0 +1,70 @@
+#include "PacketRecorder.h"
+#include <cstring>
+#include "../Compression/PacketCompression.h"
+
+// The file is grown in steps of this size so appending rarely has to remap
+constexpr size_t RECORDING_GROW_SIZE = 64 * 1024 * 1024;
+
+bool PacketRecorder::Open(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (!_file.Open(path, RECORDING_GROW_SIZE, true))
+        return false;
+
+    PacketRecordingHeader* header = reinterpret_cast<PacketRecordingHeader*>(_file.GetData());
+    header->magic = PACKET_RECORDING_MAGIC;
+    header->version = PACKET_RECORDING_VERSION;
+    header->size = 0;
+
+    _writeOffset = sizeof(PacketRecordingHeader);
+    return true;
+}
+
+void PacketRecorder::Close()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_file.IsOpen())
+        return;
+
+    // Trim the unused tail we reserved while growing
+    _file.Resize(_writeOffset);
+    _file.Flush(0, _writeOffset, false);
+    _file.Close();
+}
+
+void PacketRecorder::Record(u32 connectionId, u16 opcode, u16 size, const u8* payload)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_file.IsOpen())
+        return;
+
+    // Compressed frames are recorded as they arrived, replays decompress them the same way the live server does
+    u16 payloadSize = size & PACKET_SIZE_MASK;
+    size_t recordSize = sizeof(PacketRecord) + payloadSize;
+    if (_writeOffset + recordSize > _file.GetSize())
+    {
+        if (!_file.Resize(_file.GetSize() + RECORDING_GROW_SIZE))
+        {
+            _file.Close();
+            return;
+        }
+    }
+
+    PacketRecord record;
+    record.tick = _tick.load(std::memory_order_relaxed);
+    record.connectionId = connectionId;
+    record.opcode = opcode;
+    record.size = size;
+
+    u8* data = _file.GetData();
+    std::memcpy(data + _writeOffset, &record, sizeof(PacketRecord));
+    if (payloadSize)
+        std::memcpy(data + _writeOffset + sizeof(PacketRecord), payload, payloadSize);
+
+    _writeOffset += recordSize;
+
+    // Only publish the record once it has been fully written
+    PacketRecordingHeader* header = reinterpret_cast<PacketRecordingHeader*>(data);
+    header->size = _writeOffset - sizeof(PacketRecordingHeader);
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <NovusTypes.h>
+#include <mutex>
+#include <atomic>
+#include <limits>
+#include "../../Utils/MappedFile.h"
+
+constexpr u32 PACKET_RECORDING_MAGIC = 0x5250434E; // "NCPR"
+constexpr u32 PACKET_RECORDING_VERSION = 1;
+
+struct PacketRecordingHeader
+{
+    u32 magic;
+    u32 version;
+    u64 size; // Bytes of records following the header
+};
+
+// Each record is directly followed by size bytes of payload
+struct PacketRecord
+{
+    u64 tick;
+    u32 connectionId;
+    u16 opcode;
+    u16 size; // The frame's size field, PACKET_COMPRESSED_FLAG included
+};
+
+class PacketRecorder
+{
+public:
+    // Connection id used for packets received on the upstream (Self) link
+    static constexpr u32 UPSTREAM_CONNECTION_ID = std::numeric_limits<u32>::max();
+
+    bool Open(const std::string& path);
+    void Close();
+
+    void SetTick(u64 tick) { _tick.store(tick, std::memory_order_relaxed); }
+    void Record(u32 connectionId, u16 opcode, u16 size, const u8* payload);
+
+private:
+    std::mutex _mutex;
+    MappedFile _file;
+    size_t _writeOffset = 0;
+    std::atomic<u64> _tick{ 0 };
+};
@@ -0,0 +1,43 @@
+#include "PacketReplay.h"
+#include <cstring>
+#include "../Compression/PacketCompression.h"
+
+bool PacketReplay::Open(const std::string& path)
+{
+    if (!_file.Open(path, 0, false))
+        return false;
+
+    if (_file.GetSize() < sizeof(PacketRecordingHeader))
+        return false;
+
+    PacketRecordingHeader header;
+    std::memcpy(&header, _file.GetData(), sizeof(PacketRecordingHeader));
+
+    if (header.magic != PACKET_RECORDING_MAGIC || header.version != PACKET_RECORDING_VERSION)
+        return false;
+
+    // A recording that was never closed can be larger than header.size, everything past it is unpublished
+    if (header.size > _file.GetSize() - sizeof(PacketRecordingHeader))
+        return false;
+
+    _readOffset = sizeof(PacketRecordingHeader);
+    _endOffset = _readOffset + header.size;
+    return true;
+}
+
+bool PacketReplay::Next(PacketRecord& record, const u8*& payload)
+{
+    if (_readOffset + sizeof(PacketRecord) > _endOffset)
+        return false;
+
+    const u8* data = _file.GetData();
+    std::memcpy(&record, data + _readOffset, sizeof(PacketRecord));
+
+    u16 payloadSize = record.size & PACKET_SIZE_MASK;
+    if (_readOffset + sizeof(PacketRecord) + payloadSize > _endOffset)
+        return false;
+
+    payload = data + _readOffset + sizeof(PacketRecord);
+    _readOffset += sizeof(PacketRecord) + payloadSize;
+    return true;
+}
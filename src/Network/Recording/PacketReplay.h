@@ -0,0 +1,18 @@
+#pragma once
+#include <NovusTypes.h>
+#include "PacketRecorder.h"
+
+// Sequential reader for files written by PacketRecorder
+class PacketReplay
+{
+public:
+    bool Open(const std::string& path);
+
+    // Returns false once every record has been read, payload points into the mapped file
+    bool Next(PacketRecord& record, const u8*& payload);
+
+private:
+    MappedFile _file;
+    size_t _readOffset = 0;
+    size_t _endOffset = 0;
+};
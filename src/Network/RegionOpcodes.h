@@ -0,0 +1,19 @@
+#pragma once
+#include <NovusTypes.h>
+#include <Networking/NetworkPacket.h>
+
+// Opcodes only spoken between the region and its clients. Common's Opcode enum is shared by every service,
+// so these sit at the top of the range where they can not collide with it, and are intercepted before MessageHandler sees them
+enum class RegionOpcode : u16
+{
+    SMSG_HANDOFF_TOKEN = 0xFF00, // u64 token, sent right before the redirect to the region the client was handed off to
+    CMSG_HANDOFF_RESUME = 0xFF01, // u64 token, the first packet a handed off client sends to its new region
+    CMSG_UDP_REQUEST = 0xFF02, // Empty, asks for a UDP channel next to the connection, ignored when the region has no UDP port
+    SMSG_UDP_TOKEN = 0xFF03, // u64 token, u16 port. The token goes into every datagram, the first one binds the client's endpoint
+    SMSG_ENTITY_POSITIONS = 0xFF04 // u16 count, then count times u32 entity, f32 x, y, z. Every broadcast supersedes the ones before it
+};
+
+inline Opcode ToOpcode(RegionOpcode opcode)
+{
+    return static_cast<Opcode>(opcode);
+}
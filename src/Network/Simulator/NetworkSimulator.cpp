@@ -0,0 +1,237 @@
+#include "NetworkSimulator.h"
+#include <algorithm>
+#include <chrono>
+#include <entt.hpp>
+#include <Networking/NetworkClient.h>
+#include <Utils/ByteBuffer.h>
+#include "../Framing/PacketFramer.h"
+#include "../Recording/PacketRecorder.h"
+#include "../../ECS/Components/Network/ConnectionComponent.h"
+#include "../../ECS/Components/Network/ConnectionSingleton.h"
+#include "../../Utils/ServiceLocator.h"
+#include "../../Utils/Metrics.h"
+
+// Linux never retransmits sooner than this, a lost segment costs at least this much on top of the path's latency
+constexpr f32 MIN_RETRANSMIT_TIMEOUT_MS = 200.0f;
+constexpr u64 STREAM_PRUNE_INTERVAL_NS = 1000000000;
+
+static u64 GetNowNs()
+{
+    return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Each direction of a connection is its own stream, outbound ones are keyed by the NetworkClient they are written to
+static u64 GetStreamKey(u8 direction, u64 id)
+{
+    return (static_cast<u64>(direction) << 56) | (id & 0x00FFFFFFFFFFFFFF);
+}
+
+NetworkSimulator::NetworkSimulator(const NetworkConditions& conditions) : _conditions(conditions), _random(conditions.seed)
+{
+}
+
+void NetworkSimulator::ReceiveFromClient(u32 entityId, const u8* data, size_t size)
+{
+    Receive(Direction::CLIENT_INBOUND, entityId, data, size);
+}
+
+void NetworkSimulator::ReceiveFromUpstream(const u8* data, size_t size)
+{
+    Receive(Direction::UPSTREAM_INBOUND, PacketRecorder::UPSTREAM_CONNECTION_ID, data, size);
+}
+
+void NetworkSimulator::Send(const std::shared_ptr<NetworkClient>& client, const std::shared_ptr<Bytebuffer>& buffer)
+{
+    if (NetworkSimulator* networkSimulator = ServiceLocator::GetNetworkSimulator())
+    {
+        networkSimulator->Schedule(client, buffer);
+        return;
+    }
+
+    std::shared_ptr<Bytebuffer> sharedBuffer = buffer;
+    client->Send(sharedBuffer);
+}
+
+void NetworkSimulator::Receive(Direction direction, u32 entityId, const u8* data, size_t size)
+{
+    static std::atomic<i64>& shortReadsMetric = Metrics::Get("netsim.shortReads");
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    u64 arrivalNs = GetArrival(GetStreamKey(static_cast<u8>(direction), entityId), size, GetNowNs());
+
+    // Every piece reaches the framer as a read of its own, which is what splits frames across reads
+    size_t offset = 0;
+    while (offset < size)
+    {
+        size_t pieceSize = size - offset;
+        if (_conditions.maxReadSize > 0 && pieceSize > _conditions.maxReadSize)
+        {
+            std::uniform_int_distribution<size_t> pieceDistribution(1, _conditions.maxReadSize);
+            pieceSize = pieceDistribution(_random);
+            shortReadsMetric.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        Delivery delivery;
+        delivery.arrivalNs = arrivalNs;
+        delivery.direction = direction;
+        delivery.entityId = entityId;
+        delivery.data.assign(data + offset, data + offset + pieceSize);
+        Push(std::move(delivery));
+
+        offset += pieceSize;
+    }
+}
+
+void NetworkSimulator::Schedule(const std::shared_ptr<NetworkClient>& client, const std::shared_ptr<Bytebuffer>& buffer)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    Delivery delivery;
+    delivery.arrivalNs = GetArrival(GetStreamKey(static_cast<u8>(Direction::OUTBOUND), reinterpret_cast<uintptr_t>(client.get())), buffer->writtenData, GetNowNs());
+    delivery.direction = Direction::OUTBOUND;
+    delivery.client = client;
+    delivery.buffer = buffer;
+    Push(std::move(delivery));
+}
+
+bool NetworkSimulator::DropDatagram()
+{
+    static std::atomic<i64>& droppedDatagramsMetric = Metrics::Get("netsim.droppedDatagrams");
+    if (_conditions.lossPercent <= 0.0f)
+        return false;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::uniform_real_distribution<f32> lossDistribution(0.0f, 100.0f);
+    if (lossDistribution(_random) >= _conditions.lossPercent)
+        return false;
+
+    droppedDatagramsMetric.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+u64 NetworkSimulator::GetArrival(u64 streamKey, size_t size, u64 nowNs)
+{
+    static std::atomic<i64>& retransmitsMetric = Metrics::Get("netsim.retransmits");
+    Stream& stream = _streams[streamKey];
+
+    // The cap serializes a stream's bytes, a burst leaves the link as fast as the bandwidth allows and no faster
+    u64 departureNs = nowNs;
+    if (_conditions.bandwidth > 0)
+    {
+        u64 startNs = std::max(nowNs, stream.linkFreeNs);
+        stream.linkFreeNs = startNs + static_cast<u64>(size) * 1000000000 / _conditions.bandwidth;
+        departureNs = stream.linkFreeNs;
+    }
+
+    f32 delayMS = _conditions.latencyMS;
+    if (_conditions.jitterMS > 0.0f)
+    {
+        std::uniform_real_distribution<f32> jitterDistribution(-_conditions.jitterMS, _conditions.jitterMS);
+        delayMS += jitterDistribution(_random);
+    }
+
+    if (_conditions.lossPercent > 0.0f)
+    {
+        std::uniform_real_distribution<f32> lossDistribution(0.0f, 100.0f);
+        if (lossDistribution(_random) < _conditions.lossPercent)
+        {
+            delayMS += std::max(MIN_RETRANSMIT_TIMEOUT_MS, 2.0f * (_conditions.latencyMS + _conditions.jitterMS));
+            retransmitsMetric.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    u64 arrivalNs = departureNs + static_cast<u64>(std::max(delayMS, 0.0f) * 1000000.0f);
+
+    // Jitter never lets a stream's bytes overtake each other, TCP hands them to the reader in order
+    arrivalNs = std::max(arrivalNs, stream.lastArrivalNs);
+    stream.lastArrivalNs = arrivalNs;
+
+    return arrivalNs;
+}
+
+void NetworkSimulator::Push(Delivery&& delivery)
+{
+    delivery.sequence = _nextSequence++;
+    _deliveries.push_back(std::move(delivery));
+
+    std::push_heap(_deliveries.begin(), _deliveries.end(), &NetworkSimulator::ArrivesLater);
+}
+
+bool NetworkSimulator::ArrivesLater(const Delivery& a, const Delivery& b)
+{
+    return a.arrivalNs != b.arrivalNs ? a.arrivalNs > b.arrivalNs : a.sequence > b.sequence;
+}
+
+void NetworkSimulator::Update(entt::registry& registry)
+{
+    static std::atomic<i64>& pendingMetric = Metrics::Get("netsim.pendingDeliveries");
+    static std::atomic<i64>& deliveredBytesMetric = Metrics::Get("netsim.deliveredBytes");
+
+    u64 nowNs = GetNowNs();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        while (!_deliveries.empty() && _deliveries.front().arrivalNs <= nowNs)
+        {
+            std::pop_heap(_deliveries.begin(), _deliveries.end(), &NetworkSimulator::ArrivesLater);
+            _dueDeliveries.push_back(std::move(_deliveries.back()));
+            _deliveries.pop_back();
+        }
+
+        // Streams that went quiet have nothing left to delay, dropping them keeps closed connections from piling up
+        if (nowNs >= _nextPruneNs)
+        {
+            for (auto itr = _streams.begin(); itr != _streams.end();)
+            {
+                if (itr->second.lastArrivalNs < nowNs && itr->second.linkFreeNs < nowNs)
+                    itr = _streams.erase(itr);
+                else
+                    ++itr;
+            }
+
+            _nextPruneNs = nowNs + STREAM_PRUNE_INTERVAL_NS;
+        }
+
+        pendingMetric.store(static_cast<i64>(_deliveries.size()), std::memory_order_relaxed);
+    }
+
+    // Sockets and the registry are touched outside of the lock, the IO threads keep queueing meanwhile
+    i64 deliveredBytes = 0;
+    for (Delivery& delivery : _dueDeliveries)
+    {
+        deliveredBytes += delivery.buffer ? static_cast<i64>(delivery.buffer->writtenData) : static_cast<i64>(delivery.data.size());
+        Deliver(registry, delivery);
+    }
+
+    deliveredBytesMetric.fetch_add(deliveredBytes, std::memory_order_relaxed);
+    _dueDeliveries.clear();
+}
+
+void NetworkSimulator::Deliver(entt::registry& registry, Delivery& delivery)
+{
+    if (delivery.direction == Direction::OUTBOUND)
+    {
+        delivery.client->Send(delivery.buffer);
+        return;
+    }
+
+    if (delivery.direction == Direction::UPSTREAM_INBOUND)
+    {
+        ConnectionSingleton& connectionSingleton = registry.ctx<ConnectionSingleton>();
+        if (!PacketFramer::Receive(connectionSingleton.packetQueue, connectionSingleton.partialFrame, delivery.entityId, delivery.data.data(), delivery.data.size()))
+            connectionSingleton.networkClient->Close(asio::error::shut_down);
+
+        return;
+    }
+
+    // The connection may have closed while its bytes were in flight, the entity's version tells a recycled one apart
+    entt::entity entity = static_cast<entt::entity>(delivery.entityId);
+    if (!registry.valid(entity))
+        return;
+
+    ConnectionComponent* connection = registry.try_get<ConnectionComponent>(entity);
+    if (!connection)
+        return;
+
+    if (!PacketFramer::Receive(connection->packetQueue, connection->partialFrame, delivery.entityId, delivery.data.data(), delivery.data.size()))
+        connection->connection->Close(asio::error::shut_down);
+}
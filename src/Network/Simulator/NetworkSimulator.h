@@ -0,0 +1,96 @@
+#pragma once
+#include <NovusTypes.h>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include <entity/fwd.hpp>
+
+class Bytebuffer;
+class NetworkClient;
+
+// Impairment applied to every client connection and to the upstream link, each direction of a connection is impaired on its own
+struct NetworkConditions
+{
+    bool IsEnabled() const { return latencyMS > 0.0f || jitterMS > 0.0f || bandwidth > 0 || lossPercent > 0.0f || maxReadSize > 0; }
+
+    f32 latencyMS = 0.0f; // One way
+    f32 jitterMS = 0.0f; // Spread uniformly over [-jitterMS, jitterMS] around latencyMS
+    u32 bandwidth = 0; // Bytes per second, 0 is unlimited
+    f32 lossPercent = 0.0f; // Lost segments hold back everything behind them on their connection until the retransmit
+    u32 maxReadSize = 0; // Inbound reads are cut into random pieces of at most this many bytes, 0 keeps them whole
+    u32 seed = 0;
+};
+
+// Puts a simulated network between the server and its real sockets, so it can be tested under latency, jitter, loss and
+// partial frames without external tooling. Reads and writes still happen on the sockets, but their bytes are only handed on
+// by Update once the conditions say they would have arrived. Bytes keep their order within a connection like TCP does,
+// reads of different connections complete out of order through jitter and loss
+class NetworkSimulator
+{
+public:
+    NetworkSimulator(const NetworkConditions& conditions);
+
+    // Called by the IO threads with the bytes of a read
+    void ReceiveFromClient(u32 entityId, const u8* data, size_t size);
+    void ReceiveFromUpstream(const u8* data, size_t size);
+
+    // Goes through the simulator when one is running and straight to the socket otherwise, every outbound send uses this
+    static void Send(const std::shared_ptr<NetworkClient>& client, const std::shared_ptr<Bytebuffer>& buffer);
+
+    // Rolls the loss chance for a UDP datagram, which is lost outright where a TCP segment would have stalled its connection
+    bool DropDatagram();
+
+    // Frames the reads and writes the sends that arrived by now, called on the tick thread before the systems run
+    void Update(entt::registry& registry);
+
+private:
+    enum class Direction : u8
+    {
+        CLIENT_INBOUND,
+        UPSTREAM_INBOUND,
+        OUTBOUND
+    };
+
+    struct Delivery
+    {
+        u64 arrivalNs = 0;
+        u64 sequence = 0; // Deliveries due at the same time go in the order they were made
+        Direction direction = Direction::CLIENT_INBOUND;
+        u32 entityId = 0;
+        std::vector<u8> data; // Inbound
+        std::shared_ptr<NetworkClient> client; // Outbound
+        std::shared_ptr<Bytebuffer> buffer;
+    };
+
+    struct Stream
+    {
+        u64 linkFreeNs = 0; // When the bandwidth cap lets the next byte out
+        u64 lastArrivalNs = 0;
+    };
+
+    void Receive(Direction direction, u32 entityId, const u8* data, size_t size);
+    void Schedule(const std::shared_ptr<NetworkClient>& client, const std::shared_ptr<Bytebuffer>& buffer);
+
+    // Returns when size bytes sent now on the stream arrive, expects _mutex to be held
+    u64 GetArrival(u64 streamKey, size_t size, u64 nowNs);
+    void Push(Delivery&& delivery);
+
+    // Orders _deliveries so the earliest arrival is at its front
+    static bool ArrivesLater(const Delivery& a, const Delivery& b);
+
+    void Deliver(entt::registry& registry, Delivery& delivery);
+
+private:
+    NetworkConditions _conditions;
+
+    std::mutex _mutex;
+    std::mt19937 _random;
+    std::vector<Delivery> _deliveries; // Min heap on arrival
+    std::unordered_map<u64, Stream> _streams;
+    u64 _nextSequence = 0;
+    u64 _nextPruneNs = 0;
+
+    std::vector<Delivery> _dueDeliveries; // Only touched by Update
+};
@@ -0,0 +1,36 @@
+#pragma once
+#include <NovusTypes.h>
+
+// Every datagram starts with a UdpHeader, the token is what ties it to a client's TCP connection.
+// DATA carries complete client frames in the usual opcode and size framing,
+// ACK carries the u16 sequences of the header's channel that arrived, as many as fit
+enum class UdpDatagramType : u8
+{
+    DATA,
+    ACK
+};
+
+enum class UdpChannel : u8
+{
+    RELIABLE_ORDERED, // Resent until acked, delivered in the order it was sent
+    RELIABLE_UNORDERED, // Resent until acked, delivered as soon as it arrives
+    UNRELIABLE_SEQUENCED, // Never resent, anything older than what was already delivered is dropped
+    COUNT
+};
+
+#pragma pack(push, 1)
+struct UdpHeader
+{
+    u64 token;
+    UdpDatagramType type;
+    UdpChannel channel;
+    u16 sequence;
+};
+#pragma pack(pop)
+
+// Stays below the path MTU of anything a client sits behind, larger frames go over TCP
+constexpr size_t UDP_MAX_DATAGRAM_SIZE = 1200;
+constexpr size_t UDP_MAX_PAYLOAD_SIZE = UDP_MAX_DATAGRAM_SIZE - sizeof(UdpHeader);
+
+// Reliable datagrams a channel may have in flight, the receiver only has to remember this many sequences
+constexpr u16 UDP_RECEIVE_WINDOW = 256;
@@ -0,0 +1,89 @@
+#include "UdpTransport.h"
+#include <Utils/ByteBuffer.h>
+#include "UdpProtocol.h"
+#include "../Simulator/NetworkSimulator.h"
+#include "../../Utils/ServiceLocator.h"
+#include "../../Utils/Metrics.h"
+#include "../../EngineLoop.h"
+
+UdpTransport::UdpTransport(std::shared_ptr<asio::io_service> asioService) : _asioService(asioService), _datagrams(1024)
+{
+}
+
+bool UdpTransport::Open(u16 port)
+{
+    asio::error_code error;
+    asio::ip::udp::endpoint endpoint(asio::ip::udp::v4(), port);
+
+    _socket = std::make_unique<asio::ip::udp::socket>(*_asioService);
+    _socket->open(endpoint.protocol(), error);
+    if (!error)
+        _socket->bind(endpoint, error);
+
+    if (error)
+    {
+        ServiceLocator::GetEngineLoop()->PrintMessage("[Udp]: Failed to bind port %u (%s)", port, error.message().c_str());
+        _socket.reset();
+        return false;
+    }
+
+    _port = _socket->local_endpoint().port();
+    asio::post(*_asioService, [this, self = shared_from_this()]() { Receive(); });
+    return true;
+}
+
+void UdpTransport::Close()
+{
+    if (!_socket)
+        return;
+
+    // The pending receive completes with operation_aborted and lets go of the transport
+    asio::post(*_asioService, [this, self = shared_from_this()]()
+    {
+        asio::error_code error;
+        _socket->close(error);
+    });
+}
+
+void UdpTransport::Send(const asio::ip::udp::endpoint& endpoint, std::shared_ptr<Bytebuffer> datagram)
+{
+    static std::atomic<i64>& datagramsOutMetric = Metrics::Get("udp.datagramsOut");
+    datagramsOutMetric.fetch_add(1, std::memory_order_relaxed);
+
+    // A simulated lossy link loses datagrams outright, where TCP would have stalled the connection instead
+    NetworkSimulator* networkSimulator = ServiceLocator::GetNetworkSimulator();
+    if (networkSimulator && networkSimulator->DropDatagram())
+        return;
+
+    asio::post(*_asioService, [this, self = shared_from_this(), endpoint, datagram]()
+    {
+        _socket->async_send_to(asio::buffer(datagram->GetDataPointer(), datagram->writtenData), endpoint, [datagram](const asio::error_code&, size_t) { });
+    });
+}
+
+void UdpTransport::Receive()
+{
+    static std::atomic<i64>& datagramsInMetric = Metrics::Get("udp.datagramsIn");
+
+    _receiveBuffer = Bytebuffer::Borrow<UDP_MAX_DATAGRAM_SIZE>();
+    _socket->async_receive_from(asio::buffer(_receiveBuffer->GetDataPointer(), UDP_MAX_DATAGRAM_SIZE), _receiveEndpoint, [this, self = shared_from_this()](const asio::error_code& error, size_t size)
+    {
+        if (error == asio::error::operation_aborted || !_socket->is_open())
+            return;
+
+        // Errors on a UDP socket are left over ICMP replies for one peer, the socket itself keeps working
+        if (!error && size >= sizeof(UdpHeader))
+        {
+            NetworkSimulator* networkSimulator = ServiceLocator::GetNetworkSimulator();
+            if (!networkSimulator || !networkSimulator->DropDatagram())
+            {
+                datagramsInMetric.fetch_add(1, std::memory_order_relaxed);
+
+                _receiveBuffer->writtenData = size;
+                _datagrams.enqueue({ _receiveEndpoint, _receiveBuffer });
+            }
+        }
+
+        Receive();
+    });
+}
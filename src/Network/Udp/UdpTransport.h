@@ -0,0 +1,45 @@
+#pragma once
+#include <NovusTypes.h>
+#include <memory>
+#include <asio.hpp>
+#include <Utils/ConcurrentQueue.h>
+
+class Bytebuffer;
+
+struct UdpDatagram
+{
+    asio::ip::udp::endpoint endpoint;
+    std::shared_ptr<Bytebuffer> data;
+};
+
+// The region's UDP socket. It only moves datagrams, UdpSystem gives them meaning on the tick.
+// All socket work happens on the io service, the tick talks to it through a thread safe queue.
+// Every handler holds a reference to the transport, so it stays alive until Close drained them
+class UdpTransport : public std::enable_shared_from_this<UdpTransport>
+{
+public:
+    UdpTransport(std::shared_ptr<asio::io_service> asioService);
+
+    bool Open(u16 port);
+    void Close();
+
+    u16 GetPort() const { return _port; }
+
+    // Safe to call from any thread, the datagram must not change afterwards
+    void Send(const asio::ip::udp::endpoint& endpoint, std::shared_ptr<Bytebuffer> datagram);
+    bool TryGetDatagram(UdpDatagram& datagram) { return _datagrams.try_dequeue(datagram); }
+
+private:
+    void Receive();
+
+private:
+    std::shared_ptr<asio::io_service> _asioService;
+    std::unique_ptr<asio::ip::udp::socket> _socket;
+    u16 _port = 0;
+
+    // Only touched on the io service
+    asio::ip::udp::endpoint _receiveEndpoint;
+    std::shared_ptr<Bytebuffer> _receiveBuffer;
+
+    moodycamel::ConcurrentQueue<UdpDatagram> _datagrams;
+};
@@ -0,0 +1,102 @@
+#include "EntityBlob.h"
+#include <cstring>
+#include <type_traits>
+#include <entt.hpp>
+#include "SnapshotFormat.h"
+#include "../ECS/Components/Movement/PositionComponent.h"
+#include "../ECS/Components/Movement/VelocityComponent.h"
+#include "../ECS/Components/Movement/OrientationComponent.h"
+
+static constexpr u8 ComponentBit(SnapshotComponentId componentId)
+{
+    return static_cast<u8>(1u << static_cast<u32>(componentId));
+}
+
+template <typename T>
+static void WriteComponent(entt::registry& registry, entt::entity entity, SnapshotComponentId componentId, u8& componentMask, std::vector<u8>& buffer)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Blob components are copied as raw bytes");
+
+    T* component = registry.try_get<T>(entity);
+    if (!component)
+        return;
+
+    componentMask |= ComponentBit(componentId);
+
+    size_t offset = buffer.size();
+    buffer.resize(offset + sizeof(T));
+    std::memcpy(buffer.data() + offset, component, sizeof(T));
+}
+
+template <typename T>
+static void ReadComponent(entt::registry& registry, entt::entity entity, SnapshotComponentId componentId, u8 componentMask, const u8*& data)
+{
+    if (!(componentMask & ComponentBit(componentId)))
+        return;
+
+    T component;
+    std::memcpy(&component, data, sizeof(T));
+    registry.emplace_or_replace<T>(entity, component);
+
+    data += sizeof(T);
+}
+
+static size_t GetComponentsSize(u8 componentMask)
+{
+    size_t size = 0;
+    if (componentMask & ComponentBit(SnapshotComponentId::POSITION))
+        size += sizeof(PositionComponent);
+    if (componentMask & ComponentBit(SnapshotComponentId::VELOCITY))
+        size += sizeof(VelocityComponent);
+    if (componentMask & ComponentBit(SnapshotComponentId::ORIENTATION))
+        size += sizeof(OrientationComponent);
+
+    return size;
+}
+
+void EntityBlob::Write(entt::registry& registry, entt::entity entity, std::vector<u8>& buffer)
+{
+    size_t maskOffset = buffer.size();
+    buffer.push_back(0);
+
+    u8 componentMask = 0;
+    WriteComponent<PositionComponent>(registry, entity, SnapshotComponentId::POSITION, componentMask, buffer);
+    WriteComponent<VelocityComponent>(registry, entity, SnapshotComponentId::VELOCITY, componentMask, buffer);
+    WriteComponent<OrientationComponent>(registry, entity, SnapshotComponentId::ORIENTATION, componentMask, buffer);
+
+    buffer[maskOffset] = componentMask;
+}
+
+bool EntityBlob::Read(entt::registry& registry, entt::entity entity, const u8*& data, const u8* end)
+{
+    const u8* components = data;
+    if (!Skip(data, end))
+        return false;
+
+    u8 componentMask = *components++;
+    ReadComponent<PositionComponent>(registry, entity, SnapshotComponentId::POSITION, componentMask, components);
+    ReadComponent<VelocityComponent>(registry, entity, SnapshotComponentId::VELOCITY, componentMask, components);
+    ReadComponent<OrientationComponent>(registry, entity, SnapshotComponentId::ORIENTATION, componentMask, components);
+
+    return true;
+}
+
+bool EntityBlob::Skip(const u8*& data, const u8* end)
+{
+    if (data >= end)
+        return false;
+
+    size_t size = sizeof(u8) + GetComponentsSize(*data);
+    if (static_cast<size_t>(end - data) < size)
+        return false;
+
+    data += size;
+    return true;
+}
+
+void EntityBlob::Remove(entt::registry& registry, entt::entity entity)
+{
+    registry.remove_if_exists<PositionComponent>(entity);
+    registry.remove_if_exists<VelocityComponent>(entity);
+    registry.remove_if_exists<OrientationComponent>(entity);
+}
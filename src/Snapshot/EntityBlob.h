@@ -0,0 +1,23 @@
+#pragma once
+#include <NovusTypes.h>
+#include <entity/fwd.hpp>
+#include <vector>
+
+// The persistent components of a single entity packed as a u8 component mask followed by the present
+// components in SnapshotComponentId order. Used wherever one entity's state moves somewhere else,
+// between regions by HandoffSystem and between zones by ZoneMessageSystem
+class EntityBlob
+{
+public:
+    // Appends the entity's components to buffer
+    static void Write(entt::registry& registry, entt::entity entity, std::vector<u8>& buffer);
+
+    // Attaches the components of the blob at data to entity and advances data past it, false if the blob is truncated
+    static bool Read(entt::registry& registry, entt::entity entity, const u8*& data, const u8* end);
+
+    // Advances data past the blob without reading it, false if the blob is truncated
+    static bool Skip(const u8*& data, const u8* end);
+
+    // Removes every component a blob carries, once the state is owned elsewhere
+    static void Remove(entt::registry& registry, entt::entity entity);
+};
@@ -0,0 +1,184 @@
+#include "RegionSnapshot.h"
+#include <cstring>
+#include <entt.hpp>
+#include "SnapshotFormat.h"
+#include "../Utils/MappedFile.h"
+#include "../ECS/Components/Movement/PositionComponent.h"
+#include "../ECS/Components/Movement/VelocityComponent.h"
+#include "../ECS/Components/Movement/OrientationComponent.h"
+
+static_assert(sizeof(entt::entity) == sizeof(u32), "Snapshots store entity ids as u32");
+
+template <typename T>
+void CaptureComponent(entt::registry& registry, u32 zoneId, SnapshotComponentId componentId, std::vector<u8>& buffer)
+{
+    auto view = registry.view<T>();
+    u32 count = static_cast<u32>(view.size());
+
+    SnapshotSectionHeader section;
+    section.componentId = componentId;
+    section.count = count;
+    section.componentSize = sizeof(T);
+    section.zoneId = zoneId;
+
+    size_t offset = buffer.size();
+    buffer.resize(offset + sizeof(SnapshotSectionHeader) + count * (sizeof(u32) + sizeof(T)));
+
+    u8* data = buffer.data() + offset;
+    std::memcpy(data, &section, sizeof(SnapshotSectionHeader));
+    data += sizeof(SnapshotSectionHeader);
+
+    if (count == 0)
+        return;
+
+    // Both arrays are dense, so the copy is two memcpys regardless of how many entities there are
+    std::memcpy(data, view.data(), count * sizeof(u32));
+    std::memcpy(data + count * sizeof(u32), view.raw(), count * sizeof(T));
+}
+
+template <typename T>
+u32 RestoreComponent(entt::registry& registry, const u8* data, u32 count)
+{
+    const u8* components = data + count * sizeof(u32);
+
+    for (u32 i = 0; i < count; i++)
+    {
+        u32 id;
+        std::memcpy(&id, data + i * sizeof(u32), sizeof(u32));
+
+        entt::entity entity = static_cast<entt::entity>(id);
+        if (!registry.valid(entity))
+            entity = registry.create(entity);
+
+        T component;
+        std::memcpy(&component, components + i * sizeof(T), sizeof(T));
+        registry.emplace_or_replace<T>(entity, component);
+    }
+
+    return count;
+}
+
+void RegionSnapshot::Capture(const std::vector<entt::registry*>& registries, std::vector<u8>& buffer)
+{
+    buffer.clear();
+
+    for (u32 zoneId = 0; zoneId < registries.size(); zoneId++)
+    {
+        entt::registry& registry = *registries[zoneId];
+        CaptureComponent<PositionComponent>(registry, zoneId, SnapshotComponentId::POSITION, buffer);
+        CaptureComponent<VelocityComponent>(registry, zoneId, SnapshotComponentId::VELOCITY, buffer);
+        CaptureComponent<OrientationComponent>(registry, zoneId, SnapshotComponentId::ORIENTATION, buffer);
+    }
+}
+
+u32 RegionSnapshot::Restore(const std::vector<entt::registry*>& registries, const u8* data, size_t size, u32& skippedCount)
+{
+    u32 componentCount = 0;
+    size_t offset = 0;
+
+    while (offset + sizeof(SnapshotSectionHeader) <= size)
+    {
+        SnapshotSectionHeader section;
+        std::memcpy(&section, data + offset, sizeof(SnapshotSectionHeader));
+        offset += sizeof(SnapshotSectionHeader);
+
+        size_t sectionSize = static_cast<size_t>(section.count) * (sizeof(u32) + section.componentSize);
+        if (offset + sectionSize > size)
+            break;
+
+        const u8* sectionData = data + offset;
+        offset += sectionSize;
+
+        // A checkpoint taken with more zones than we host now can't put those entities anywhere
+        if (section.zoneId >= registries.size())
+        {
+            skippedCount += section.count;
+            continue;
+        }
+
+        entt::registry& registry = *registries[section.zoneId];
+
+        // Sections from a build with a different component layout are skipped rather than misread
+        switch (section.componentId)
+        {
+            case SnapshotComponentId::POSITION:
+                if (section.componentSize == sizeof(PositionComponent))
+                    componentCount += RestoreComponent<PositionComponent>(registry, sectionData, section.count);
+                break;
+            case SnapshotComponentId::VELOCITY:
+                if (section.componentSize == sizeof(VelocityComponent))
+                    componentCount += RestoreComponent<VelocityComponent>(registry, sectionData, section.count);
+                break;
+            case SnapshotComponentId::ORIENTATION:
+                if (section.componentSize == sizeof(OrientationComponent))
+                    componentCount += RestoreComponent<OrientationComponent>(registry, sectionData, section.count);
+                break;
+            default:
+                break;
+        }
+    }
+
+    return componentCount;
+}
+
+bool RegionSnapshot::Load(const std::string& path, const std::vector<entt::registry*>& registries, u64& tick, u32& componentCount, u32& skippedCount)
+{
+    MappedFile file;
+    if (!file.Open(path, 0, false))
+        return false;
+
+    if (file.GetSize() < SNAPSHOT_HEADER_SIZE)
+        return false;
+
+    SnapshotFileHeader header;
+    std::memcpy(&header, file.GetData(), sizeof(SnapshotFileHeader));
+
+    // Older versions only lack the zone ids, which read as the primary zone
+    if (header.magic != SNAPSHOT_MAGIC || header.version == 0 || header.version > SNAPSHOT_VERSION)
+        return false;
+
+    if (file.GetSize() < SNAPSHOT_HEADER_SIZE + header.slotCapacity * SNAPSHOT_SLOT_COUNT)
+        return false;
+
+    // Try the newest checkpoint first and fall back to the older one if it does not verify
+    size_t newest = header.slots[0].generation >= header.slots[1].generation ? 0 : 1;
+    size_t order[SNAPSHOT_SLOT_COUNT] = { newest, 1 - newest };
+
+    for (size_t slotIndex : order)
+    {
+        const SnapshotSlotInfo& slot = header.slots[slotIndex];
+        if (slot.generation == 0 || slot.size > header.slotCapacity)
+            continue;
+
+        const u8* data = file.GetData() + SNAPSHOT_HEADER_SIZE + slotIndex * header.slotCapacity;
+        if (Checksum(data, slot.size) != slot.checksum)
+            continue;
+
+        tick = slot.tick;
+        componentCount = Restore(registries, data, slot.size, skippedCount);
+        return true;
+    }
+
+    return false;
+}
+
+u64 RegionSnapshot::Checksum(const u8* data, size_t size)
+{
+    // FNV-1a over 8 byte words, the tail is folded in byte by byte
+    u64 hash = 14695981039346656037ull;
+    size_t i = 0;
+
+    for (; i + sizeof(u64) <= size; i += sizeof(u64))
+    {
+        u64 word;
+        std::memcpy(&word, data + i, sizeof(u64));
+        hash = (hash ^ word) * 1099511628211ull;
+    }
+
+    for (; i < size; i++)
+    {
+        hash = (hash ^ data[i]) * 1099511628211ull;
+    }
+
+    return hash;
+}
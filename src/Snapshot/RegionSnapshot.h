@@ -0,0 +1,21 @@
+#pragma once
+#include <NovusTypes.h>
+#include <entity/fwd.hpp>
+#include <vector>
+
+class RegionSnapshot
+{
+public:
+    // Copies every persistent component of every zone into buffer, this is the only part of a checkpoint that runs on the tick.
+    // registries is indexed by zone id, none of them may be updated while this runs
+    static void Capture(const std::vector<entt::registry*>& registries, std::vector<u8>& buffer);
+
+    // Recreates the captured entities under their original ids in their zone's registry, returns the number of components restored.
+    // Components of zones this process does not host any more are skipped and counted into skippedCount
+    static u32 Restore(const std::vector<entt::registry*>& registries, const u8* data, size_t size, u32& skippedCount);
+
+    // Maps path and restores the newest intact checkpoint
+    static bool Load(const std::string& path, const std::vector<entt::registry*>& registries, u64& tick, u32& componentCount, u32& skippedCount);
+
+    static u64 Checksum(const u8* data, size_t size);
+};
@@ -0,0 +1,42 @@
+#pragma once
+#include <NovusTypes.h>
+
+constexpr u32 SNAPSHOT_MAGIC = 0x534E434E; // "NCNS"
+constexpr u32 SNAPSHOT_VERSION = 2; // Version 1 had no zone ids, its sections all belong to the primary zone
+
+// The file header owns the whole first page so slots start page aligned
+constexpr size_t SNAPSHOT_HEADER_SIZE = 4096;
+constexpr size_t SNAPSHOT_SLOT_COUNT = 2;
+
+enum class SnapshotComponentId : u32
+{
+    POSITION = 1,
+    VELOCITY = 2,
+    ORIENTATION = 3
+};
+
+struct SnapshotSlotInfo
+{
+    u64 generation; // 0 marks a slot that is empty or being written
+    u64 tick;
+    u64 size;
+    u64 checksum;
+};
+
+// The file is [SnapshotFileHeader][slot 0][slot 1], checkpoints alternate between the slots so a crash mid write always leaves the previous one intact
+struct SnapshotFileHeader
+{
+    u32 magic;
+    u32 version;
+    u64 slotCapacity;
+    SnapshotSlotInfo slots[SNAPSHOT_SLOT_COUNT];
+};
+
+// A slot is a sequence of sections, each followed by count entity ids and count components
+struct SnapshotSectionHeader
+{
+    SnapshotComponentId componentId;
+    u32 count;
+    u32 componentSize;
+    u32 zoneId; // Zone whose registry the entities live in, 0 for the primary zone
+};
@@ -0,0 +1,167 @@
+#include "SnapshotWriter.h"
+#include <cstring>
+#include <algorithm>
+#include "SnapshotFormat.h"
+#include "RegionSnapshot.h"
+#include "../Utils/ServiceLocator.h"
+#include "../EngineLoop.h"
+
+constexpr size_t SNAPSHOT_INITIAL_SLOT_CAPACITY = 4 * 1024 * 1024;
+
+// Unchanged chunks are left alone, so the OS only has to write back the pages that actually changed
+constexpr size_t SNAPSHOT_CHUNK_SIZE = 4096;
+
+SnapshotWriter::~SnapshotWriter()
+{
+    Close();
+}
+
+bool SnapshotWriter::Open(const std::string& path)
+{
+    // Keep an existing file as it is, the slot we are not about to overwrite stays a valid fallback
+    MappedFile existingFile;
+    size_t slotCapacity = SNAPSHOT_INITIAL_SLOT_CAPACITY;
+    bool isValid = false;
+
+    if (existingFile.Open(path, 0, false) && existingFile.GetSize() >= SNAPSHOT_HEADER_SIZE)
+    {
+        SnapshotFileHeader header;
+        std::memcpy(&header, existingFile.GetData(), sizeof(SnapshotFileHeader));
+
+        if (header.magic == SNAPSHOT_MAGIC && header.version == SNAPSHOT_VERSION && existingFile.GetSize() == SNAPSHOT_HEADER_SIZE + header.slotCapacity * SNAPSHOT_SLOT_COUNT)
+        {
+            slotCapacity = header.slotCapacity;
+            _generation = std::max(header.slots[0].generation, header.slots[1].generation);
+            isValid = true;
+        }
+    }
+    existingFile.Close();
+
+    if (!_file.Open(path, SNAPSHOT_HEADER_SIZE + slotCapacity * SNAPSHOT_SLOT_COUNT, true))
+        return false;
+
+    if (!isValid)
+    {
+        SnapshotFileHeader* header = reinterpret_cast<SnapshotFileHeader*>(_file.GetData());
+        std::memset(header, 0, sizeof(SnapshotFileHeader));
+        header->magic = SNAPSHOT_MAGIC;
+        header->version = SNAPSHOT_VERSION;
+        header->slotCapacity = slotCapacity;
+        _file.Flush(0, SNAPSHOT_HEADER_SIZE, false);
+    }
+
+    _isRunning = true;
+    _thread = std::thread(&SnapshotWriter::Run, this);
+    return true;
+}
+
+void SnapshotWriter::Close()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_isRunning)
+            return;
+
+        _isRunning = false;
+    }
+
+    // The writer finishes a pending checkpoint before it exits
+    _condition.notify_one();
+    _thread.join();
+    _file.Close();
+}
+
+bool SnapshotWriter::Submit(const std::vector<entt::registry*>& registries, u64 tick)
+{
+    // Skipping a checkpoint is always preferable to stalling the tick
+    if (_isBusy.load(std::memory_order_acquire))
+        return false;
+
+    RegionSnapshot::Capture(registries, _buffer);
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _tick = tick;
+        _hasPending = true;
+        _isBusy.store(true, std::memory_order_release);
+    }
+
+    _condition.notify_one();
+    return true;
+}
+
+void SnapshotWriter::Run()
+{
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _condition.wait(lock, [this]() { return _hasPending || !_isRunning; });
+
+            if (!_hasPending)
+                break;
+        }
+
+        WriteCheckpoint();
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _hasPending = false;
+        }
+        _isBusy.store(false, std::memory_order_release);
+    }
+}
+
+void SnapshotWriter::WriteCheckpoint()
+{
+    if (!_file.IsOpen())
+        return;
+
+    SnapshotFileHeader* header = reinterpret_cast<SnapshotFileHeader*>(_file.GetData());
+
+    // Overwrite the older of the two slots
+    size_t slotIndex = header->slots[0].generation <= header->slots[1].generation ? 0 : 1;
+
+    if (_buffer.size() > header->slotCapacity)
+    {
+        // Growing moves slot 1, slot 0 keeps its offset and with it the previous checkpoint if it lives there
+        size_t slotCapacity = std::max(static_cast<size_t>(header->slotCapacity) * 2, _buffer.size());
+        slotCapacity = (slotCapacity + SNAPSHOT_CHUNK_SIZE - 1) / SNAPSHOT_CHUNK_SIZE * SNAPSHOT_CHUNK_SIZE;
+
+        header->slots[1].generation = 0;
+        _file.Flush(0, SNAPSHOT_HEADER_SIZE, false);
+
+        if (!_file.Resize(SNAPSHOT_HEADER_SIZE + slotCapacity * SNAPSHOT_SLOT_COUNT))
+        {
+            ServiceLocator::GetEngineLoop()->PrintMessage("[Snapshot]: Failed to grow snapshot file to %u bytes", static_cast<u32>(slotCapacity));
+            _file.Close();
+            return;
+        }
+
+        header = reinterpret_cast<SnapshotFileHeader*>(_file.GetData());
+        header->slotCapacity = slotCapacity;
+        slotIndex = 1;
+    }
+
+    // Invalidate the slot before touching it, a crash from here on falls back to the other slot
+    SnapshotSlotInfo& slot = header->slots[slotIndex];
+    slot.generation = 0;
+    _file.Flush(0, SNAPSHOT_HEADER_SIZE, false);
+
+    size_t slotOffset = SNAPSHOT_HEADER_SIZE + slotIndex * header->slotCapacity;
+    u8* slotData = _file.GetData() + slotOffset;
+
+    for (size_t offset = 0; offset < _buffer.size(); offset += SNAPSHOT_CHUNK_SIZE)
+    {
+        size_t chunkSize = std::min(SNAPSHOT_CHUNK_SIZE, _buffer.size() - offset);
+        if (std::memcmp(slotData + offset, _buffer.data() + offset, chunkSize) != 0)
+            std::memcpy(slotData + offset, _buffer.data() + offset, chunkSize);
+    }
+    _file.Flush(slotOffset, _buffer.size(), false);
+
+    slot.tick = _tick;
+    slot.size = _buffer.size();
+    slot.checksum = RegionSnapshot::Checksum(_buffer.data(), _buffer.size());
+    slot.generation = ++_generation;
+    _file.Flush(0, SNAPSHOT_HEADER_SIZE, false);
+}
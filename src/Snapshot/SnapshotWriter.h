@@ -0,0 +1,43 @@
+#pragma once
+#include <NovusTypes.h>
+#include <entity/fwd.hpp>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <condition_variable>
+#include "../Utils/MappedFile.h"
+
+// Writes checkpoints into a memory mapped snapshot file from a background thread
+class SnapshotWriter
+{
+public:
+    ~SnapshotWriter();
+
+    bool Open(const std::string& path);
+    void Close();
+
+    // Captures the persistent components of every zone and hands them to the writer thread,
+    // returns false without touching the registries if the previous checkpoint is still being written
+    bool Submit(const std::vector<entt::registry*>& registries, u64 tick);
+
+private:
+    void Run();
+    void WriteCheckpoint();
+
+private:
+    MappedFile _file;
+
+    std::thread _thread;
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    bool _isRunning = false;
+    bool _hasPending = false;
+
+    // Set from Submit until the writer is done with _buffer, lets Submit bail out without taking the lock
+    std::atomic<bool> _isBusy{ false };
+
+    std::vector<u8> _buffer;
+    u64 _tick = 0;
+    u64 _generation = 0;
+};
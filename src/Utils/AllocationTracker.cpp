@@ -0,0 +1,98 @@
+#include "AllocationTracker.h"
+
+#ifdef NC_REGION_TRACK_ALLOCATIONS
+#include <new>
+#include <atomic>
+#include <cstdlib>
+
+// Plain thread_local integrals are constant initialized, so operator new can touch them at any point of a thread's life
+thread_local bool isTrackingAllocations = false;
+thread_local u64 threadAllocationCount = 0;
+static std::atomic<u64> allocationCount(0);
+
+AllocationScope::AllocationScope() : _wasTracking(isTrackingAllocations)
+{
+    isTrackingAllocations = true;
+}
+
+AllocationScope::~AllocationScope()
+{
+    isTrackingAllocations = _wasTracking;
+
+    if (!_wasTracking && threadAllocationCount > 0)
+    {
+        allocationCount.fetch_add(threadAllocationCount, std::memory_order_relaxed);
+        threadAllocationCount = 0;
+    }
+}
+
+u64 AllocationTracker::Flush()
+{
+    return allocationCount.exchange(0, std::memory_order_relaxed);
+}
+
+static void* TrackedAllocate(size_t size)
+{
+    if (isTrackingAllocations)
+        threadAllocationCount++;
+
+    void* memory = std::malloc(size > 0 ? size : 1);
+    if (!memory)
+        throw std::bad_alloc();
+
+    return memory;
+}
+
+void* operator new(size_t size)
+{
+    return TrackedAllocate(size);
+}
+
+void* operator new[](size_t size)
+{
+    return TrackedAllocate(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    if (isTrackingAllocations)
+        threadAllocationCount++;
+
+    return std::malloc(size > 0 ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return operator new(size, std::nothrow);
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept
+{
+    std::free(memory);
+}
+#endif // NC_REGION_TRACK_ALLOCATIONS
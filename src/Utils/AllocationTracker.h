@@ -0,0 +1,59 @@
+/*
+    MIT License
+
+    Copyright (c) 2020 NovusCore
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#pragma once
+#include <NovusTypes.h>
+
+// Counts heap allocations made inside AllocationScopes, the tick and every taskflow task run in one,
+// so anything that still reaches the heap during a tick shows up. Built with REGION_TRACK_ALLOCATIONS,
+// which replaces the global operator new, otherwise every call here compiles to nothing
+#ifdef NC_REGION_TRACK_ALLOCATIONS
+class AllocationScope
+{
+public:
+    AllocationScope();
+    ~AllocationScope();
+
+private:
+    bool _wasTracking;
+};
+
+class AllocationTracker
+{
+public:
+    // Returns the allocations counted since the last call
+    static u64 Flush();
+};
+#else
+class AllocationScope
+{
+public:
+    AllocationScope() { }
+};
+
+class AllocationTracker
+{
+public:
+    static u64 Flush() { return 0; }
+};
+#endif // NC_REGION_TRACK_ALLOCATIONS
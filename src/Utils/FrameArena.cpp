@@ -0,0 +1,103 @@
+#include "FrameArena.h"
+#include <new>
+#include <cstdlib>
+#include <algorithm>
+#include "Metrics.h"
+
+static std::atomic<u64> currentFrame(1);
+
+FrameArena::FrameArena(size_t blockSize) : _blockSize(blockSize)
+{
+}
+
+FrameArena::~FrameArena()
+{
+    for (Block& block : _blocks)
+    {
+        std::free(block.data);
+    }
+}
+
+void* FrameArena::Allocate(size_t size, size_t alignment)
+{
+    while (_blockIndex < _blocks.size())
+    {
+        Block& block = _blocks[_blockIndex];
+
+        uintptr_t address = reinterpret_cast<uintptr_t>(block.data) + _offset;
+        size_t padding = (alignment - (address % alignment)) % alignment;
+
+        if (_offset + padding + size <= block.size)
+        {
+            _offset += padding + size;
+            _usedSize += padding + size;
+            return block.data + _offset - size;
+        }
+
+        _blockIndex++;
+        _offset = 0;
+    }
+
+    // Growing should only happen while the arena warms up, a steady climb means something holds on to frame memory or a tick got a lot heavier
+    static std::atomic<i64>& growthMetric = Metrics::Get("frameArena.blockAllocations");
+    growthMetric.fetch_add(1, std::memory_order_relaxed);
+
+    // malloc guarantees max_align_t alignment, larger alignments get padded for
+    size_t blockSize = std::max(_blockSize, size + alignment);
+    Block block;
+    block.data = static_cast<u8*>(std::malloc(blockSize));
+    block.size = blockSize;
+
+    if (!block.data)
+        throw std::bad_alloc();
+
+    _blocks.push_back(block);
+    _blockIndex = _blocks.size() - 1;
+    _offset = 0;
+
+    return Allocate(size, alignment);
+}
+
+void FrameArena::Reset()
+{
+    static std::atomic<i64>& peakMetric = Metrics::Get("frameArena.peakBytes");
+
+    i64 usedSize = static_cast<i64>(_usedSize);
+    i64 peak = peakMetric.load(std::memory_order_relaxed);
+    while (usedSize > peak && !peakMetric.compare_exchange_weak(peak, usedSize, std::memory_order_relaxed)) { }
+
+    _blockIndex = 0;
+    _offset = 0;
+    _usedSize = 0;
+}
+
+size_t FrameArena::GetCapacity() const
+{
+    size_t capacity = 0;
+    for (const Block& block : _blocks)
+    {
+        capacity += block.size;
+    }
+
+    return capacity;
+}
+
+FrameArena& FrameArena::Get()
+{
+    thread_local FrameArena arena;
+
+    // Workers only run tasks between the start of a tick and EndFrame, so rewinding lazily never invalidates live memory
+    u64 frame = currentFrame.load(std::memory_order_acquire);
+    if (arena._frame != frame)
+    {
+        arena.Reset();
+        arena._frame = frame;
+    }
+
+    return arena;
+}
+
+void FrameArena::EndFrame()
+{
+    currentFrame.fetch_add(1, std::memory_order_release);
+}
@@ -0,0 +1,106 @@
+/*
+    MIT License
+
+    Copyright (c) 2020 NovusCore
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#pragma once
+#include <NovusTypes.h>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <cstddef>
+
+constexpr size_t FRAME_ARENA_BLOCK_SIZE = 256 * 1024;
+
+// Bump allocator for scratch memory that only has to live until the end of the current tick,
+// nothing is freed individually, the whole arena is rewound at once and its blocks are reused
+class FrameArena
+{
+public:
+    FrameArena(size_t blockSize = FRAME_ARENA_BLOCK_SIZE);
+    ~FrameArena();
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    template <typename T>
+    T* Allocate(size_t count = 1) { return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T))); }
+
+    // Invalidates every allocation, the blocks are kept for the next use
+    void Reset();
+
+    size_t GetUsedSize() const { return _usedSize; }
+    size_t GetCapacity() const;
+
+    // The arena of the calling thread, it is rewound the first time it is used after EndFrame,
+    // so memory from it must not be held across ticks
+    static FrameArena& Get();
+
+    // Called by the tick thread once every task of the tick has finished
+    static void EndFrame();
+
+private:
+    struct Block
+    {
+        u8* data;
+        size_t size;
+    };
+
+    std::vector<Block> _blocks;
+    size_t _blockSize;
+    size_t _blockIndex = 0;
+    size_t _offset = 0;
+    size_t _usedSize = 0;
+    u64 _frame = 0;
+};
+
+// Lets standard containers allocate from a FrameArena, deallocation is a no-op
+template <typename T>
+class FrameAllocator
+{
+public:
+    using value_type = T;
+
+    FrameAllocator() : _arena(&FrameArena::Get()) { }
+    FrameAllocator(FrameArena& arena) : _arena(&arena) { }
+
+    template <typename U>
+    FrameAllocator(const FrameAllocator<U>& other) : _arena(other.GetArena()) { }
+
+    T* allocate(size_t count) { return _arena->Allocate<T>(count); }
+    void deallocate(T*, size_t) { }
+
+    FrameArena* GetArena() const { return _arena; }
+
+    template <typename U>
+    bool operator==(const FrameAllocator<U>& other) const { return _arena == other.GetArena(); }
+    template <typename U>
+    bool operator!=(const FrameAllocator<U>& other) const { return _arena != other.GetArena(); }
+
+private:
+    FrameArena* _arena;
+};
+
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+using FrameString = std::basic_string<char, std::char_traits<char>, FrameAllocator<char>>;
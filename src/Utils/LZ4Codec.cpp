@@ -0,0 +1,205 @@
+#include "LZ4Codec.h"
+#include <cstring>
+
+constexpr i32 LZ4_MIN_MATCH = 4;
+constexpr i32 LZ4_MAX_OFFSET = 65535;
+
+// The format requires the last 5 bytes to be literals and the last match to start 12 bytes before the end
+constexpr i32 LZ4_LAST_LITERALS = 5;
+constexpr i32 LZ4_MATCH_FIND_LIMIT = 12;
+
+static u32 Read32(const u8* data)
+{
+    u32 value;
+    std::memcpy(&value, data, sizeof(u32));
+    return value;
+}
+
+static u32 Hash(u32 sequence)
+{
+    return (sequence * 2654435761u) >> (32 - LZ4_HASH_LOG);
+}
+
+static u8* WriteLength(u8* output, i32 length)
+{
+    while (length >= 255)
+    {
+        *output++ = 255;
+        length -= 255;
+    }
+
+    *output++ = static_cast<u8>(length);
+    return output;
+}
+
+i32 LZ4Codec::Compress(const u8* source, i32 sourceSize, u8* destination, i32 destinationCapacity, LZ4Context& context)
+{
+    u8* output = destination;
+    u8* outputEnd = destination + destinationCapacity;
+
+    i32 anchor = 0;
+    if (sourceSize > LZ4_MATCH_FIND_LIMIT)
+    {
+        context.positions.fill(-1);
+
+        i32 matchFindEnd = sourceSize - LZ4_MATCH_FIND_LIMIT;
+        i32 matchExtendEnd = sourceSize - LZ4_LAST_LITERALS;
+
+        for (i32 position = 0; position < matchFindEnd;)
+        {
+            u32 sequence = Read32(source + position);
+            i32& candidate = context.positions[Hash(sequence)];
+            i32 reference = candidate;
+            candidate = position;
+
+            if (reference < 0 || position - reference > LZ4_MAX_OFFSET || Read32(source + reference) != sequence)
+            {
+                position++;
+                continue;
+            }
+
+            i32 matchEnd = position + LZ4_MIN_MATCH;
+            for (i32 referenceEnd = reference + LZ4_MIN_MATCH; matchEnd < matchExtendEnd && source[matchEnd] == source[referenceEnd]; matchEnd++, referenceEnd++) { }
+
+            while (position > anchor && reference > 0 && source[position - 1] == source[reference - 1])
+            {
+                position--;
+                reference--;
+            }
+
+            i32 literalLength = position - anchor;
+            i32 matchLength = matchEnd - position - LZ4_MIN_MATCH;
+
+            // Token, literal run, offset and match length run
+            if (outputEnd - output < 1 + literalLength / 255 + 1 + literalLength + 2 + matchLength / 255 + 1)
+                return 0;
+
+            u8* token = output++;
+            if (literalLength >= 15)
+            {
+                *token = 15 << 4;
+                output = WriteLength(output, literalLength - 15);
+            }
+            else
+            {
+                *token = static_cast<u8>(literalLength << 4);
+            }
+
+            std::memcpy(output, source + anchor, literalLength);
+            output += literalLength;
+
+            u16 offset = static_cast<u16>(position - reference);
+            *output++ = static_cast<u8>(offset);
+            *output++ = static_cast<u8>(offset >> 8);
+
+            if (matchLength >= 15)
+            {
+                *token |= 15;
+                output = WriteLength(output, matchLength - 15);
+            }
+            else
+            {
+                *token |= static_cast<u8>(matchLength);
+            }
+
+            position = matchEnd;
+            anchor = matchEnd;
+        }
+    }
+
+    // Whatever is left goes out as a final literal only sequence
+    i32 literalLength = sourceSize - anchor;
+    if (outputEnd - output < 1 + literalLength / 255 + 1 + literalLength)
+        return 0;
+
+    u8* token = output++;
+    if (literalLength >= 15)
+    {
+        *token = 15 << 4;
+        output = WriteLength(output, literalLength - 15);
+    }
+    else
+    {
+        *token = static_cast<u8>(literalLength << 4);
+    }
+
+    std::memcpy(output, source + anchor, literalLength);
+    output += literalLength;
+
+    return static_cast<i32>(output - destination);
+}
+
+i32 LZ4Codec::Decompress(const u8* source, i32 sourceSize, u8* destination, i32 destinationCapacity)
+{
+    const u8* input = source;
+    const u8* inputEnd = source + sourceSize;
+    u8* output = destination;
+    u8* outputEnd = destination + destinationCapacity;
+
+    while (input < inputEnd)
+    {
+        u8 token = *input++;
+
+        i32 literalLength = token >> 4;
+        if (literalLength == 15)
+        {
+            u8 length;
+            do
+            {
+                if (input >= inputEnd)
+                    return -1;
+
+                length = *input++;
+                literalLength += length;
+            } while (length == 255);
+        }
+
+        if (literalLength > inputEnd - input || literalLength > outputEnd - output)
+            return -1;
+
+        std::memcpy(output, input, literalLength);
+        input += literalLength;
+        output += literalLength;
+
+        // The last sequence has no match
+        if (input == inputEnd)
+            break;
+
+        if (inputEnd - input < 2)
+            return -1;
+
+        i32 offset = input[0] | (input[1] << 8);
+        input += 2;
+
+        if (offset == 0 || offset > output - destination)
+            return -1;
+
+        i32 matchLength = token & 15;
+        if (matchLength == 15)
+        {
+            u8 length;
+            do
+            {
+                if (input >= inputEnd)
+                    return -1;
+
+                length = *input++;
+                matchLength += length;
+            } while (length == 255);
+        }
+        matchLength += LZ4_MIN_MATCH;
+
+        if (matchLength > outputEnd - output)
+            return -1;
+
+        // Matches may overlap the bytes they produce, so this has to copy forwards one byte at a time
+        const u8* match = output - offset;
+        for (i32 i = 0; i < matchLength; i++)
+        {
+            output[i] = match[i];
+        }
+        output += matchLength;
+    }
+
+    return static_cast<i32>(output - destination);
+}
@@ -0,0 +1,49 @@
+/*
+    MIT License
+
+    Copyright (c) 2020 NovusCore
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#pragma once
+#include <NovusTypes.h>
+#include <array>
+
+constexpr u32 LZ4_HASH_LOG = 12;
+constexpr u32 LZ4_HASH_TABLE_SIZE = 1 << LZ4_HASH_LOG;
+
+// Match finder state, it is large enough that compressing threads should keep one around instead of building it per call
+struct LZ4Context
+{
+    std::array<i32, LZ4_HASH_TABLE_SIZE> positions;
+};
+
+// Compressor and decompressor for the LZ4 block format, the compressor is a plain greedy one tuned for speed over ratio
+class LZ4Codec
+{
+public:
+    // Worst case compressed size of sourceSize bytes
+    static constexpr i32 GetBound(i32 sourceSize) { return sourceSize + sourceSize / 255 + 16; }
+
+    // Returns the compressed size or 0 if it does not fit in destinationCapacity
+    static i32 Compress(const u8* source, i32 sourceSize, u8* destination, i32 destinationCapacity, LZ4Context& context);
+
+    // Returns the decompressed size or -1 for a malformed block or one that does not fit in destinationCapacity
+    static i32 Decompress(const u8* source, i32 sourceSize, u8* destination, i32 destinationCapacity);
+};
@@ -0,0 +1,195 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool MappedFile::Open(const std::string& path, size_t size, bool writable)
+{
+    Close();
+    _writable = writable;
+
+#ifdef _WIN32
+    DWORD access = writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ;
+    DWORD disposition = writable ? OPEN_ALWAYS : OPEN_EXISTING;
+    HANDLE fileHandle = CreateFileA(path.c_str(), access, FILE_SHARE_READ, nullptr, disposition, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+        return false;
+
+    _fileHandle = fileHandle;
+
+    if (writable)
+    {
+        LARGE_INTEGER fileSize;
+        fileSize.QuadPart = static_cast<LONGLONG>(size);
+        if (!SetFilePointerEx(fileHandle, fileSize, nullptr, FILE_BEGIN) || !SetEndOfFile(fileHandle))
+        {
+            Close();
+            return false;
+        }
+        _size = size;
+    }
+    else
+    {
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(fileHandle, &fileSize))
+        {
+            Close();
+            return false;
+        }
+        _size = static_cast<size_t>(fileSize.QuadPart);
+    }
+#else
+    i32 fileDescriptor = open(path.c_str(), writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+    if (fileDescriptor < 0)
+        return false;
+
+    _fileDescriptor = fileDescriptor;
+
+    if (writable)
+    {
+        if (ftruncate(fileDescriptor, static_cast<off_t>(size)) != 0)
+        {
+            Close();
+            return false;
+        }
+        _size = size;
+    }
+    else
+    {
+        struct stat fileStat;
+        if (fstat(fileDescriptor, &fileStat) != 0)
+        {
+            Close();
+            return false;
+        }
+        _size = static_cast<size_t>(fileStat.st_size);
+    }
+#endif
+
+    if (!Map())
+    {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void MappedFile::Close()
+{
+    Unmap();
+
+#ifdef _WIN32
+    if (_fileHandle)
+    {
+        CloseHandle(static_cast<HANDLE>(_fileHandle));
+        _fileHandle = nullptr;
+    }
+#else
+    if (_fileDescriptor >= 0)
+    {
+        close(_fileDescriptor);
+        _fileDescriptor = -1;
+    }
+#endif
+
+    _size = 0;
+}
+
+bool MappedFile::Resize(size_t size)
+{
+    if (!_writable)
+        return false;
+
+    Unmap();
+
+#ifdef _WIN32
+    LARGE_INTEGER fileSize;
+    fileSize.QuadPart = static_cast<LONGLONG>(size);
+    if (!SetFilePointerEx(static_cast<HANDLE>(_fileHandle), fileSize, nullptr, FILE_BEGIN) || !SetEndOfFile(static_cast<HANDLE>(_fileHandle)))
+        return false;
+#else
+    if (ftruncate(_fileDescriptor, static_cast<off_t>(size)) != 0)
+        return false;
+#endif
+
+    _size = size;
+    return Map();
+}
+
+void MappedFile::Flush(size_t offset, size_t length, bool async)
+{
+    if (!_data || offset >= _size)
+        return;
+
+    if (offset + length > _size)
+        length = _size - offset;
+
+#ifdef _WIN32
+    FlushViewOfFile(_data + offset, length);
+    if (!async)
+        FlushFileBuffers(static_cast<HANDLE>(_fileHandle));
+#else
+    // msync requires a page aligned address
+    size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t alignedOffset = offset - (offset % pageSize);
+    msync(_data + alignedOffset, length + (offset - alignedOffset), async ? MS_ASYNC : MS_SYNC);
+#endif
+}
+
+bool MappedFile::Map()
+{
+    if (_size == 0)
+        return false;
+
+#ifdef _WIN32
+    HANDLE mappingHandle = CreateFileMappingA(static_cast<HANDLE>(_fileHandle), nullptr, _writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+    if (!mappingHandle)
+        return false;
+
+    void* data = MapViewOfFile(mappingHandle, _writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, _size);
+    if (!data)
+    {
+        CloseHandle(mappingHandle);
+        return false;
+    }
+
+    _mappingHandle = mappingHandle;
+    _data = static_cast<u8*>(data);
+#else
+    void* data = mmap(nullptr, _size, _writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, _fileDescriptor, 0);
+    if (data == MAP_FAILED)
+        return false;
+
+    _data = static_cast<u8*>(data);
+#endif
+
+    return true;
+}
+
+void MappedFile::Unmap()
+{
+    if (!_data)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(_data);
+    CloseHandle(static_cast<HANDLE>(_mappingHandle));
+    _mappingHandle = nullptr;
+#else
+    munmap(_data, _size);
+#endif
+
+    _data = nullptr;
+}
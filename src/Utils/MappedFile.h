@@ -0,0 +1,65 @@
+/*
+    MIT License
+
+    Copyright (c) 2020 NovusCore
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#pragma once
+#include <NovusTypes.h>
+#include <string>
+
+// Thin cross platform wrapper around a memory mapped file
+class MappedFile
+{
+public:
+    MappedFile() { }
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Writable files are created if needed and resized to size, read only files map their whole content and ignore size
+    bool Open(const std::string& path, size_t size, bool writable);
+    void Close();
+
+    // Remaps a writable file to a new size, pointers returned by GetData before this call are invalidated
+    bool Resize(size_t size);
+    void Flush(size_t offset, size_t length, bool async);
+
+    bool IsOpen() { return _data != nullptr; }
+    u8* GetData() { return _data; }
+    size_t GetSize() { return _size; }
+
+private:
+    bool Map();
+    void Unmap();
+
+private:
+    u8* _data = nullptr;
+    size_t _size = 0;
+    bool _writable = false;
+
+#ifdef _WIN32
+    void* _fileHandle = nullptr;
+    void* _mappingHandle = nullptr;
+#else
+    i32 _fileDescriptor = -1;
+#endif
+};
@@ -0,0 +1,57 @@
+#include "Metrics.h"
+#include <map>
+#include <mutex>
+#include <cstdio>
+#include <tracy/Tracy.hpp>
+
+// std::map never moves its nodes, which is what lets Get hand out references
+static std::mutex metricsMutex;
+static std::map<std::string, std::atomic<i64>> metricsByName;
+
+std::atomic<i64>& Metrics::Get(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(metricsMutex);
+    return metricsByName.try_emplace(name, 0).first->second;
+}
+
+void Metrics::ForEach(const std::function<void(const std::string&, i64)>& callback)
+{
+    std::lock_guard<std::mutex> lock(metricsMutex);
+    for (auto& metric : metricsByName)
+    {
+        callback(metric.first, metric.second.load(std::memory_order_relaxed));
+    }
+}
+
+void Metrics::Publish()
+{
+#ifdef TRACY_ENABLE
+    std::lock_guard<std::mutex> lock(metricsMutex);
+    for (auto& metric : metricsByName)
+    {
+        TracyPlot(metric.first.c_str(), metric.second.load(std::memory_order_relaxed));
+    }
+#endif // TRACY_ENABLE
+}
+
+bool Metrics::WriteFile(const std::string& path)
+{
+    std::string contents;
+    ForEach([&contents](const std::string& name, i64 value)
+    {
+        contents += name;
+        contents += ' ';
+        contents += std::to_string(value);
+        contents += '\n';
+    });
+
+    std::string temporaryPath = path + ".tmp";
+    FILE* file = std::fopen(temporaryPath.c_str(), "wb");
+    if (!file)
+        return false;
+
+    bool isWritten = std::fwrite(contents.data(), 1, contents.size(), file) == contents.size();
+    isWritten &= std::fclose(file) == 0;
+
+    return isWritten && std::rename(temporaryPath.c_str(), path.c_str()) == 0;
+}
@@ -0,0 +1,49 @@
+/*
+    MIT License
+
+    Copyright (c) 2020 NovusCore
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#pragma once
+#include <NovusTypes.h>
+#include <atomic>
+#include <string>
+#include <functional>
+
+// Process wide registry of named counters and gauges, safe to update from any thread
+class Metrics
+{
+public:
+    // Returns a reference that stays valid for the lifetime of the process,
+    // hot paths should look it up once and hold on to it
+    static std::atomic<i64>& Get(const std::string& name);
+
+    static void Add(const std::string& name, i64 value) { Get(name).fetch_add(value, std::memory_order_relaxed); }
+    static void Set(const std::string& name, i64 value) { Get(name).store(value, std::memory_order_relaxed); }
+
+    // Visits every metric in name order
+    static void ForEach(const std::function<void(const std::string&, i64)>& callback);
+
+    // Exports every metric as a Tracy plot, called once per tick
+    static void Publish();
+
+    // Writes every metric as a "name value" line, the file is replaced atomically so external tools never read a partial dump
+    static bool WriteFile(const std::string& path);
+};
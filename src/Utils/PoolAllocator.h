@@ -0,0 +1,108 @@
+/*
+    MIT License
+
+    Copyright (c) 2020 NovusCore
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#pragma once
+#include <NovusTypes.h>
+#include <mutex>
+#include <new>
+#include <vector>
+
+// Free list of equally sized blocks shared by every PoolAllocator whose type has that size. Blocks never go back to the heap,
+// objects that churn reuse the memory of the ones released before them. A block may be released on another thread than the one that took it
+template <size_t Size, size_t Alignment>
+class BlockPool
+{
+public:
+    static void* Take()
+    {
+        BlockPool& pool = Get();
+        {
+            std::lock_guard<std::mutex> lock(pool._mutex);
+            if (!pool._blocks.empty())
+            {
+                void* block = pool._blocks.back();
+                pool._blocks.pop_back();
+                return block;
+            }
+        }
+
+        return ::operator new(Size, std::align_val_t(Alignment));
+    }
+
+    static void Release(void* block)
+    {
+        BlockPool& pool = Get();
+
+        std::lock_guard<std::mutex> lock(pool._mutex);
+        pool._blocks.push_back(block);
+    }
+
+private:
+    // Never destroyed, objects released by other static destructors at exit still find it
+    static BlockPool& Get()
+    {
+        static BlockPool* pool = new BlockPool();
+        return *pool;
+    }
+
+    std::mutex _mutex;
+    std::vector<void*> _blocks;
+};
+
+// Lets std::allocate_shared and containers of single objects recycle their memory through a BlockPool,
+// allocate_shared rebinds it so the control block and the object share one pooled block
+template <typename T>
+class PoolAllocator
+{
+public:
+    using value_type = T;
+
+    PoolAllocator() = default;
+
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) { }
+
+    T* allocate(size_t count)
+    {
+        if (count != 1)
+            return static_cast<T*>(::operator new(sizeof(T) * count, std::align_val_t(alignof(T))));
+
+        return static_cast<T*>(BlockPool<sizeof(T), alignof(T)>::Take());
+    }
+
+    void deallocate(T* pointer, size_t count)
+    {
+        if (count != 1)
+        {
+            ::operator delete(pointer, std::align_val_t(alignof(T)));
+            return;
+        }
+
+        BlockPool<sizeof(T), alignof(T)>::Release(pointer);
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const PoolAllocator<U>&) const { return false; }
+};
@@ -4,6 +4,10 @@
 entt::registry* ServiceLocator::_gameRegistry = nullptr;
 MessageHandler* ServiceLocator::_selfMessageHandler = nullptr;
 MessageHandler* ServiceLocator::_clientMessageHandler = nullptr;
+PacketRecorder* ServiceLocator::_packetRecorder = nullptr;
+PacketCompression* ServiceLocator::_packetCompression = nullptr;
+NetworkSimulator* ServiceLocator::_networkSimulator = nullptr;
+EngineLoop* ServiceLocator::_engineLoop = nullptr;
 
 void ServiceLocator::SetRegistry(entt::registry* registry)
 {
@@ -19,4 +23,24 @@ void ServiceLocator::SetClientMessageHandler(MessageHandler* messageHandler)
 {
     assert(_clientMessageHandler == nullptr);
     _clientMessageHandler = messageHandler;
-}
\ No newline at end of file
+}
+void ServiceLocator::SetPacketRecorder(PacketRecorder* packetRecorder)
+{
+    assert(_packetRecorder == nullptr);
+    _packetRecorder = packetRecorder;
+}
+void ServiceLocator::SetPacketCompression(PacketCompression* packetCompression)
+{
+    assert(_packetCompression == nullptr);
+    _packetCompression = packetCompression;
+}
+void ServiceLocator::SetNetworkSimulator(NetworkSimulator* networkSimulator)
+{
+    assert(_networkSimulator == nullptr);
+    _networkSimulator = networkSimulator;
+}
+void ServiceLocator::SetEngineLoop(EngineLoop* engineLoop)
+{
+    assert(_engineLoop == nullptr);
+    _engineLoop = engineLoop;
+}
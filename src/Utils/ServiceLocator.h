@@ -27,7 +27,11 @@
 #include <Utils/ConcurrentQueue.h>
 #include <Utils/Message.h>
 
+class EngineLoop;
 class MessageHandler;
+class PacketRecorder;
+class PacketCompression;
+class NetworkSimulator;
 class ServiceLocator
 {
 public:
@@ -37,9 +41,23 @@ public:
     static void SetSelfMessageHandler(MessageHandler* serverMessageHandler);
     static MessageHandler* GetClientMessageHandler() { return _clientMessageHandler; }
     static void SetClientMessageHandler(MessageHandler* serverMessageHandler);
+    static PacketRecorder* GetPacketRecorder() { return _packetRecorder; }
+    static void SetPacketRecorder(PacketRecorder* packetRecorder);
+    static PacketCompression* GetPacketCompression() { return _packetCompression; }
+    static void SetPacketCompression(PacketCompression* packetCompression);
+    static NetworkSimulator* GetNetworkSimulator() { return _networkSimulator; }
+    static void SetNetworkSimulator(NetworkSimulator* networkSimulator);
+
+    // Log lines go through its output queue, so they reach the console and every tailing admin session
+    static EngineLoop* GetEngineLoop() { return _engineLoop; }
+    static void SetEngineLoop(EngineLoop* engineLoop);
 
 private:
     static entt::registry* _gameRegistry;
     static MessageHandler* _selfMessageHandler;
     static MessageHandler* _clientMessageHandler;
+    static PacketRecorder* _packetRecorder;
+    static PacketCompression* _packetCompression;
+    static NetworkSimulator* _networkSimulator;
+    static EngineLoop* _engineLoop;
 };
\ No newline at end of file
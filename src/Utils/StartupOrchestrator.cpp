@@ -0,0 +1,107 @@
+#include "StartupOrchestrator.h"
+
+StartupOrchestrator::StartupOrchestrator() : _start(std::chrono::steady_clock::now()) { }
+
+StartupOrchestrator::~StartupOrchestrator()
+{
+    Join();
+}
+
+void StartupOrchestrator::RunAsync(const std::string& name, Phase&& phase)
+{
+    size_t index = Add(name);
+    _threads.emplace_back([this, index, phase = std::move(phase)]()
+    {
+        Finish(index, phase());
+    });
+}
+
+void StartupOrchestrator::Begin(const std::string& name)
+{
+    Add(name);
+}
+
+void StartupOrchestrator::Complete(const std::string& name, bool succeeded)
+{
+    size_t index = 0;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        while (index < _phases.size() && _phases[index].name != name)
+            index++;
+
+        if (index == _phases.size() || _phases[index].isComplete)
+            return;
+    }
+
+    Finish(index, succeeded);
+}
+
+bool StartupOrchestrator::IsComplete(const std::string& name) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (const PhaseState& phase : _phases)
+    {
+        if (phase.name == name)
+            return phase.isComplete;
+    }
+
+    return false;
+}
+
+bool StartupOrchestrator::IsComplete() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (const PhaseState& phase : _phases)
+    {
+        if (!phase.isComplete)
+            return false;
+    }
+
+    return true;
+}
+
+void StartupOrchestrator::Join()
+{
+    for (std::thread& thread : _threads)
+    {
+        thread.join();
+    }
+
+    _threads.clear();
+}
+
+f64 StartupOrchestrator::GetElapsedMS() const
+{
+    return std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - _start).count();
+}
+
+void StartupOrchestrator::ForEach(const PhaseCallback& callback) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (const PhaseState& phase : _phases)
+    {
+        callback(phase.name, phase.durationMS, phase.succeeded);
+    }
+}
+
+size_t StartupOrchestrator::Add(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    PhaseState& phase = _phases.emplace_back();
+    phase.name = name;
+    phase.start = std::chrono::steady_clock::now();
+
+    return _phases.size() - 1;
+}
+
+void StartupOrchestrator::Finish(size_t index, bool succeeded)
+{
+    auto end = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    PhaseState& phase = _phases[index];
+    phase.durationMS = std::chrono::duration<f64, std::milli>(end - phase.start).count();
+    phase.isComplete = true;
+    phase.succeeded = succeeded;
+}
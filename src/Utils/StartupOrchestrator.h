@@ -0,0 +1,79 @@
+/*
+    MIT License
+
+    Copyright (c) 2020 NovusCore
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#pragma once
+#include <NovusTypes.h>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Runs the phases of startup side by side and keeps how long each of them took, so time to serving can be reported.
+// A phase either runs on a thread of its own, or is begun and completed by whoever runs or polls for it
+class StartupOrchestrator
+{
+public:
+    using Phase = std::function<bool()>;
+    using PhaseCallback = std::function<void(const std::string& name, f64 durationMS, bool succeeded)>;
+
+    StartupOrchestrator();
+    ~StartupOrchestrator();
+
+    void RunAsync(const std::string& name, Phase&& phase);
+
+    void Begin(const std::string& name);
+    void Complete(const std::string& name, bool succeeded);
+
+    bool IsComplete(const std::string& name) const;
+    bool IsComplete() const;
+
+    // Waits for every phase running on a thread of its own
+    void Join();
+
+    f64 GetElapsedMS() const;
+
+    // Visits every phase in the order they were started
+    void ForEach(const PhaseCallback& callback) const;
+
+private:
+    struct PhaseState
+    {
+        std::string name;
+        std::chrono::steady_clock::time_point start;
+        f64 durationMS = 0.0;
+        bool isComplete = false;
+        bool succeeded = false;
+    };
+
+    size_t Add(const std::string& name);
+    void Finish(size_t index, bool succeeded);
+
+private:
+    std::chrono::steady_clock::time_point _start;
+
+    mutable std::mutex _mutex;
+    std::vector<PhaseState> _phases;
+    std::vector<std::thread> _threads;
+};
@@ -0,0 +1,168 @@
+#include "ThreadAffinity.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include "ServiceLocator.h"
+#include "../EngineLoop.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#ifdef NC_REGION_NUMA
+#include <numa.h>
+#endif
+
+static AffinityConfig affinityConfig;
+static std::atomic<u32> nextWorkerIndex{ 0 };
+
+// Threads are pinned at most once, this also keeps a pinned tick thread from being repinned if it ever runs a task
+static thread_local bool isThreadPinned = false;
+
+#ifdef NC_REGION_NUMA
+static void FillFromNode(std::vector<i32>& cpus, i32 numaNode)
+{
+    bitmask* nodeCpus = numa_allocate_cpumask();
+    if (numa_node_to_cpus(numaNode, nodeCpus) == 0)
+    {
+        for (u32 cpu = 0; cpu < nodeCpus->size; cpu++)
+        {
+            if (numa_bitmask_isbitset(nodeCpus, cpu))
+                cpus.push_back(static_cast<i32>(cpu));
+        }
+    }
+    numa_free_cpumask(nodeCpus);
+}
+#endif // NC_REGION_NUMA
+
+void ThreadAffinity::Configure(const AffinityConfig& config)
+{
+    affinityConfig = config;
+
+#ifdef NC_REGION_NUMA
+    if (affinityConfig.numaNode >= 0)
+    {
+        if (numa_available() < 0 || affinityConfig.numaNode > numa_max_node())
+        {
+            ServiceLocator::GetEngineLoop()->PrintMessage("[Affinity]: NUMA node %d is unavailable", affinityConfig.numaNode);
+            affinityConfig.numaNode = -1;
+        }
+        else if (affinityConfig.workerCpus.empty())
+        {
+            // Leave the first two CPUs of the node to the IO and tick threads
+            std::vector<i32> nodeCpus;
+            FillFromNode(nodeCpus, affinityConfig.numaNode);
+
+            if (affinityConfig.ioCpu < 0 && nodeCpus.size() > 0)
+                affinityConfig.ioCpu = nodeCpus[0];
+            if (affinityConfig.tickCpu < 0 && nodeCpus.size() > 1)
+                affinityConfig.tickCpu = nodeCpus[1];
+
+            for (size_t i = 2; i < nodeCpus.size(); i++)
+                affinityConfig.workerCpus.push_back(nodeCpus[i]);
+        }
+    }
+#else
+    if (affinityConfig.numaNode >= 0)
+    {
+        ServiceLocator::GetEngineLoop()->PrintMessage("[Affinity]: Built without libnuma, ignoring the NUMA node");
+        affinityConfig.numaNode = -1;
+    }
+#endif // NC_REGION_NUMA
+}
+
+void ThreadAffinity::PinIoThread()
+{
+    PinCurrentThread(affinityConfig.ioCpu);
+}
+
+void ThreadAffinity::PinTickThread()
+{
+    PinCurrentThread(affinityConfig.tickCpu);
+}
+
+bool ThreadAffinity::IsConfigured()
+{
+    return affinityConfig.ioCpu >= 0 || affinityConfig.tickCpu >= 0 || !affinityConfig.workerCpus.empty() || affinityConfig.numaNode >= 0;
+}
+
+void ThreadAffinity::PinWorkerThread()
+{
+    if (isThreadPinned)
+        return;
+
+    if (affinityConfig.workerCpus.empty())
+    {
+        // Without a CPU list workers still pick up the preferred NUMA node
+        PinCurrentThread(-1);
+        return;
+    }
+
+    u32 workerIndex = nextWorkerIndex.fetch_add(1, std::memory_order_relaxed);
+    PinCurrentThread(affinityConfig.workerCpus[workerIndex % affinityConfig.workerCpus.size()]);
+}
+
+bool ThreadAffinity::ParseCpuList(const char* list, std::vector<i32>& cpus)
+{
+    const char* current = list;
+    while (*current)
+    {
+        char* end = nullptr;
+        long first = std::strtol(current, &end, 10);
+        if (end == current || first < 0)
+            return false;
+
+        long last = first;
+        if (*end == '-')
+        {
+            current = end + 1;
+            last = std::strtol(current, &end, 10);
+            if (end == current || last < first)
+                return false;
+        }
+
+        for (long cpu = first; cpu <= last; cpu++)
+            cpus.push_back(static_cast<i32>(cpu));
+
+        if (*end == ',')
+            end++;
+        else if (*end != '\0')
+            return false;
+
+        current = end;
+    }
+
+    return !cpus.empty();
+}
+
+void ThreadAffinity::PinCurrentThread(i32 cpu)
+{
+    if (isThreadPinned)
+        return;
+
+    isThreadPinned = true;
+
+#ifdef NC_REGION_NUMA
+    // Pools and queues are first touched by the threads that use them, so preferring the local node keeps them there
+    if (affinityConfig.numaNode >= 0)
+        numa_set_preferred(affinityConfig.numaNode);
+#endif // NC_REGION_NUMA
+
+    if (cpu < 0)
+        return;
+
+#ifdef _WIN32
+    if (!SetThreadAffinityMask(GetCurrentThread(), 1ull << cpu))
+        ServiceLocator::GetEngineLoop()->PrintMessage("[Affinity]: Failed to pin thread to CPU %d", cpu);
+#else
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(cpu, &cpuSet);
+
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet) != 0)
+        ServiceLocator::GetEngineLoop()->PrintMessage("[Affinity]: Failed to pin thread to CPU %d", cpu);
+#endif
+}
@@ -0,0 +1,58 @@
+/*
+    MIT License
+
+    Copyright (c) 2020 NovusCore
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#pragma once
+#include <NovusTypes.h>
+#include <vector>
+
+struct AffinityConfig
+{
+    i32 ioCpu = -1;
+    i32 tickCpu = -1;
+    std::vector<i32> workerCpus;
+
+    // Threads prefer allocating from this node, the CPU lists above default to its CPUs when left empty
+    i32 numaNode = -1;
+};
+
+// Pins the engine's threads for the low latency deployment mode, every call is a no-op while nothing is configured
+class ThreadAffinity
+{
+public:
+    // Must be called before any of the threads start
+    static void Configure(const AffinityConfig& config);
+
+    static void PinIoThread();
+    static void PinTickThread();
+
+    // Called once on every taskflow worker before the first tick, each call takes the next CPU of the worker list
+    static void PinWorkerThread();
+
+    static bool IsConfigured();
+
+    // Parses lists such as "4-7" or "2,4,6"
+    static bool ParseCpuList(const char* list, std::vector<i32>& cpus);
+
+private:
+    static void PinCurrentThread(i32 cpu);
+};
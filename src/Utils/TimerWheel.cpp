@@ -0,0 +1,175 @@
+#include "TimerWheel.h"
+#include <algorithm>
+
+TimerWheel::TimerWheel()
+{
+    std::fill(std::begin(_buckets), std::end(_buckets), INVALID_NODE);
+}
+
+TimerHandle TimerWheel::Schedule(u64 delayTicks, u16 type, u32 id)
+{
+    u32 nodeIndex = _freeNode;
+    if (nodeIndex != INVALID_NODE)
+    {
+        _freeNode = _nodes[nodeIndex].next;
+    }
+    else
+    {
+        nodeIndex = static_cast<u32>(_nodes.size());
+        _nodes.push_back(Node());
+        _nodes[nodeIndex].generation = 1;
+    }
+
+    Node& node = _nodes[nodeIndex];
+    node.expireTick = GetTick() + std::min(std::max<u64>(delayTicks, 1), MAX_DELAY);
+    node.id = id;
+    node.type = type;
+
+    Insert(nodeIndex);
+    _pendingCount++;
+
+    return (static_cast<u64>(node.generation) << 32) | nodeIndex;
+}
+
+bool TimerWheel::Cancel(TimerHandle handle)
+{
+    if (!GetNode(handle))
+        return false;
+
+    u32 nodeIndex = static_cast<u32>(handle);
+    Unlink(nodeIndex);
+    Release(nodeIndex);
+    return true;
+}
+
+bool TimerWheel::IsPending(TimerHandle handle) const
+{
+    return GetNode(handle) != nullptr;
+}
+
+u64 TimerWheel::GetExpireTick(TimerHandle handle) const
+{
+    const Node* node = GetNode(handle);
+    return node ? node->expireTick : 0;
+}
+
+void TimerWheel::Advance(u64 tick, std::vector<TimerEvent>& expired)
+{
+    // Nothing can fire, skipping ahead keeps idle wheels and long replays from stepping through every tick
+    if (_pendingCount == 0)
+    {
+        _nextTick = std::max(_nextTick, tick + 1);
+        return;
+    }
+
+    while (_nextTick <= tick)
+    {
+        u32 slot = _nextTick & SLOT_MASK;
+
+        // Every time a level wraps around the next level's current slot is spread over the levels below it
+        if (slot == 0)
+        {
+            for (u32 level = 1; level < LEVEL_COUNT && Cascade(level); level++) { }
+        }
+
+        u32 nodeIndex = _buckets[slot];
+        _buckets[slot] = INVALID_NODE;
+        _nextTick++;
+
+        while (nodeIndex != INVALID_NODE)
+        {
+            Node& node = _nodes[nodeIndex];
+            u32 next = node.next;
+
+            node.isLinked = false;
+            expired.push_back({ (static_cast<u64>(node.generation) << 32) | nodeIndex, node.type, node.id });
+            Release(nodeIndex);
+
+            nodeIndex = next;
+        }
+    }
+}
+
+void TimerWheel::Insert(u32 nodeIndex)
+{
+    Node& node = _nodes[nodeIndex];
+
+    // Timers are placed by how far away they are, in the slot their expiry falls into on that level
+    u64 delta = node.expireTick > _nextTick ? node.expireTick - _nextTick : 0;
+    u64 expireTick = std::max(node.expireTick, _nextTick);
+
+    u32 level = 0;
+    while (level < LEVEL_COUNT - 1 && delta >= (1ull << (LEVEL_BITS * (level + 1))))
+    {
+        level++;
+    }
+
+    u32 bucket = level * SLOT_COUNT + static_cast<u32>((expireTick >> (LEVEL_BITS * level)) & SLOT_MASK);
+
+    node.bucket = static_cast<u16>(bucket);
+    node.previous = INVALID_NODE;
+    node.next = _buckets[bucket];
+    node.isLinked = true;
+
+    if (node.next != INVALID_NODE)
+        _nodes[node.next].previous = nodeIndex;
+
+    _buckets[bucket] = nodeIndex;
+}
+
+void TimerWheel::Unlink(u32 nodeIndex)
+{
+    Node& node = _nodes[nodeIndex];
+
+    if (node.previous != INVALID_NODE)
+        _nodes[node.previous].next = node.next;
+    else
+        _buckets[node.bucket] = node.next;
+
+    if (node.next != INVALID_NODE)
+        _nodes[node.next].previous = node.previous;
+
+    node.isLinked = false;
+}
+
+void TimerWheel::Release(u32 nodeIndex)
+{
+    Node& node = _nodes[nodeIndex];
+
+    // Handles to the old timer stop matching once the generation moves on
+    node.generation = node.generation == 0xFFFFFFFF ? 1 : node.generation + 1;
+    node.next = _freeNode;
+    _freeNode = nodeIndex;
+    _pendingCount--;
+}
+
+bool TimerWheel::Cascade(u32 level)
+{
+    u32 slot = static_cast<u32>((_nextTick >> (LEVEL_BITS * level)) & SLOT_MASK);
+    u32 bucket = level * SLOT_COUNT + slot;
+
+    u32 nodeIndex = _buckets[bucket];
+    _buckets[bucket] = INVALID_NODE;
+
+    while (nodeIndex != INVALID_NODE)
+    {
+        u32 next = _nodes[nodeIndex].next;
+        Insert(nodeIndex);
+        nodeIndex = next;
+    }
+
+    // The level above only has to cascade when this level wrapped around as well
+    return slot == 0;
+}
+
+const TimerWheel::Node* TimerWheel::GetNode(TimerHandle handle) const
+{
+    u32 nodeIndex = static_cast<u32>(handle);
+    u32 generation = static_cast<u32>(handle >> 32);
+
+    if (nodeIndex >= _nodes.size())
+        return nullptr;
+
+    const Node& node = _nodes[nodeIndex];
+    return node.generation == generation && node.isLinked ? &node : nullptr;
+}
@@ -0,0 +1,93 @@
+/*
+    MIT License
+
+    Copyright (c) 2020 NovusCore
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#pragma once
+#include <NovusTypes.h>
+#include <vector>
+
+// Generation in the high half, node index in the low half. 0 is never handed out, so it can mark "no timer"
+using TimerHandle = u64;
+
+struct TimerEvent
+{
+    TimerHandle handle;
+    u16 type;
+    u32 id;
+};
+
+// Hierarchical timer wheel counted in ticks. Four levels of 64 slots cover 2^24 ticks, longer delays are clamped.
+// Scheduling and cancelling are O(1), advancing a tick is O(1) plus the timers that expire, and a level's slot is
+// only cascaded into the level below once every 64^level ticks. Not thread safe, the tick owns it
+class TimerWheel
+{
+public:
+    TimerWheel();
+
+    // Fires on the tick delayTicks after the current one, at least on the next tick
+    TimerHandle Schedule(u64 delayTicks, u16 type, u32 id);
+
+    // False if the timer already fired or was cancelled
+    bool Cancel(TimerHandle handle);
+
+    bool IsPending(TimerHandle handle) const;
+    u64 GetExpireTick(TimerHandle handle) const;
+
+    // Runs every tick up to and including tick, appending the timers that expired to expired
+    void Advance(u64 tick, std::vector<TimerEvent>& expired);
+
+    u64 GetTick() const { return _nextTick - 1; }
+    u32 GetPendingCount() const { return _pendingCount; }
+
+private:
+    static constexpr u32 LEVEL_BITS = 6;
+    static constexpr u32 SLOT_COUNT = 1 << LEVEL_BITS;
+    static constexpr u32 SLOT_MASK = SLOT_COUNT - 1;
+    static constexpr u32 LEVEL_COUNT = 4;
+    static constexpr u32 INVALID_NODE = 0xFFFFFFFF;
+    static constexpr u64 MAX_DELAY = (1ull << (LEVEL_BITS * LEVEL_COUNT)) - 1;
+
+    struct Node
+    {
+        u64 expireTick;
+        u32 previous;
+        u32 next;
+        u32 generation;
+        u32 id;
+        u16 type;
+        u16 bucket; // Slot the node is linked into, level * SLOT_COUNT + slot
+        bool isLinked;
+    };
+
+    void Insert(u32 nodeIndex);
+    void Unlink(u32 nodeIndex);
+    void Release(u32 nodeIndex);
+    bool Cascade(u32 level);
+    const Node* GetNode(TimerHandle handle) const;
+
+    std::vector<Node> _nodes;
+    u32 _freeNode = INVALID_NODE;
+    u32 _buckets[LEVEL_COUNT * SLOT_COUNT];
+
+    u64 _nextTick = 1; // The first tick Advance has not run yet
+    u32 _pendingCount = 0;
+};
@@ -0,0 +1,68 @@
+#include "WorkerPool.h"
+
+WorkerPool::~WorkerPool()
+{
+    Stop();
+}
+
+void WorkerPool::Start(u32 threadCount)
+{
+    if (IsRunning())
+        return;
+
+    for (u32 i = 0; i < threadCount; i++)
+    {
+        _shards.push_back(std::make_unique<Shard>());
+    }
+
+    for (std::unique_ptr<Shard>& shard : _shards)
+    {
+        shard->thread = std::thread(&WorkerPool::Run, std::ref(*shard));
+    }
+}
+
+void WorkerPool::Stop()
+{
+    for (std::unique_ptr<Shard>& shard : _shards)
+    {
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            shard->isRunning = false;
+        }
+
+        shard->condition.notify_one();
+        shard->thread.join();
+    }
+
+    _shards.clear();
+}
+
+void WorkerPool::Submit(u32 key, Job&& job)
+{
+    Shard& shard = *_shards[key % _shards.size()];
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.jobs.push_back(std::move(job));
+    }
+
+    shard.condition.notify_one();
+}
+
+void WorkerPool::Run(Shard& shard)
+{
+    std::unique_lock<std::mutex> lock(shard.mutex);
+    while (true)
+    {
+        shard.condition.wait(lock, [&shard]() { return !shard.jobs.empty() || !shard.isRunning; });
+
+        if (shard.jobs.empty())
+            return;
+
+        Job job = std::move(shard.jobs.front());
+        shard.jobs.pop_front();
+
+        lock.unlock();
+        job();
+        lock.lock();
+    }
+}
@@ -0,0 +1,66 @@
+/*
+    MIT License
+
+    Copyright (c) 2020 NovusCore
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#pragma once
+#include <NovusTypes.h>
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+
+// Fixed set of background threads with a queue each, jobs submitted with the same key
+// always land on the same thread and run in the order they were submitted
+class WorkerPool
+{
+public:
+    using Job = std::function<void()>;
+
+    ~WorkerPool();
+
+    void Start(u32 threadCount);
+
+    // Runs every job that was already queued before the threads exit
+    void Stop();
+
+    void Submit(u32 key, Job&& job);
+
+    bool IsRunning() const { return !_shards.empty(); }
+    u32 GetThreadCount() const { return static_cast<u32>(_shards.size()); }
+
+private:
+    struct Shard
+    {
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::deque<Job> jobs;
+        std::thread thread;
+        bool isRunning = true;
+    };
+
+    static void Run(Shard& shard);
+
+    std::vector<std::unique_ptr<Shard>> _shards;
+};
@@ -0,0 +1,82 @@
+#include "Zone.h"
+#include <string>
+#include <algorithm>
+#include <tracy/Tracy.hpp>
+#include "ZoneRouter.h"
+#include "../ECS/Components/Singletons/TimeSingleton.h"
+#include "../ECS/Components/Singletons/GovernorSingleton.h"
+#include "../ECS/Components/Singletons/TickStatsSingleton.h"
+#include "../ECS/Components/Singletons/ZoneSingleton.h"
+#include "../ECS/Systems/Zone/ZoneMessageSystem.h"
+#include "../ECS/Systems/Movement/MovementSystem.h"
+#include "../Utils/Metrics.h"
+
+Zone::Zone(u32 zoneId, ZoneRouter* router) : _id(zoneId)
+{
+    _registry.set<TimeSingleton>();
+    _registry.set<GovernorSingleton>();
+    _registry.set<TickStatsSingleton>();
+
+    ZoneSingleton& zoneSingleton = _registry.set<ZoneSingleton>();
+    zoneSingleton.zoneId = zoneId;
+    zoneSingleton.router = router;
+
+    _entitiesMetric = &Metrics::Get("zone." + std::to_string(zoneId) + ".entities");
+    SetupFramework();
+}
+
+void Zone::BeginTick(entt::registry& primaryRegistry)
+{
+    _registry.ctx<TimeSingleton>() = primaryRegistry.ctx<TimeSingleton>();
+
+    const GovernorSingleton& primaryGovernor = primaryRegistry.ctx<GovernorSingleton>();
+    GovernorSingleton& governor = _registry.ctx<GovernorSingleton>();
+    governor.tick = primaryGovernor.tick;
+    governor.level = primaryGovernor.level;
+    governor.systemClass = primaryGovernor.systemClass;
+    governor.deferredSystemInterval = primaryGovernor.deferredSystemInterval;
+    governor.deferrablePacketBudget = primaryGovernor.deferrablePacketBudget;
+    governor.acceptBudget = primaryGovernor.acceptBudget;
+}
+
+void Zone::EndTick(entt::registry& primaryRegistry)
+{
+    GovernorSingleton& primaryGovernor = primaryRegistry.ctx<GovernorSingleton>();
+    GovernorSingleton& governor = _registry.ctx<GovernorSingleton>();
+    for (size_t i = 0; i < governor.systemCost.size(); i++)
+    {
+        primaryGovernor.systemCost[i].fetch_add(governor.systemCost[i].exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    TickStatsSingleton& primaryTickStats = primaryRegistry.ctx<TickStatsSingleton>();
+    TickStatsSingleton& tickStats = _registry.ctx<TickStatsSingleton>();
+    u32 spanCount = std::min(tickStats.spanCount.load(std::memory_order_relaxed), TICK_STATS_MAX_SPANS);
+    for (u32 i = 0; i < spanCount; i++)
+    {
+        primaryTickStats.AddSpan(tickStats.spans[i]);
+    }
+    tickStats.Reset();
+
+    _entitiesMetric->store(static_cast<i64>(_registry.alive()), std::memory_order_relaxed);
+}
+
+void Zone::SetupFramework()
+{
+    entt::registry& registry = _registry;
+
+    // ZoneMessageSystem
+    tf::Task zoneMessageSystemTask = _framework.emplace([&registry]()
+    {
+        SystemCostScope costScope(registry.ctx<GovernorSingleton>(), registry.ctx<TickStatsSingleton>(), SystemId::ZONE_MESSAGES);
+        ZoneMessageSystem::Update(registry);
+    });
+
+    // MovementSystem
+    tf::Task movementSystemTask = _framework.emplace([&registry](tf::Subflow& subflow)
+    {
+        ZoneScopedNC("MovementSystem::Update", tracy::Color::Blue2)
+        SystemCostScope costScope(registry.ctx<GovernorSingleton>(), registry.ctx<TickStatsSingleton>(), SystemId::MOVEMENT);
+        MovementSystem::Update(registry, subflow);
+    });
+    movementSystemTask.gather(zoneMessageSystemTask);
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <NovusTypes.h>
+#include <atomic>
+#include <entt.hpp>
+#include <taskflow/taskflow.hpp>
+
+class ZoneRouter;
+
+// An independent shard of the region with a registry and system graph of its own. Every zone's graph is run
+// by the primary zone's taskflow executor, so all zones share one work stealing worker pool and a busy zone
+// picks up the workers that quiet zones leave idle. Connections stay on the primary zone, other zones only
+// simulate and talk to the rest of the process through the ZoneRouter
+class Zone
+{
+public:
+    Zone(u32 zoneId, ZoneRouter* router);
+
+    u32 GetId() const { return _id; }
+    entt::registry& GetRegistry() { return _registry; }
+    tf::Framework& GetFramework() { return _framework; }
+
+    // Takes over the tick's time and the governor's decisions from the primary zone
+    void BeginTick(entt::registry& primaryRegistry);
+
+    // Hands the zone's system costs and spans to the primary zone, where the governor and the flight recorder look at them
+    void EndTick(entt::registry& primaryRegistry);
+
+private:
+    void SetupFramework();
+
+    u32 _id;
+    entt::registry _registry;
+    tf::Framework _framework;
+    std::atomic<i64>* _entitiesMetric;
+};
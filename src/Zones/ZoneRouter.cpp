@@ -0,0 +1,23 @@
+#include "ZoneRouter.h"
+#include "../Utils/Metrics.h"
+
+ZoneRouter::ZoneRouter(u32 zoneCount)
+{
+    _inboxes.reserve(zoneCount);
+    for (u32 i = 0; i < zoneCount; i++)
+    {
+        _inboxes.push_back(std::make_unique<moodycamel::ConcurrentQueue<ZoneMessage>>(64));
+    }
+}
+
+bool ZoneRouter::Send(u32 toZoneId, ZoneMessage&& message)
+{
+    static std::atomic<i64>& messagesMetric = Metrics::Get("zone.messages");
+
+    if (toZoneId >= _inboxes.size())
+        return false;
+
+    _inboxes[toZoneId]->enqueue(std::move(message));
+    messagesMetric.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <NovusTypes.h>
+#include <memory>
+#include <vector>
+#include <Utils/ConcurrentQueue.h>
+
+enum class ZoneMessageType : u16
+{
+    TRANSFER_ENTITY // The payload is an EntityBlob, the receiving zone recreates the entity from it
+};
+
+struct ZoneMessage
+{
+    u32 fromZoneId;
+    ZoneMessageType type;
+    std::vector<u8> payload;
+};
+
+// Carries messages between the zones of this process. Zones tick in parallel, so a message is only
+// delivered at the start of the receiving zone's next tick and no zone ever touches another zone's registry
+class ZoneRouter
+{
+public:
+    ZoneRouter(u32 zoneCount);
+
+    u32 GetZoneCount() const { return static_cast<u32>(_inboxes.size()); }
+
+    // Safe to call from any thread, false if there is no such zone
+    bool Send(u32 toZoneId, ZoneMessage&& message);
+    bool TryReceive(u32 zoneId, ZoneMessage& message) { return _inboxes[zoneId]->try_dequeue(message); }
+
+private:
+    std::vector<std::unique_ptr<moodycamel::ConcurrentQueue<ZoneMessage>>> _inboxes;
+};
@@ -3,57 +3,30 @@
 #include <Utils/Message.h>
 #include <Utils/StringUtils.h>
 
-#include <future>
-
 #include "EngineLoop.h"
-#include "ConsoleCommands.h"
+#include "EngineConfig.h"
+#include "Admin/AdminServer.h"
 
 #ifdef _WIN32
 #include <Windows.h>
 #endif
 
-i32 main()
+i32 main(i32 argc, char* argv[])
 {
 #ifdef _WIN32 //Windows
     SetConsoleTitle(WINDOWNAME);
 #endif
 
-    EngineLoop engineLoop;
-    engineLoop.Start();
-
-    ConsoleCommandHandler consoleCommandHandler;
-    std::future<std::string> future = std::async(std::launch::async, StringUtils::GetLineFromCin);
-    while (true)
-    {
-        Message message;
-        bool shouldExit = false;
+    EngineConfig config;
+    if (!config.Parse(argc, argv))
+        return 1;
 
-        while (engineLoop.TryGetMessage(message))
-        {
-            if (message.code == MSG_OUT_EXIT_CONFIRM)
-            {
-                shouldExit = true;
-                break;
-            }
-            else if (message.code == MSG_OUT_PRINT)
-            {
-                DebugHandler::Print(*message.message);
-                delete message.message;
-            }
-        }
-
-        if (shouldExit)
-            break;
-
-        if (future.wait_for(std::chrono::milliseconds(50)) == std::future_status::ready)
-        {
-            std::string command = future.get();
-            std::transform(command.begin(), command.end(), command.begin(), ::tolower); // Convert command to lowercase
+    EngineLoop engineLoop(config);
+    AdminServer adminServer(engineLoop);
+    engineLoop.Start();
 
-            consoleCommandHandler.HandleCommand(engineLoop, command);
-            future = std::async(std::launch::async, StringUtils::GetLineFromCin);
-        }
-    }
+    // Sleeps until a command comes in or the engine has output, returns once the engine confirmed its exit
+    adminServer.Run(config.adminSocketPath);
 
     engineLoop.Stop();
     return 0;
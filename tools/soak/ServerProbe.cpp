@@ -0,0 +1,74 @@
+#include "ServerProbe.h"
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <dirent.h>
+
+bool ServerProbe::Sample(ServerSample& sample) const
+{
+    bool isProcessRead = _pid <= 0 || ReadProcess(sample);
+    bool isMetricsRead = _metricsPath.empty() || ReadMetrics(sample);
+
+    return isProcessRead && isMetricsRead;
+}
+
+bool ServerProbe::ReadProcess(ServerSample& sample) const
+{
+    char path[64];
+    std::snprintf(path, sizeof(path), "/proc/%d/status", _pid);
+
+    FILE* file = std::fopen(path, "r");
+    if (!file)
+        return false;
+
+    char line[256];
+    while (std::fgets(line, sizeof(line), file))
+    {
+        if (std::strncmp(line, "VmRSS:", 6) == 0)
+        {
+            sample.rssKB = std::strtoull(line + 6, nullptr, 10);
+            break;
+        }
+    }
+    std::fclose(file);
+
+    std::snprintf(path, sizeof(path), "/proc/%d/fd", _pid);
+    DIR* directory = opendir(path);
+    if (!directory)
+        return false;
+
+    u32 fileDescriptors = 0;
+    while (dirent* entry = readdir(directory))
+    {
+        if (entry->d_name[0] != '.')
+            fileDescriptors++;
+    }
+    closedir(directory);
+
+    sample.fileDescriptors = fileDescriptors;
+    return true;
+}
+
+bool ServerProbe::ReadMetrics(ServerSample& sample) const
+{
+    FILE* file = std::fopen(_metricsPath.c_str(), "r");
+    if (!file)
+        return false;
+
+    char name[128];
+    long long value;
+    while (std::fscanf(file, "%127s %lld", name, &value) == 2)
+    {
+        if (std::strcmp(name, "governor.tickTimeUs") == 0)
+            sample.tickTimeUs = value;
+        else if (std::strcmp(name, "system.connectionDeferred.costUs") == 0)
+            sample.connectionDeferredCostUs = value;
+        else if (std::strcmp(name, "governor.level") == 0)
+            sample.governorLevel = value;
+        else if (std::strcmp(name, "network.connections") == 0)
+            sample.connections = static_cast<u32>(value);
+    }
+    std::fclose(file);
+
+    return true;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <NovusTypes.h>
+#include <string>
+
+struct ServerSample
+{
+    u64 rssKB = 0;
+    u32 fileDescriptors = 0;
+    u32 connections = 0; // As counted by the region itself
+    i64 tickTimeUs = 0;
+    i64 connectionDeferredCostUs = 0;
+    i64 governorLevel = 0;
+};
+
+// Samples the region process from the outside, memory and descriptors through /proc and
+// tick timings through the file the region dumps its metrics into (--metrics-file)
+class ServerProbe
+{
+public:
+    ServerProbe(i32 pid, const std::string& metricsPath) : _pid(pid), _metricsPath(metricsPath) { }
+
+    bool Sample(ServerSample& sample) const;
+
+private:
+    bool ReadProcess(ServerSample& sample) const;
+    bool ReadMetrics(ServerSample& sample) const;
+
+    i32 _pid;
+    std::string _metricsPath;
+};
@@ -0,0 +1,210 @@
+#include "SoakPool.h"
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <arpa/inet.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <netinet/tcp.h>
+#include <Networking/NetworkPacket.h>
+
+// A single source address runs out of ephemeral ports somewhere below 30k connections, loopback
+// connections rotate through 127.0.0.x source addresses long before that
+constexpr u32 CONNECTIONS_PER_SOURCE_ADDRESS = 20000;
+constexpr i32 MAX_EPOLL_EVENTS = 1024;
+// Well below the region's default --idle-timeout of 300 seconds
+constexpr f64 IDLE_SEND_INTERVAL = 60.0;
+
+static f64 GetTime()
+{
+    return std::chrono::duration<f64>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+SoakPool::SoakPool(const sockaddr_in& server, f32 activeFraction, f32 sendInterval) : _server(server), _activeFraction(activeFraction), _sendInterval(sendInterval)
+{
+    _epoll = epoll_create1(EPOLL_CLOEXEC);
+}
+
+SoakPool::~SoakPool()
+{
+    for (Connection& connection : _connections)
+    {
+        if (connection.state != State::CLOSED)
+            close(connection.fd);
+    }
+
+    if (_epoll >= 0)
+        close(_epoll);
+}
+
+bool SoakPool::BindSource(i32 fd)
+{
+    u32 serverAddress = ntohl(_server.sin_addr.s_addr);
+    if ((serverAddress >> 24) != 127)
+        return true;
+
+    u32 sourceIndex = static_cast<u32>(_connections.size()) / CONNECTIONS_PER_SOURCE_ADDRESS;
+    if (sourceIndex == 0)
+        return true;
+
+    sockaddr_in source;
+    std::memset(&source, 0, sizeof(source));
+    source.sin_family = AF_INET;
+    source.sin_addr.s_addr = htonl((127u << 24) | (sourceIndex + 1));
+
+    return bind(fd, reinterpret_cast<sockaddr*>(&source), sizeof(source)) == 0;
+}
+
+u32 SoakPool::Open(u32 count, f32 timeout)
+{
+    u32 openCountBefore = _openCount;
+    u32 activeEvery = _activeFraction > 0.0f ? static_cast<u32>(1.0f / _activeFraction) : 0;
+    f64 now = GetTime();
+
+    for (u32 i = 0; i < count; i++)
+    {
+        i32 fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0)
+        {
+            _failedCount += count - i;
+            break;
+        }
+
+        i32 noDelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+        if (!BindSource(fd) || (connect(fd, reinterpret_cast<sockaddr*>(&_server), sizeof(_server)) != 0 && errno != EINPROGRESS))
+        {
+            close(fd);
+            _failedCount++;
+            continue;
+        }
+
+        // Spreads the active connections' sends evenly over the interval instead of sending in bursts,
+        // idle ones send as soon as they are open, a connection that never sends a valid packet is closed by the region
+        Connection connection;
+        connection.fd = fd;
+        connection.state = State::CONNECTING;
+        connection.isActive = activeEvery > 0 && _connections.size() % activeEvery == 0;
+        connection.nextSendTime = connection.isActive ? now + _sendInterval * (static_cast<f64>(_connections.size() % 1024) / 1024.0) : now;
+
+        epoll_event event;
+        event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP;
+        event.data.u32 = static_cast<u32>(_connections.size());
+        epoll_ctl(_epoll, EPOLL_CTL_ADD, fd, &event);
+
+        _connections.push_back(connection);
+        _connectingCount++;
+    }
+
+    f64 deadline = GetTime() + timeout;
+    while (_connectingCount > 0 && GetTime() < deadline)
+    {
+        Poll(10, GetTime());
+    }
+
+    return _openCount - openCountBefore;
+}
+
+void SoakPool::Pump(f32 seconds)
+{
+    f64 end = GetTime() + seconds;
+    for (f64 now = GetTime(); now < end; now = GetTime())
+    {
+        Poll(5, now);
+
+        // MSG_REQUEST_ADDRESS carries no payload, the frame is just the opcode and a zero size
+        u16 frame[2] = { static_cast<u16>(Opcode::MSG_REQUEST_ADDRESS), 0 };
+
+        for (Connection& connection : _connections)
+        {
+            if (connection.state != State::OPEN || now < connection.nextSendTime)
+                continue;
+
+            ssize_t written = send(connection.fd, frame, sizeof(frame), MSG_NOSIGNAL);
+            if (written == sizeof(frame))
+                _sentPackets++;
+            else if (written < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+                CloseConnection(connection);
+
+            connection.nextSendTime += connection.isActive ? _sendInterval : IDLE_SEND_INTERVAL;
+        }
+    }
+}
+
+void SoakPool::Poll(i32 timeoutMS, f64 now)
+{
+    epoll_event events[MAX_EPOLL_EVENTS];
+    i32 eventCount = epoll_wait(_epoll, events, MAX_EPOLL_EVENTS, timeoutMS);
+
+    for (i32 i = 0; i < eventCount; i++)
+    {
+        Connection& connection = _connections[events[i].data.u32];
+        if (connection.state == State::CLOSED)
+            continue;
+
+        if (connection.state == State::CONNECTING)
+        {
+            i32 error = 0;
+            socklen_t errorSize = sizeof(error);
+            getsockopt(connection.fd, SOL_SOCKET, SO_ERROR, &error, &errorSize);
+
+            if (error != 0 || (events[i].events & (EPOLLERR | EPOLLHUP)))
+            {
+                CloseConnection(connection);
+                continue;
+            }
+
+            // Only readability matters from here on
+            epoll_event event;
+            event.events = EPOLLIN | EPOLLRDHUP;
+            event.data.u32 = events[i].data.u32;
+            epoll_ctl(_epoll, EPOLL_CTL_MOD, connection.fd, &event);
+
+            connection.state = State::OPEN;
+            _connectingCount--;
+            _openCount++;
+            if (connection.nextSendTime < now)
+                connection.nextSendTime = now;
+        }
+
+        if (events[i].events & EPOLLIN)
+        {
+            // Whatever the region answers is discarded, it only has to leave its socket buffers
+            u8 buffer[4096];
+            ssize_t received;
+            while ((received = recv(connection.fd, buffer, sizeof(buffer), 0)) > 0) { }
+
+            if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+            {
+                CloseConnection(connection);
+                continue;
+            }
+        }
+
+        if (events[i].events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+            CloseConnection(connection);
+    }
+}
+
+void SoakPool::CloseConnection(Connection& connection)
+{
+    if (connection.state == State::CLOSED)
+        return;
+
+    if (connection.state == State::OPEN)
+    {
+        _openCount--;
+        _closedCount++;
+    }
+    else
+    {
+        _connectingCount--;
+        _failedCount++;
+    }
+
+    connection.state = State::CLOSED;
+    close(connection.fd);
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <NovusTypes.h>
+#include <vector>
+#include <netinet/in.h>
+
+// Holds a large number of client connections to the region from a single epoll loop.
+// A fraction of them are active and send MSG_REQUEST_ADDRESS on a fixed interval, the rest idle and only send
+// one right after connecting and a keepalive every IDLE_SEND_INTERVAL, which keeps them clear of the region's
+// --handshake-timeout and --idle-timeout
+class SoakPool
+{
+public:
+    SoakPool(const sockaddr_in& server, f32 activeFraction, f32 sendInterval);
+    ~SoakPool();
+
+    // Opens count more connections and waits until they are established or the timeout ran out, returns how many got established
+    u32 Open(u32 count, f32 timeout);
+
+    // Keeps every connection alive for the given time, draining what the region sends and sending the active mix
+    void Pump(f32 seconds);
+
+    u32 GetOpenCount() const { return _openCount; }
+    u32 GetFailedCount() const { return _failedCount; }
+    u32 GetClosedCount() const { return _closedCount; }
+    u64 GetSentPackets() const { return _sentPackets; }
+
+private:
+    enum class State : u8
+    {
+        CONNECTING,
+        OPEN,
+        CLOSED
+    };
+
+    struct Connection
+    {
+        i32 fd;
+        State state;
+        bool isActive;
+        f64 nextSendTime;
+    };
+
+    void Poll(i32 timeoutMS, f64 now);
+    void CloseConnection(Connection& connection);
+    bool BindSource(i32 fd);
+
+    sockaddr_in _server;
+    f32 _activeFraction;
+    f32 _sendInterval;
+    i32 _epoll;
+
+    std::vector<Connection> _connections;
+    u32 _connectingCount = 0;
+    u32 _openCount = 0;
+    u32 _failedCount = 0;
+    u32 _closedCount = 0;
+    u64 _sentPackets = 0;
+};
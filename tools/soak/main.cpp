@@ -0,0 +1,265 @@
+#include <NovusTypes.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <arpa/inet.h>
+#include <sys/resource.h>
+#include "SoakPool.h"
+#include "ServerProbe.h"
+
+// A step is flagged when it costs this much more per connection than the steps before it did
+constexpr f64 REGRESSION_RATIO = 1.5;
+constexpr f32 SAMPLE_INTERVAL = 0.25f;
+
+struct SoakConfig
+{
+    std::string host = "127.0.0.1";
+    u16 port = 3724;
+    u32 step = 1000;
+    u32 maxConnections = 50000;
+    f32 holdSeconds = 10.0f;
+    f32 connectTimeout = 10.0f;
+    f32 activeFraction = 0.1f; // Share of the connections sending MSG_REQUEST_ADDRESS, the rest idle apart from a keepalive
+    f32 sendInterval = 1.0f;
+    i32 serverPid = 0;
+    std::string metricsPath = "";
+    std::string outputPath = "soak.csv";
+};
+
+struct StepResult
+{
+    u32 connections;
+    ServerSample last;
+    f64 tickTimeUsAverage;
+    i64 tickTimeUsMax;
+    f64 connectionDeferredCostUsAverage;
+    i64 connectionDeferredCostUsMax;
+};
+
+static void PrintUsage()
+{
+    std::printf("Usage: novus-region-soak [options]\n");
+    std::printf("    --host <ip>         Region address, defaults to 127.0.0.1\n");
+    std::printf("    --port <port>       Region client port, defaults to 3724\n");
+    std::printf("    --step <count>      Connections added per step, defaults to 1000\n");
+    std::printf("    --max <count>       Stop after this many connections, defaults to 50000\n");
+    std::printf("    --hold <seconds>    Time every step is held for before it is measured, defaults to 10\n");
+    std::printf("    --active <ratio>    Share of connections sending MSG_REQUEST_ADDRESS, defaults to 0.1\n");
+    std::printf("    --send-interval <seconds> Time between the requests of an active connection, defaults to 1\n");
+    std::printf("    --pid <pid>         Region process, sampled for RSS and file descriptors\n");
+    std::printf("    --metrics <file>    File the region dumps its metrics into (--metrics-file), sampled for tick timings\n");
+    std::printf("    --output <file>     CSV of the scaling curve, defaults to soak.csv\n");
+}
+
+static bool ParseConfig(i32 argc, char* argv[], SoakConfig& config)
+{
+    for (i32 i = 1; i < argc; i++)
+    {
+        const char* argument = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (std::strcmp(argument, "--host") == 0 && hasValue)
+            config.host = argv[++i];
+        else if (std::strcmp(argument, "--port") == 0 && hasValue)
+            config.port = static_cast<u16>(std::strtoul(argv[++i], nullptr, 10));
+        else if (std::strcmp(argument, "--step") == 0 && hasValue)
+            config.step = static_cast<u32>(std::strtoul(argv[++i], nullptr, 10));
+        else if (std::strcmp(argument, "--max") == 0 && hasValue)
+            config.maxConnections = static_cast<u32>(std::strtoul(argv[++i], nullptr, 10));
+        else if (std::strcmp(argument, "--hold") == 0 && hasValue)
+            config.holdSeconds = std::strtof(argv[++i], nullptr);
+        else if (std::strcmp(argument, "--active") == 0 && hasValue)
+            config.activeFraction = std::strtof(argv[++i], nullptr);
+        else if (std::strcmp(argument, "--send-interval") == 0 && hasValue)
+            config.sendInterval = std::strtof(argv[++i], nullptr);
+        else if (std::strcmp(argument, "--pid") == 0 && hasValue)
+            config.serverPid = std::atoi(argv[++i]);
+        else if (std::strcmp(argument, "--metrics") == 0 && hasValue)
+            config.metricsPath = argv[++i];
+        else if (std::strcmp(argument, "--output") == 0 && hasValue)
+            config.outputPath = argv[++i];
+        else
+        {
+            std::printf("Unknown or incomplete argument: %s\n", argument);
+            PrintUsage();
+            return false;
+        }
+    }
+
+    if (config.step == 0 || config.sendInterval <= 0.0f || config.activeFraction < 0.0f || config.activeFraction > 1.0f)
+    {
+        std::printf("--step, --send-interval and --active need to be positive, --active at most 1\n");
+        return false;
+    }
+
+    return true;
+}
+
+// Every connection is a descriptor on our side as well, the default soft limit of 1024 ends the soak early
+static void RaiseDescriptorLimit(u32 connections)
+{
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0)
+        return;
+
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+
+    if (limit.rlim_cur < connections + 64)
+        std::printf("Warning: the descriptor limit (%llu) is below the requested connection count\n", static_cast<unsigned long long>(limit.rlim_cur));
+}
+
+// Holds the step while sampling, tick timings are gauges so they have to be watched over the whole hold
+static StepResult HoldStep(SoakPool& pool, const ServerProbe& probe, const SoakConfig& config)
+{
+    StepResult result = {};
+    result.connections = pool.GetOpenCount();
+
+    u32 sampleCount = 0;
+    f64 tickTimeUsSum = 0.0;
+    f64 connectionDeferredCostUsSum = 0.0;
+
+    for (f32 held = 0.0f; held < config.holdSeconds; held += SAMPLE_INTERVAL)
+    {
+        pool.Pump(SAMPLE_INTERVAL);
+
+        ServerSample sample;
+        if (!probe.Sample(sample))
+            continue;
+
+        tickTimeUsSum += static_cast<f64>(sample.tickTimeUs);
+        connectionDeferredCostUsSum += static_cast<f64>(sample.connectionDeferredCostUs);
+        result.tickTimeUsMax = std::max(result.tickTimeUsMax, sample.tickTimeUs);
+        result.connectionDeferredCostUsMax = std::max(result.connectionDeferredCostUsMax, sample.connectionDeferredCostUs);
+        result.last = sample;
+        sampleCount++;
+    }
+
+    if (sampleCount > 0)
+    {
+        result.tickTimeUsAverage = tickTimeUsSum / sampleCount;
+        result.connectionDeferredCostUsAverage = connectionDeferredCostUsSum / sampleCount;
+    }
+
+    return result;
+}
+
+// Compares the step's marginal cost per connection against the steps before it
+static std::string FindRegressions(const StepResult& baseline, const std::vector<StepResult>& results)
+{
+    std::string regressions;
+    if (results.size() < 3)
+        return regressions;
+
+    const StepResult& current = results[results.size() - 1];
+    const StepResult& previous = results[results.size() - 2];
+    const StepResult& first = results[0];
+
+    f64 addedConnections = static_cast<f64>(current.connections) - static_cast<f64>(previous.connections);
+    f64 earlierConnections = static_cast<f64>(previous.connections) - static_cast<f64>(baseline.connections);
+    if (addedConnections <= 0.0 || earlierConnections <= 0.0 || previous.connections == first.connections)
+        return regressions;
+
+    auto checkGrowth = [&](const char* name, f64 currentValue, f64 previousValue, f64 baselineValue)
+    {
+        f64 marginal = (currentValue - previousValue) / addedConnections;
+        f64 earlier = (previousValue - baselineValue) / earlierConnections;
+
+        if (earlier > 0.0 && marginal > earlier * REGRESSION_RATIO)
+        {
+            char text[128];
+            std::snprintf(text, sizeof(text), " %s %.2fx", name, marginal / earlier);
+            regressions += text;
+        }
+    };
+
+    checkGrowth("rss/conn", static_cast<f64>(current.last.rssKB), static_cast<f64>(previous.last.rssKB), static_cast<f64>(baseline.last.rssKB));
+    checkGrowth("fds/conn", current.last.fileDescriptors, previous.last.fileDescriptors, baseline.last.fileDescriptors);
+    checkGrowth("tick/conn", current.tickTimeUsAverage, previous.tickTimeUsAverage, baseline.tickTimeUsAverage);
+    checkGrowth("deferred/conn", current.connectionDeferredCostUsAverage, previous.connectionDeferredCostUsAverage, baseline.connectionDeferredCostUsAverage);
+
+    if (current.last.governorLevel > previous.last.governorLevel)
+        regressions += " governor shedding";
+
+    return regressions;
+}
+
+i32 main(i32 argc, char* argv[])
+{
+    SoakConfig config;
+    if (!ParseConfig(argc, argv, config))
+        return 1;
+
+    sockaddr_in server;
+    std::memset(&server, 0, sizeof(server));
+    server.sin_family = AF_INET;
+    server.sin_port = htons(config.port);
+    if (inet_pton(AF_INET, config.host.c_str(), &server.sin_addr) != 1)
+    {
+        std::printf("Malformed host, expected an IPv4 address: %s\n", config.host.c_str());
+        return 1;
+    }
+
+    if (config.serverPid <= 0 || config.metricsPath.empty())
+        std::printf("Warning: without --pid and --metrics only the client side of the curve is measured\n");
+
+    FILE* output = std::fopen(config.outputPath.c_str(), "w");
+    if (!output)
+    {
+        std::printf("Failed to open %s\n", config.outputPath.c_str());
+        return 1;
+    }
+
+    RaiseDescriptorLimit(config.maxConnections);
+
+    SoakPool pool(server, config.activeFraction, config.sendInterval);
+    ServerProbe probe(config.serverPid, config.metricsPath);
+
+    StepResult baseline = HoldStep(pool, probe, config);
+    std::vector<StepResult> results;
+
+    const char* header = "connections,serverConnections,failed,closed,rssKB,rssBytesPerConnection,fds,tickUsAvg,tickUsMax,deferredUsAvg,deferredUsMax,governorLevel";
+    std::fprintf(output, "%s,regressions\n", header);
+    std::printf("%s\n", header);
+
+    while (pool.GetOpenCount() < config.maxConnections)
+    {
+        u32 count = std::min(config.step, config.maxConnections - pool.GetOpenCount());
+        u32 opened = pool.Open(count, config.connectTimeout);
+
+        StepResult result = HoldStep(pool, probe, config);
+        results.push_back(result);
+
+        u32 addedConnections = result.connections > baseline.connections ? result.connections - baseline.connections : 0;
+        f64 rssBytesPerConnection = addedConnections > 0 ? (static_cast<f64>(result.last.rssKB) - static_cast<f64>(baseline.last.rssKB)) * 1024.0 / addedConnections : 0.0;
+        std::string regressions = FindRegressions(baseline, results);
+
+        char row[512];
+        std::snprintf(row, sizeof(row), "%u,%u,%u,%u,%llu,%.0f,%u,%.1f,%lld,%.1f,%lld,%lld",
+            result.connections, result.last.connections, pool.GetFailedCount(), pool.GetClosedCount(),
+            static_cast<unsigned long long>(result.last.rssKB), rssBytesPerConnection, result.last.fileDescriptors,
+            result.tickTimeUsAverage, static_cast<long long>(result.tickTimeUsMax),
+            result.connectionDeferredCostUsAverage, static_cast<long long>(result.connectionDeferredCostUsMax),
+            static_cast<long long>(result.last.governorLevel));
+
+        std::fprintf(output, "%s,%s\n", row, regressions.c_str());
+        std::fflush(output);
+        std::printf("%s%s%s\n", row, regressions.empty() ? "" : "  <- regression:", regressions.c_str());
+
+        // The region or the host stopped taking connections, growing further would only measure failures
+        if (opened == 0)
+        {
+            std::printf("No connection of the last step got established, stopping\n");
+            break;
+        }
+    }
+
+    std::printf("Sent %llu requests, the scaling curve is in %s\n", static_cast<unsigned long long>(pool.GetSentPackets()), config.outputPath.c_str());
+    std::fclose(output);
+    return 0;
+}